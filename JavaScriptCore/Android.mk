@@ -29,6 +29,7 @@ LOCAL_SRC_FILES := \
 	API/OpaqueJSString.cpp \
 	\
 	bytecode/CodeBlock.cpp \
+	bytecode/EvalCodeCache.cpp \
 	bytecode/JumpTable.cpp \
 	bytecode/Opcode.cpp \
 	bytecode/SamplingTool.cpp \
@@ -54,9 +55,11 @@ LOCAL_SRC_FILES := \
 	jit/JITOpcodes.cpp \
 	jit/JITPropertyAccess.cpp \
 	jit/JITStubs.cpp \
+	jit/MegamorphicAccessCache.cpp \
 	\
 	parser/Lexer.cpp \
 	parser/Nodes.cpp \
+	parser/ParseCache.cpp \
 	parser/Parser.cpp \
 	parser/ParserArena.cpp \
 	\
@@ -114,6 +117,7 @@ LOCAL_SRC_FILES := \
 	runtime/JSNotAnObject.cpp \
 	runtime/JSNumberCell.cpp \
 	runtime/JSONObject.cpp \
+	runtime/JSONParser.cpp \
 	runtime/JSObject.cpp \
 	runtime/JSPropertyNameIterator.cpp \
 	runtime/JSStaticScopeObject.cpp \
@@ -200,6 +204,7 @@ LOCAL_GENERATED_SOURCES += $(GEN)
 JSC_OBJECTS := $(addprefix $(intermediates)/runtime/, \
 				ArrayPrototype.lut.h \
 				DatePrototype.lut.h \
+				JSGlobalObject.lut.h \
 				JSONObject.lut.h \
 				MathObject.lut.h \
 				NumberConstructor.lut.h \
@@ -16,6 +16,7 @@ CONFIG(standalone_package) {
 LUT_FILES += \
     runtime/ArrayPrototype.cpp \
     runtime/DatePrototype.cpp \
+    runtime/JSGlobalObject.cpp \
     runtime/JSONObject.cpp \
     runtime/MathObject.cpp \
     runtime/NumberConstructor.cpp \
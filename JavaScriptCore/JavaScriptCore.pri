@@ -86,6 +86,7 @@ SOURCES += \
     assembler/ARMAssembler.cpp \
     assembler/MacroAssemblerARM.cpp \
     bytecode/CodeBlock.cpp \
+    bytecode/EvalCodeCache.cpp \
     bytecode/JumpTable.cpp \
     bytecode/Opcode.cpp \
     bytecode/SamplingTool.cpp \
@@ -108,8 +109,10 @@ SOURCES += \
     jit/JITOpcodes.cpp \
     jit/JITPropertyAccess.cpp \
     jit/JITStubs.cpp \
+    jit/MegamorphicAccessCache.cpp \
     parser/Lexer.cpp \
     parser/Nodes.cpp \
+    parser/ParseCache.cpp \
     parser/ParserArena.cpp \
     parser/Parser.cpp \
     profiler/Profile.cpp \
@@ -160,6 +163,7 @@ SOURCES += \
     runtime/JSNumberCell.cpp \
     runtime/JSObject.cpp \
     runtime/JSONObject.cpp \
+    runtime/JSONParser.cpp \
     runtime/JSPropertyNameIterator.cpp \
     runtime/JSStaticScopeObject.cpp \
     runtime/JSString.cpp \
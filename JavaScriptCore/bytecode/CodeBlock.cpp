@@ -250,6 +250,9 @@ static void printStructureStubInfo(const StructureStubInfo& stubInfo, unsigned i
     case access_put_by_id_replace:
         printf("  [%4d] %s: %s\n", instructionOffset, "put_by_id_replace", pointerToSourceString(stubInfo.u.putByIdReplace.baseObjectStructure).UTF8String().c_str());
         return;
+    case access_put_by_id_replace_list:
+        printf("  [%4d] %s: %s (%d)\n", instructionOffset, "put_by_id_replace_list", pointerToSourceString(stubInfo.u.putByIdReplaceList.structureList).UTF8String().c_str(), stubInfo.u.putByIdReplaceList.listSize);
+        return;
     case access_get_by_id:
         printf("  [%4d] %s\n", instructionOffset, "get_by_id");
         return;
@@ -317,6 +320,18 @@ void CodeBlock::printStructures(const Instruction* vPC) const
         printStructure("resolve_global", vPC, 4);
         return;
     }
+    if (vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id_self_list)) {
+        printf("  [%4d] %s: %s (%d)\n", instructionOffset, "get_by_id_self_list", pointerToSourceString(vPC[4].u.polymorphicStructures).UTF8String().c_str(), vPC[5].u.operand);
+        return;
+    }
+    if (vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id_proto_list)) {
+        printf("  [%4d] %s: %s (%d)\n", instructionOffset, "get_by_id_proto_list", pointerToSourceString(vPC[4].u.polymorphicStructures).UTF8String().c_str(), vPC[5].u.operand);
+        return;
+    }
+    if (vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id_call)) {
+        printf("  [%4d] %s: %s, %s\n", instructionOffset, "get_by_id_call", pointerToSourceString(vPC[4].u.structure).UTF8String().c_str(), pointerToSourceString(vPC[5].u.structure).UTF8String().c_str());
+        return;
+    }
 
     // These m_instructions doesn't ref Structures.
     ASSERT(vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id_generic) || vPC[0].u.opcode == interpreter->getOpcode(op_put_by_id_generic) || vPC[0].u.opcode == interpreter->getOpcode(op_call) || vPC[0].u.opcode == interpreter->getOpcode(op_call_eval) || vPC[0].u.opcode == interpreter->getOpcode(op_construct));
@@ -563,6 +578,11 @@ void CodeBlock::dump(ExecState* exec, const Vector<Instruction>::const_iterator&
             printf("[%4d] pre_inc\t\t %s\n", location, registerName(exec, r0).c_str());
             break;
         }
+        case op_pre_inc_loop_if_less: {
+            int r0 = (++it)->u.operand;
+            printf("[%4d] pre_inc_loop_if_less\t %s\n", location, registerName(exec, r0).c_str());
+            break;
+        }
         case op_pre_dec: {
             int r0 = (++it)->u.operand;
             printf("[%4d] pre_dec\t\t %s\n", location, registerName(exec, r0).c_str());
@@ -769,6 +789,10 @@ void CodeBlock::dump(ExecState* exec, const Vector<Instruction>::const_iterator&
             printGetByIdOp(exec, location, it, "get_by_id_generic");
             break;
         }
+        case op_get_by_id_call: {
+            printGetByIdOp(exec, location, it, "get_by_id_call");
+            break;
+        }
         case op_get_array_length: {
             printGetByIdOp(exec, location, it, "get_array_length");
             break;
@@ -1177,6 +1201,9 @@ void CodeBlock::dumpStatistics()
 
     // Non-vector data members
     size_t evalCodeCacheIsNotEmpty = 0;
+    size_t evalCodeCacheTotalSize = 0;
+    size_t evalCodeCacheHits = 0;
+    size_t evalCodeCacheMisses = 0;
 
     size_t symbolTableIsNotEmpty = 0;
     size_t symbolTableTotalSize = 0;
@@ -1214,8 +1241,12 @@ void CodeBlock::dumpStatistics()
                 FOR_EACH_MEMBER_VECTOR_RARE_DATA(GET_STATS)
             #undef GET_STATS
 
-            if (!codeBlock->m_rareData->m_evalCodeCache.isEmpty())
+            EvalCodeCache& evalCodeCache = codeBlock->m_rareData->m_evalCodeCache;
+            if (!evalCodeCache.isEmpty())
                 evalCodeCacheIsNotEmpty++;
+            evalCodeCacheTotalSize += evalCodeCache.size();
+            evalCodeCacheHits += evalCodeCache.hits();
+            evalCodeCacheMisses += evalCodeCache.misses();
         }
 
         switch (codeBlock->codeType()) {
@@ -1261,6 +1292,7 @@ void CodeBlock::dumpStatistics()
     #undef PRINT_STATS
 
     printf("Number of CodeBlocks with evalCodeCache: %zu\n", evalCodeCacheIsNotEmpty);
+    printf("Source bytes in all evalCodeCaches: %zu (%zu hits, %zu misses)\n", evalCodeCacheTotalSize, evalCodeCacheHits, evalCodeCacheMisses);
     printf("Number of CodeBlocks with symbolTable: %zu\n", symbolTableIsNotEmpty);
 
     printf("Size of all symbolTables: %zu\n", symbolTableTotalSize);
@@ -1309,8 +1341,12 @@ CodeBlock::~CodeBlock()
             m_globalResolveInfos[i].structure->deref();
     }
 
-    for (size_t size = m_structureStubInfos.size(), i = 0; i < size; ++i)
+    for (size_t size = m_structureStubInfos.size(), i = 0; i < size; ++i) {
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+        m_structureStubInfos[i].recordStatistics(m_source->url());
+#endif
         m_structureStubInfos[i].deref();
+    }
 
     for (size_t size = m_callLinkInfos.size(), i = 0; i < size; ++i) {
         CallLinkInfo* callLinkInfo = &m_callLinkInfos[i];
@@ -1391,6 +1427,13 @@ void CodeBlock::derefStructures(Instruction* vPC) const
         delete polymorphicStructures;
         return;
     }
+    if (vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id_call)) {
+        if (vPC[4].u.structure)
+            vPC[4].u.structure->deref();
+        if (vPC[5].u.structure)
+            vPC[5].u.structure->deref();
+        return;
+    }
 
     // These instructions don't ref their Structures.
     ASSERT(vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id) || vPC[0].u.opcode == interpreter->getOpcode(op_put_by_id) || vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id_generic) || vPC[0].u.opcode == interpreter->getOpcode(op_put_by_id_generic) || vPC[0].u.opcode == interpreter->getOpcode(op_get_array_length) || vPC[0].u.opcode == interpreter->getOpcode(op_get_string_length));
@@ -1424,6 +1467,13 @@ void CodeBlock::refStructures(Instruction* vPC) const
         vPC[4].u.structure->ref();
         return;
     }
+    if (vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id_call)) {
+        if (vPC[4].u.structure)
+            vPC[4].u.structure->ref();
+        if (vPC[5].u.structure)
+            vPC[5].u.structure->ref();
+        return;
+    }
     
     // These instructions don't ref their Structures.
     ASSERT(vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id) || vPC[0].u.opcode == interpreter->getOpcode(op_put_by_id) || vPC[0].u.opcode == interpreter->getOpcode(op_get_by_id_generic) || vPC[0].u.opcode == interpreter->getOpcode(op_put_by_id_generic));
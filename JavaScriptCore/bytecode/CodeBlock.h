@@ -31,6 +31,7 @@
 #define CodeBlock_h
 
 #include "EvalCodeCache.h"
+#include "Executable.h"
 #include "Instruction.h"
 #include "JITCode.h"
 #include "JSGlobalObject.h"
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2008, 2009, 2010 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ * 3.  Neither the name of Apple Computer, Inc. ("Apple") nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE AND ITS CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL APPLE OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "EvalCodeCache.h"
+
+#include "Executable.h"
+#include "JSGlobalObject.h"
+#include "SourceCode.h"
+
+namespace JSC {
+
+EvalCodeCache::EvalCodeCache(size_t capacity)
+    : m_capacity(capacity)
+    , m_size(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+EvalCodeCache::~EvalCodeCache()
+{
+}
+
+PassRefPtr<EvalExecutable> EvalCodeCache::get(ExecState* exec, const UString& evalSource, ScopeChainNode* scopeChain, JSValue& exceptionValue)
+{
+    UString::Rep* sourceRep = evalSource.rep();
+    bool cacheable = cost(sourceRep) <= m_capacity && (*scopeChain->begin())->isVariableObject();
+
+    if (cacheable) {
+        EvalCacheMap::iterator it = m_cacheMap.find(sourceRep);
+        if (it != m_cacheMap.end()) {
+            ++m_hits;
+            m_useOrder.remove(it->first);
+            m_useOrder.add(it->first);
+            return it->second;
+        }
+        ++m_misses;
+    }
+
+    RefPtr<EvalExecutable> evalExecutable = EvalExecutable::create(exec, makeSource(evalSource));
+    exceptionValue = evalExecutable->compile(exec, scopeChain);
+    if (exceptionValue)
+        return 0;
+
+    if (cacheable) {
+        m_cacheMap.set(sourceRep, evalExecutable);
+        m_useOrder.add(sourceRep);
+        m_size += cost(sourceRep);
+        prune();
+    }
+
+    return evalExecutable.release();
+}
+
+void EvalCodeCache::prune()
+{
+    while (m_size > m_capacity) {
+        RefPtr<UString::Rep> leastRecentlyUsed = *m_useOrder.begin();
+        m_useOrder.remove(m_useOrder.begin());
+        m_cacheMap.remove(leastRecentlyUsed);
+        m_size -= cost(leastRecentlyUsed.get());
+    }
+}
+
+void EvalCodeCache::clear()
+{
+    m_cacheMap.clear();
+    m_useOrder.clear();
+    m_size = 0;
+}
+
+void EvalCodeCache::setCapacity(size_t capacity)
+{
+    m_capacity = capacity;
+    prune();
+}
+
+} // namespace JSC
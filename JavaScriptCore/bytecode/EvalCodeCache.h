@@ -25,51 +25,61 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-
 #ifndef EvalCodeCache_h
 #define EvalCodeCache_h
 
-#include "Executable.h"
-#include "JSGlobalObject.h"
-#include "Nodes.h"
-#include "Parser.h"
-#include "SourceCode.h"
 #include "UString.h"
 #include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/Noncopyable.h>
 #include <wtf/RefPtr.h>
 
 namespace JSC {
 
-    class EvalCodeCache {
+    class EvalExecutable;
+    class ExecState;
+    class JSValue;
+    class ScopeChainNode;
+
+    // Compiled eval code, looked up by the source string. Eval code is compiled against the
+    // scope chain it runs in, so a cache is only shared by callers whose scope chains
+    // compile the same way: each CodeBlock keeps one for evals made from its own scope,
+    // and each JSGlobalObject keeps one for evals made directly at global scope. Entries
+    // are evicted least recently used first once their source text exceeds the capacity.
+    class EvalCodeCache : public Noncopyable {
     public:
-        PassRefPtr<EvalExecutable> get(ExecState* exec, const UString& evalSource, ScopeChainNode* scopeChain, JSValue& exceptionValue)
-        {
-            RefPtr<EvalExecutable> evalExecutable;
+        explicit EvalCodeCache(size_t capacity = defaultCapacity);
+        ~EvalCodeCache();
 
-            if (evalSource.size() < maxCacheableSourceLength && (*scopeChain->begin())->isVariableObject())
-                evalExecutable = m_cacheMap.get(evalSource.rep());
+        PassRefPtr<EvalExecutable> get(ExecState*, const UString& evalSource, ScopeChainNode*, JSValue& exceptionValue);
 
-            if (!evalExecutable) {
-                evalExecutable = EvalExecutable::create(exec, makeSource(evalSource));
-                exceptionValue = evalExecutable->compile(exec, scopeChain);
-                if (exceptionValue)
-                    return 0;
+        bool isEmpty() const { return m_cacheMap.isEmpty(); }
+        void clear();
 
-                if (evalSource.size() < maxCacheableSourceLength && (*scopeChain->begin())->isVariableObject() && m_cacheMap.size() < maxCacheEntries)
-                    m_cacheMap.set(evalSource.rep(), evalExecutable);
-            }
+        // Limit on the bytes of source text whose compiled code is kept.
+        void setCapacity(size_t);
+        size_t capacity() const { return m_capacity; }
+        size_t size() const { return m_size; }
 
-            return evalExecutable.release();
-        }
+        unsigned hits() const { return m_hits; }
+        unsigned misses() const { return m_misses; }
 
-        bool isEmpty() const { return m_cacheMap.isEmpty(); }
+        static const size_t defaultCapacity = 64 * 1024;
+        static const size_t defaultGlobalCapacity = 1024 * 1024;
 
     private:
-        static const int maxCacheableSourceLength = 256;
-        static const int maxCacheEntries = 64;
+        static size_t cost(UString::Rep* source) { return source->size() * sizeof(UChar); }
+        void prune();
 
         typedef HashMap<RefPtr<UString::Rep>, RefPtr<EvalExecutable> > EvalCacheMap;
         EvalCacheMap m_cacheMap;
+        // Least recently used first.
+        ListHashSet<RefPtr<UString::Rep> > m_useOrder;
+
+        size_t m_capacity;
+        size_t m_size;
+        unsigned m_hits;
+        unsigned m_misses;
     };
 
 } // namespace JSC
@@ -34,18 +34,22 @@
 #include "Structure.h"
 #include <wtf/VectorTraits.h>
 
+// The number of Structures a polymorphic get_by_id or put_by_id site caches before it
+// falls back to the megamorphic lookup cache. May be overridden at build time.
+#ifndef POLYMORPHIC_LIST_CACHE_SIZE
 #define POLYMORPHIC_LIST_CACHE_SIZE 8
+#endif
 
 namespace JSC {
 
     // *Sigh*, If the JIT is enabled we need to track the stubRountine (of type CodeLocationLabel),
-    // If the JIT is not in use we don't actually need the variable (that said, if the JIT is not in use we don't
-    // curently actually use PolymorphicAccessStructureLists, which we should).  Anyway, this seems like the best
+    // If the JIT is not in use the interpreter's op_get_by_id_self_list and op_get_by_id_proto_list
+    // keep the cached property offset in its place.  Anyway, this seems like the best
     // solution for now - will need to something smarter if/when we actually want mixed-mode operation.
 #if ENABLE(JIT)
     typedef CodeLocationLabel PolymorphicAccessStructureListStubRoutineType;
 #else
-    typedef void* PolymorphicAccessStructureListStubRoutineType;
+    typedef size_t PolymorphicAccessStructureListStubRoutineType;
 #endif
 
     class JSCell;
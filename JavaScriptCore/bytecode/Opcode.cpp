@@ -48,6 +48,7 @@ const char* const opcodeNames[] = {
 
 long long OpcodeStats::opcodeCounts[numOpcodeIDs];
 long long OpcodeStats::opcodePairCounts[numOpcodeIDs][numOpcodeIDs];
+long long OpcodeStats::elidedDispatchCounts[numOpcodeIDs];
 int OpcodeStats::lastOpcode = -1;
 
 static OpcodeStats logger;
@@ -60,6 +61,9 @@ OpcodeStats::OpcodeStats()
     for (int i = 0; i < numOpcodeIDs; ++i)
         for (int j = 0; j < numOpcodeIDs; ++j)
             opcodePairCounts[i][j] = 0;
+
+    for (int i = 0; i < numOpcodeIDs; ++i)
+        elidedDispatchCounts[i] = 0;
 }
 
 static int compareOpcodeIndices(const void* left, const void* right)
@@ -90,6 +94,18 @@ static int compareOpcodePairIndices(const void* left, const void* right)
         return 0;
 }
 
+static bool isSuperinstruction(int opcode)
+{
+    switch (opcode) {
+#define SUPERINSTRUCTION_CASE(fused, first, second) case fused:
+    FOR_EACH_SUPERINSTRUCTION(SUPERINSTRUCTION_CASE)
+#undef SUPERINSTRUCTION_CASE
+        return true;
+    default:
+        return false;
+    }
+}
+
 OpcodeStats::~OpcodeStats()
 {
     long long totalInstructions = 0;
@@ -164,6 +180,41 @@ OpcodeStats::~OpcodeStats()
         
     }
     printf("\n");
+
+    long long totalElidedDispatches = 0;
+    for (int i = 0; i < numOpcodeIDs; ++i)
+        totalElidedDispatches += elidedDispatchCounts[i];
+
+    printf("Total dispatches: %lld (%lld elided by superinstructions)\n\n", totalInstructions - totalElidedDispatches, totalElidedDispatches);
+
+    printf("Superinstructions:\n\n");
+
+    // The count for the unfused pair is the number of times the pair still ran as two
+    // instructions, at sites the superinstruction pass did not cover.
+#define PRINT_SUPERINSTRUCTION(fused, first, second) \
+    printf("%s:%s %lld - %lld elided dispatches, %lld unfused\n", #fused, padOpcodeName(fused, 28), opcodeCounts[fused], elidedDispatchCounts[fused], opcodePairCounts[first][second]);
+    FOR_EACH_SUPERINSTRUCTION(PRINT_SUPERINSTRUCTION)
+#undef PRINT_SUPERINSTRUCTION
+
+    printf("\n");
+    printf("Superinstruction candidates:\n\n");
+
+    int candidates = 0;
+    for (int i = 0; i < numOpcodeIDs * numOpcodeIDs && candidates < 20; ++i) {
+        pair<int, int> indexPair = sortedPairIndices[i];
+        long long count = opcodePairCounts[indexPair.first][indexPair.second];
+
+        if (!count)
+            break;
+
+        OpcodeID superinstruction;
+        if (isSuperinstruction(indexPair.first) || superinstructionFor(static_cast<OpcodeID>(indexPair.first), static_cast<OpcodeID>(indexPair.second), superinstruction))
+            continue;
+
+        printf("%s%s %s:%s %lld - %.2f%%\n", opcodeNames[indexPair.first], padOpcodeName((OpcodeID)indexPair.first, 28), opcodeNames[indexPair.second], padOpcodeName((OpcodeID)indexPair.second, 28), count, ((double) count) / ((double) totalInstructionPairs) * 100.0);
+        ++candidates;
+    }
+    printf("\n");
 }
 
 void OpcodeStats::recordInstruction(int opcode)
@@ -176,6 +227,11 @@ void OpcodeStats::recordInstruction(int opcode)
     lastOpcode = opcode;
 }
 
+void OpcodeStats::recordElidedDispatch(int superinstruction)
+{
+    elidedDispatchCounts[superinstruction]++;
+}
+
 void OpcodeStats::resetLastInstruction()
 {
     lastOpcode = -1;
@@ -173,6 +173,9 @@ namespace JSC {
         macro(op_profile_will_call, 2) \
         macro(op_profile_did_call, 2) \
         \
+        macro(op_get_by_id_call, 8) \
+        macro(op_pre_inc_loop_if_less, 2) \
+        \
         macro(op_end, 2) // end must be the last opcode in the list
 
     #define OPCODE_ID_ENUM(opcode, length) opcode,
@@ -195,6 +198,29 @@ namespace JSC {
         FOR_EACH_OPCODE_ID(VERIFY_OPCODE_ID);
     #undef VERIFY_OPCODE_ID
 
+    // Superinstructions replace the first of two adjacent instructions and execute
+    // both. The second instruction is left in place, so a superinstruction has the
+    // length of the instruction it replaces, and jumps to the second one still work.
+    #define FOR_EACH_SUPERINSTRUCTION(macro) \
+        macro(op_get_by_id_call, op_get_by_id, op_call) \
+        macro(op_pre_inc_loop_if_less, op_pre_inc, op_loop_if_less)
+
+    #define VERIFY_SUPERINSTRUCTION_LENGTH(superinstruction, first, second) COMPILE_ASSERT(superinstruction##_length == first##_length, ASSERT_THAT_SUPERINSTRUCTIONS_REPLACE_ONE_INSTRUCTION);
+        FOR_EACH_SUPERINSTRUCTION(VERIFY_SUPERINSTRUCTION_LENGTH);
+    #undef VERIFY_SUPERINSTRUCTION_LENGTH
+
+    inline bool superinstructionFor(OpcodeID first, OpcodeID second, OpcodeID& superinstruction)
+    {
+        #define MATCH_SUPERINSTRUCTION(fused, firstID, secondID) \
+            if (first == firstID && second == secondID) { \
+                superinstruction = fused; \
+                return true; \
+            }
+            FOR_EACH_SUPERINSTRUCTION(MATCH_SUPERINSTRUCTION)
+        #undef MATCH_SUPERINSTRUCTION
+        return false;
+    }
+
 #if HAVE(COMPUTED_GOTO)
 #if COMPILER(RVCT)
     typedef void* Opcode;
@@ -231,9 +257,11 @@ namespace JSC {
         ~OpcodeStats();
         static long long opcodeCounts[numOpcodeIDs];
         static long long opcodePairCounts[numOpcodeIDs][numOpcodeIDs];
+        static long long elidedDispatchCounts[numOpcodeIDs];
         static int lastOpcode;
 
         static void recordInstruction(int opcode);
+        static void recordElidedDispatch(int superinstruction);
         static void resetLastInstruction();
     };
 
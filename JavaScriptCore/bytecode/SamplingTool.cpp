@@ -30,8 +30,10 @@
 #include "SamplingTool.h"
 
 #include "CodeBlock.h"
+#include "InternalFunction.h"
 #include "Interpreter.h"
 #include "Opcode.h"
+#include <wtf/CurrentTime.h>
 
 #if !OS(WINDOWS)
 #include <unistd.h>
@@ -157,6 +159,157 @@ void SamplingThread::stop()
 }
 
 
+// One frame of the sampled stacks, below the frames of its callers. Script frames are
+// told apart by executable, and host function frames by name.
+struct StackSampler::StackNode : public Noncopyable {
+    StackNode(ScriptExecutable* executable, CodeType codeType, const UString& name)
+        : executable(executable)
+        , codeType(codeType)
+        , name(name)
+        , sampleCount(0)
+    {
+    }
+
+    ~StackNode()
+    {
+        deleteAllValues(children);
+    }
+
+    StackNode* child(ScriptExecutable* childExecutable, CodeType childCodeType, const UString& childName)
+    {
+        for (size_t i = 0; i < children.size(); ++i) {
+            if (children[i]->executable == childExecutable && (childExecutable || children[i]->name == childName))
+                return children[i];
+        }
+        children.append(new StackNode(childExecutable, childCodeType, childName));
+        return children.last();
+    }
+
+    RefPtr<ScriptExecutable> executable;
+    CodeType codeType;
+    UString name;
+    unsigned sampleCount;
+    Vector<StackNode*> children;
+};
+
+// Very deep recursion is cut off at the outermost frames.
+static const size_t maximumSampledStackDepth = 256;
+
+// Keep the checks far enough apart that reading the clock stays cheap, and close enough
+// together that the sampler notices quickly when the code it is in speeds up.
+static const unsigned minimumTicksBetweenSamples = 16;
+static const unsigned maximumTicksBetweenSamples = 1 << 20;
+
+StackSampler::StackSampler(unsigned hertz)
+    : m_interval(1.0 / hertz)
+    , m_timeAtLastCheck(0)
+    , m_timeOfNextSample(0)
+    , m_sampleCount(0)
+    , m_root(new StackNode(0, GlobalCode, UString()))
+{
+}
+
+StackSampler::~StackSampler()
+{
+}
+
+void StackSampler::sampleIfDue(ExecState* exec)
+{
+    double now = currentTime();
+    if (now >= m_timeOfNextSample)
+        takeSample(exec, now);
+}
+
+void StackSampler::takeSample(ExecState* exec, double now)
+{
+    m_timeOfNextSample = now + m_interval;
+    ++m_sampleCount;
+
+    Vector<CallFrame*, 64> frames;
+    for (CallFrame* callFrame = exec; callFrame && frames.size() < maximumSampledStackDepth; callFrame = callFrame->callerFrame()->removeHostCallFrameFlag())
+        frames.append(callFrame);
+
+    StackNode* node = m_root.get();
+    for (size_t i = frames.size(); i--; ) {
+        CallFrame* callFrame = frames[i];
+        if (CodeBlock* codeBlock = callFrame->codeBlock())
+            node = node->child(codeBlock->ownerExecutable(), codeBlock->codeType(), UString());
+        else if (JSObject* callee = callFrame->callee()) {
+            if (callee->inherits(&InternalFunction::info))
+                node = node->child(0, GlobalCode, static_cast<InternalFunction*>(callee)->name(callFrame));
+        }
+    }
+    ++node->sampleCount;
+}
+
+unsigned StackSampler::sample(ExecState* exec, unsigned ticksSinceLastCheck)
+{
+    double now = currentTime();
+    double timeSinceLastCheck = now - m_timeAtLastCheck;
+    m_timeAtLastCheck = now;
+
+    if (now >= m_timeOfNextSample)
+        takeSample(exec, now);
+
+    // Scale the wait to how long the last one took, ignoring the gaps between scripts.
+    if (timeSinceLastCheck <= 0 || timeSinceLastCheck > 1)
+        return minimumTicksBetweenSamples;
+    double ticks = ticksSinceLastCheck * (m_interval / timeSinceLastCheck);
+    if (ticks < minimumTicksBetweenSamples)
+        return minimumTicksBetweenSamples;
+    if (ticks > maximumTicksBetweenSamples)
+        return maximumTicksBetweenSamples;
+    return static_cast<unsigned>(ticks);
+}
+
+static void appendFrameName(Vector<char>& path, ScriptExecutable* executable, CodeType codeType, const UString& hostFunctionName)
+{
+    UString name;
+    if (!executable)
+        name = makeString("[native] ", hostFunctionName.isEmpty() ? UString("(anonymous)") : hostFunctionName);
+    else {
+        UString functionName;
+        if (codeType == FunctionCode) {
+            functionName = static_cast<FunctionExecutable*>(executable)->name().ustring();
+            if (functionName.isEmpty())
+                functionName = "(anonymous)";
+        } else
+            functionName = codeType == EvalCode ? "(eval)" : "(program)";
+        name = makeString(functionName, " ", executable->sourceURL(), ":", UString::from(executable->lineNo()));
+    }
+
+    // Semicolons separate the frames of a collapsed stack.
+    CString utf8 = name.UTF8String();
+    for (const char* c = utf8.c_str(); *c; ++c)
+        path.append(*c == ';' ? ':' : *c);
+}
+
+void StackSampler::writeCollapsedStacks(FILE* file, const StackNode* node, Vector<char>& path) const
+{
+    size_t pathLength = path.size();
+    if (node != m_root.get()) {
+        if (pathLength)
+            path.append(';');
+        appendFrameName(path, node->executable.get(), node->codeType, node->name);
+    }
+
+    if (node->sampleCount) {
+        fwrite(path.data(), 1, path.size(), file);
+        fprintf(file, " %u\n", node->sampleCount);
+    }
+
+    for (size_t i = 0; i < node->children.size(); ++i)
+        writeCollapsedStacks(file, node->children[i], path);
+
+    path.shrink(pathLength);
+}
+
+void StackSampler::writeCollapsedStacks(FILE* file) const
+{
+    Vector<char> path;
+    writeCollapsedStacks(file, m_root.get(), path);
+}
+
 void ScriptSampleRecord::sample(CodeBlock* codeBlock, Instruction* vPC)
 {
     if (!m_samples) {
@@ -31,7 +31,10 @@
 
 #include <wtf/Assertions.h>
 #include <wtf/HashMap.h>
+#include <wtf/OwnPtr.h>
 #include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <stdio.h>
 
 #include "Nodes.h"
 #include "Opcode.h"
@@ -136,6 +139,45 @@ namespace JSC {
         static void* threadStartFunc(void*);
     };
 
+    // Samples the JavaScript call stack, at a rate that can be chosen when scripts are
+    // run, and writes the stacks seen in the collapsed format read by flame graph tools.
+    // Unlike the tools above it needs no special build. Samples are taken where the
+    // interpreter and JIT already check for script timeouts, at loop back edges. While a
+    // StackSampler is installed in the JSGlobalData, function returns are checked as well:
+    // code the JIT compiles at that time checks on return, and the interpreter tests for
+    // a sampler on each return. Without a sampler, JIT code is unchanged and the cost is
+    // that one test per interpreted return.
+    class StackSampler : public Noncopyable {
+    public:
+        StackSampler(unsigned hertz = 1000);
+        ~StackSampler();
+
+        // Called by the TimeoutChecker at each check, with the number of ticks it waited.
+        // Returns the number of ticks to wait so that the next check comes when the next
+        // sample is due.
+        unsigned sample(ExecState*, unsigned ticksSinceLastCheck);
+
+        // Called when native code re-enters JavaScript. Each re-entry restarts the
+        // TimeoutChecker's countdown, so short callbacks would otherwise never be sampled.
+        void sampleIfDue(ExecState*);
+
+        unsigned sampleCount() const { return m_sampleCount; }
+
+        void writeCollapsedStacks(FILE*) const;
+
+    private:
+        struct StackNode;
+
+        void takeSample(ExecState*, double now);
+        void writeCollapsedStacks(FILE*, const StackNode*, Vector<char>& path) const;
+
+        double m_interval;
+        double m_timeAtLastCheck;
+        double m_timeOfNextSample;
+        unsigned m_sampleCount;
+        OwnPtr<StackNode> m_root;
+    };
+
     class SamplingTool {
     public:
         friend struct CallRecord;
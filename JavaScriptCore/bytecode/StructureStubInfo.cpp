@@ -26,6 +26,12 @@
 #include "config.h"
 #include "StructureStubInfo.h"
 
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+#include <stdio.h>
+#include <stdlib.h>
+#include <wtf/Vector.h>
+#endif
+
 namespace JSC {
 
 #if ENABLE(JIT)
@@ -63,6 +69,12 @@ void StructureStubInfo::deref()
     case access_put_by_id_replace:
         u.putByIdReplace.baseObjectStructure->deref();
         return;
+    case access_put_by_id_replace_list: {
+        PolymorphicAccessStructureList* polymorphicStructures = u.putByIdReplaceList.structureList;
+        polymorphicStructures->derefStructures(u.putByIdReplaceList.listSize);
+        delete polymorphicStructures;
+        return;
+    }
     case access_get_by_id:
     case access_put_by_id:
     case access_get_by_id_generic:
@@ -77,4 +89,114 @@ void StructureStubInfo::deref()
 }
 #endif
 
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+
+static const char* accessTypeName(int accessType)
+{
+    switch (accessType) {
+    case access_get_by_id_self:
+        return "get_by_id_self";
+    case access_get_by_id_proto:
+        return "get_by_id_proto";
+    case access_get_by_id_chain:
+        return "get_by_id_chain";
+    case access_get_by_id_self_list:
+        return "get_by_id_self_list";
+    case access_get_by_id_proto_list:
+        return "get_by_id_proto_list";
+    case access_put_by_id_transition:
+        return "put_by_id_transition";
+    case access_put_by_id_replace:
+        return "put_by_id_replace";
+    case access_put_by_id_replace_list:
+        return "put_by_id_replace_list";
+    case access_get_by_id:
+        return "get_by_id";
+    case access_put_by_id:
+        return "put_by_id";
+    case access_get_by_id_generic:
+        return "get_by_id_generic";
+    case access_put_by_id_generic:
+        return "put_by_id_generic";
+    case access_get_array_length:
+        return "get_array_length";
+    case access_get_string_length:
+        return "get_string_length";
+    }
+    ASSERT_NOT_REACHED();
+    return "";
+}
+
+struct PropertyAccessSite {
+    CString location;
+    CString propertyName;
+    const char* accessType;
+    unsigned executionCount;
+    unsigned slowCaseCount;
+};
+
+// Collects the counts of sites whose code has been destroyed, and prints them on exit.
+class PropertyAccessStatistics {
+public:
+    ~PropertyAccessStatistics();
+
+    void add(const PropertyAccessSite& site) { m_sites.append(site); }
+
+private:
+    Vector<PropertyAccessSite> m_sites;
+};
+
+static PropertyAccessStatistics propertyAccessStatistics;
+
+static int compareSites(const void* left, const void* right)
+{
+    unsigned leftCount = static_cast<const PropertyAccessSite*>(left)->executionCount;
+    unsigned rightCount = static_cast<const PropertyAccessSite*>(right)->executionCount;
+    if (leftCount < rightCount)
+        return 1;
+    if (leftCount > rightCount)
+        return -1;
+    return 0;
+}
+
+PropertyAccessStatistics::~PropertyAccessStatistics()
+{
+    static const size_t maximumSitesPrinted = 100;
+
+    unsigned long long executionCount = 0;
+    unsigned long long slowCaseCount = 0;
+    for (size_t i = 0; i < m_sites.size(); ++i) {
+        executionCount += m_sites[i].executionCount;
+        slowCaseCount += m_sites[i].slowCaseCount;
+    }
+
+    qsort(m_sites.data(), m_sites.size(), sizeof(PropertyAccessSite), compareSites);
+
+    printf("\nProperty access statistics\n");
+    printf("%llu accesses at %u sites, %llu missed the inline caches\n\n", executionCount, static_cast<unsigned>(m_sites.size()), slowCaseCount);
+    printf("%12s %12s %6s  %-24s %-24s %s\n", "executions", "slow cases", "hits", "access", "property", "location");
+    for (size_t i = 0; i < m_sites.size() && i < maximumSitesPrinted; ++i) {
+        const PropertyAccessSite& site = m_sites[i];
+        double hitRate = 100.0 * (site.executionCount - site.slowCaseCount) / site.executionCount;
+        printf("%12u %12u %5.1f%%  %-24s %-24s %s\n", site.executionCount, site.slowCaseCount, hitRate, site.accessType, site.propertyName.c_str(), site.location.c_str());
+    }
+}
+
+void StructureStubInfo::recordStatistics(const UString& sourceURL) const
+{
+    // Bytecode regenerated to recover exception info is never run.
+    if (!executionCount)
+        return;
+
+    PropertyAccessSite site;
+    site.location = makeString(sourceURL, ":", UString::from(lineNumber)).UTF8String();
+    site.propertyName = propertyName ? UString(propertyName).UTF8String() : CString("");
+    site.accessType = accessTypeName(accessType);
+    site.executionCount = executionCount;
+    site.slowCaseCount = slowCaseCount;
+    propertyAccessStatistics.add(site);
+}
+
+#endif // ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+
 } // namespace JSC
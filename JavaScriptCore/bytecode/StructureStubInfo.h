@@ -43,6 +43,7 @@ namespace JSC {
         access_get_by_id_proto_list,
         access_put_by_id_transition,
         access_put_by_id_replace,
+        access_put_by_id_replace_list,
         access_get_by_id,
         access_put_by_id,
         access_get_by_id_generic,
@@ -55,6 +56,12 @@ namespace JSC {
         StructureStubInfo(AccessType accessType)
             : accessType(accessType)
             , seen(false)
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+            , propertyName(0)
+            , lineNumber(0)
+            , executionCount(0)
+            , slowCaseCount(0)
+#endif
         {
         }
 
@@ -128,6 +135,14 @@ namespace JSC {
             baseObjectStructure->ref();
         }
 
+        void initPutByIdReplaceList(PolymorphicAccessStructureList* structureList, int listSize)
+        {
+            accessType = access_put_by_id_replace_list;
+
+            u.putByIdReplaceList.structureList = structureList;
+            u.putByIdReplaceList.listSize = listSize;
+        }
+
         void deref();
 
         bool seenOnce()
@@ -140,6 +155,17 @@ namespace JSC {
             seen = true;
         }
 
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+        void setSite(const Identifier& name, int line)
+        {
+            propertyName = name.ustring().rep();
+            lineNumber = line;
+        }
+
+        // Adds this site's counts to the report printed at exit.
+        void recordStatistics(const UString& sourceURL) const;
+#endif
+
         int accessType : 31;
         int seen : 1;
 
@@ -171,11 +197,25 @@ namespace JSC {
             struct {
                 Structure* baseObjectStructure;
             } putByIdReplace;
+            struct {
+                PolymorphicAccessStructureList* structureList;
+                int listSize;
+            } putByIdReplaceList;
         } u;
 
         CodeLocationLabel stubRoutine;
         CodeLocationCall callReturnLocation;
         CodeLocationLabel hotPathBegin;
+
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+        // The name is owned by the CodeBlock's identifier list.
+        UString::Rep* propertyName;
+        int lineNumber;
+        // Incremented by the hot path in JIT code, and by the JIT stubs whenever the access
+        // was not handled by an inline cache or a stub routine.
+        unsigned executionCount;
+        unsigned slowCaseCount;
+#endif
     };
 
 } // namespace JSC
@@ -155,6 +155,10 @@ void BytecodeGenerator::generate()
         
     m_codeBlock->setIsNumericCompareFunction(instructions() == m_globalData->numericCompareFunction(m_scopeChain->globalObject()->globalExec()));
 
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS)
+    m_globalData->interpreter->fuseSuperinstructions(m_codeBlock);
+#endif
+
 #if !ENABLE(OPCODE_SAMPLING)
     if (!m_regeneratingForExceptionInfo && (m_codeType == FunctionCode || m_codeType == EvalCode))
         m_codeBlock->clearExceptionInfo();
@@ -1215,7 +1219,11 @@ void BytecodeGenerator::emitMethodCheck()
 RegisterID* BytecodeGenerator::emitGetById(RegisterID* dst, RegisterID* base, const Identifier& property)
 {
 #if ENABLE(JIT)
-    m_codeBlock->addStructureStubInfo(StructureStubInfo(access_get_by_id));
+    StructureStubInfo stubInfo(access_get_by_id);
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+    stubInfo.setSite(property, m_codeBlock->numberOfLineInfos() ? m_codeBlock->lastLineInfo().lineNumber : 0);
+#endif
+    m_codeBlock->addStructureStubInfo(stubInfo);
 #else
     m_codeBlock->addPropertyAccessInstruction(instructions().size());
 #endif
@@ -1234,7 +1242,11 @@ RegisterID* BytecodeGenerator::emitGetById(RegisterID* dst, RegisterID* base, co
 RegisterID* BytecodeGenerator::emitPutById(RegisterID* base, const Identifier& property, RegisterID* value)
 {
 #if ENABLE(JIT)
-    m_codeBlock->addStructureStubInfo(StructureStubInfo(access_put_by_id));
+    StructureStubInfo stubInfo(access_put_by_id);
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+    stubInfo.setSite(property, m_codeBlock->numberOfLineInfos() ? m_codeBlock->lastLineInfo().lineNumber : 0);
+#endif
+    m_codeBlock->addStructureStubInfo(stubInfo);
 #else
     m_codeBlock->addPropertyAccessInstruction(instructions().size());
 #endif
@@ -450,12 +450,20 @@ namespace JSC {
 
         PassRefPtr<FunctionExecutable> makeFunction(ExecState* exec, FunctionBodyNode* body)
         {
-            return FunctionExecutable::create(exec, body->ident(), body->source(), body->usesArguments(), body->parameters(), body->lineNo(), body->lastLine());
+            return FunctionExecutable::create(exec, body->ident(), functionSource(body), body->usesArguments(), body->parameters(), body->lineNo(), body->lastLine());
         }
 
         PassRefPtr<FunctionExecutable> makeFunction(JSGlobalData* globalData, FunctionBodyNode* body)
         {
-            return FunctionExecutable::create(globalData, body->ident(), body->source(), body->usesArguments(), body->parameters(), body->lineNo(), body->lastLine());
+            return FunctionExecutable::create(globalData, body->ident(), functionSource(body), body->usesArguments(), body->parameters(), body->lineNo(), body->lastLine());
+        }
+
+        // The tree may have come from the ParseCache, and been parsed from another provider
+        // holding the same text, so functions take their provider from the code block.
+        SourceCode functionSource(FunctionBodyNode* body)
+        {
+            const SourceCode& source = body->source();
+            return SourceCode(m_codeBlock->source(), source.startOffset(), source.endOffset(), source.firstLine());
         }
 
         Vector<Instruction>& instructions() { return m_codeBlock->instructions(); }
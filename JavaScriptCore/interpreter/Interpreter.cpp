@@ -308,7 +308,11 @@ NEVER_INLINE JSValue Interpreter::callEval(CallFrame* callFrame, RegisterFile* r
 
     ScopeChainNode* scopeChain = callFrame->scopeChain();
     CodeBlock* codeBlock = callFrame->codeBlock();
-    RefPtr<EvalExecutable> eval = codeBlock->evalCodeCache().get(callFrame, programSource, scopeChain, exceptionValue);
+
+    // Code compiled for the bare global scope does not depend on the calling code block,
+    // so evals made there share one cache per global object.
+    EvalCodeCache& evalCodeCache = scopeChain->next ? codeBlock->evalCodeCache() : scopeChain->globalObject->evalCodeCache();
+    RefPtr<EvalExecutable> eval = evalCodeCache.get(callFrame, programSource, scopeChain, exceptionValue);
 
     JSValue result = jsUndefined();
     if (eval)
@@ -676,6 +680,8 @@ JSValue Interpreter::execute(FunctionExecutable* functionExecutable, CallFrame*
     Profiler** profiler = Profiler::enabledProfilerReference();
     if (*profiler)
         (*profiler)->willExecute(callFrame, function);
+    if (StackSampler* stackSampler = scopeChain->globalData->stackSampler)
+        stackSampler->sampleIfDue(newCallFrame);
 
     JSValue result;
     {
@@ -744,6 +750,8 @@ JSValue Interpreter::execute(CallFrameClosure& closure, JSValue* exception)
     Profiler** profiler = Profiler::enabledProfilerReference();
     if (*profiler)
         (*profiler)->willExecute(closure.oldCallFrame, closure.function);
+    if (StackSampler* stackSampler = closure.globalData->stackSampler)
+        stackSampler->sampleIfDue(closure.newCallFrame);
     
     JSValue result;
     {
@@ -1086,6 +1094,132 @@ NEVER_INLINE void Interpreter::uncacheGetByID(CodeBlock* codeBlock, Instruction*
     vPC[4] = 0;
 }
 
+NEVER_INLINE void Interpreter::tryCacheGetByIDList(CallFrame* callFrame, CodeBlock* codeBlock, Instruction* vPC, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot)
+{
+    Opcode opcode = vPC[0].u.opcode;
+    bool isSelfAccess = opcode == getOpcode(op_get_by_id_self) || opcode == getOpcode(op_get_by_id_self_list);
+    bool isProtoAccess = opcode == getOpcode(op_get_by_id_proto) || opcode == getOpcode(op_get_by_id_proto_list);
+
+    // Recursive invocation may already have uncached this instruction.
+    if (!isSelfAccess && !isProtoAccess)
+        return;
+
+    Structure* structure = baseValue.isCell() ? asCell(baseValue)->structure() : 0;
+
+    // Uncacheable, or a different kind of access than this list holds: give up.
+    if (!structure || !slot.isCacheable() || structure->isUncacheableDictionary()
+        || (isSelfAccess && slot.slotBase() != baseValue)
+        || (isProtoAccess && (structure->isDictionary() || slot.slotBase() != structure->prototypeForLookup(callFrame)))) {
+        codeBlock->derefStructures(vPC);
+        vPC[0] = getOpcode(op_get_by_id_generic);
+        return;
+    }
+
+    // First miss on a monomorphic site: move its cached Structures into a list.
+    if (opcode == getOpcode(op_get_by_id_self)) {
+        vPC[0] = getOpcode(op_get_by_id_self_list);
+        vPC[4] = new PolymorphicAccessStructureList(vPC[5].u.operand, vPC[4].u.structure);
+        vPC[5] = 1;
+    } else if (opcode == getOpcode(op_get_by_id_proto)) {
+        vPC[0] = getOpcode(op_get_by_id_proto_list);
+        vPC[4] = new PolymorphicAccessStructureList(vPC[6].u.operand, vPC[4].u.structure, vPC[5].u.structure);
+        vPC[5] = 1;
+    }
+
+    PolymorphicAccessStructureList* polymorphicStructures = vPC[4].u.polymorphicStructures;
+    int listSize = vPC[5].u.operand;
+
+    // List full: give up.
+    if (listSize == POLYMORPHIC_LIST_CACHE_SIZE) {
+        codeBlock->derefStructures(vPC);
+        vPC[0] = getOpcode(op_get_by_id_generic);
+        return;
+    }
+
+    if (isSelfAccess) {
+        structure->ref();
+        polymorphicStructures->list[listSize].set(slot.cachedOffset(), structure);
+        vPC[5] = listSize + 1;
+        return;
+    }
+
+    JSObject* baseObject = asObject(slot.slotBase());
+    size_t offset = slot.cachedOffset();
+
+    // Since we're accessing a prototype in a loop, it's a good bet that it
+    // should not be treated as a dictionary.
+    if (baseObject->structure()->isDictionary()) {
+        baseObject->flattenDictionaryObject();
+        offset = baseObject->structure()->get(propertyName);
+    }
+
+    ASSERT(!baseObject->structure()->isUncacheableDictionary());
+
+    structure->ref();
+    baseObject->structure()->ref();
+    polymorphicStructures->list[listSize].set(offset, structure, baseObject->structure());
+    vPC[5] = listSize + 1;
+}
+
+NEVER_INLINE void Interpreter::tryCacheGetByIDCall(CallFrame* callFrame, CodeBlock* codeBlock, Instruction* vPC, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot)
+{
+    // Replace whatever the cache held, which may have been filled by a recursive invocation.
+    codeBlock->derefStructures(vPC);
+    vPC[4] = 0;
+    vPC[5] = 0;
+
+    if (!baseValue.isCell() || !slot.isCacheable())
+        return;
+
+    Structure* structure = asCell(baseValue)->structure();
+    if (structure->isUncacheableDictionary())
+        return;
+
+    if (slot.slotBase() == baseValue) {
+        vPC[4] = structure;
+        vPC[6] = slot.cachedOffset();
+        codeBlock->refStructures(vPC);
+        return;
+    }
+
+    if (structure->isDictionary() || slot.slotBase() != structure->prototypeForLookup(callFrame))
+        return;
+
+    JSObject* baseObject = asObject(slot.slotBase());
+    size_t offset = slot.cachedOffset();
+
+    if (baseObject->structure()->isDictionary()) {
+        baseObject->flattenDictionaryObject();
+        offset = baseObject->structure()->get(propertyName);
+    }
+
+    ASSERT(!baseObject->structure()->isUncacheableDictionary());
+
+    vPC[4] = structure;
+    vPC[5] = baseObject->structure();
+    vPC[6] = offset;
+    codeBlock->refStructures(vPC);
+}
+
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS)
+void Interpreter::fuseSuperinstructions(CodeBlock* codeBlock)
+{
+    Vector<Instruction>& instructions = codeBlock->instructions();
+
+    size_t next;
+    for (size_t i = 0; i < instructions.size(); i = next) {
+        OpcodeID opcodeID = getOpcodeID(instructions[i].u.opcode);
+        next = i + opcodeLengths[opcodeID];
+        if (next >= instructions.size())
+            break;
+
+        OpcodeID superinstruction;
+        if (superinstructionFor(opcodeID, getOpcodeID(instructions[next].u.opcode), superinstruction))
+            instructions[i] = getOpcode(superinstruction);
+    }
+}
+#endif
+
 #endif // USE(INTERPRETER)
 
 JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFile, CallFrame* callFrame, JSValue* exception)
@@ -1155,6 +1289,12 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
     #define DEFINE_OPCODE(opcode) opcode: OpcodeStats::recordInstruction(opcode);
 #else
     #define DEFINE_OPCODE(opcode) opcode:
+#endif
+    // A superinstruction jumps straight to the handler for the instruction it was fused with.
+#if ENABLE(OPCODE_STATS)
+    #define NEXT_FUSED_INSTRUCTION(superinstruction, opcode) OpcodeStats::recordElidedDispatch(superinstruction); SAMPLE(callFrame->codeBlock(), vPC); goto opcode
+#else
+    #define NEXT_FUSED_INSTRUCTION(superinstruction, opcode) SAMPLE(callFrame->codeBlock(), vPC); goto opcode
 #endif
     NEXT_INSTRUCTION();
 #else
@@ -1164,6 +1304,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
 #else
     #define DEFINE_OPCODE(opcode) case opcode:
 #endif
+    #define NEXT_FUSED_INSTRUCTION(superinstruction, opcode) NEXT_INSTRUCTION()
     while (1) { // iterator loop begins
     interpreterLoopStart:;
     switch (vPC->u.opcode)
@@ -1387,6 +1528,26 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         vPC += OPCODE_LENGTH(op_pre_inc);
         NEXT_INSTRUCTION();
     }
+    DEFINE_OPCODE(op_pre_inc_loop_if_less) {
+        /* pre_inc_loop_if_less srcDst(r)
+
+           Superinstruction for a pre_inc followed by a loop_if_less, as
+           at the bottom of a counting for loop. Performs the pre_inc, then
+           continues into the loop_if_less without a dispatch.
+        */
+        int srcDst = vPC[1].u.operand;
+        JSValue v = callFrame->r(srcDst).jsValue();
+        if (v.isInt32() && v.asInt32() < INT_MAX)
+            callFrame->r(srcDst) = jsNumber(callFrame, v.asInt32() + 1);
+        else {
+            JSValue result = jsNumber(callFrame, v.toNumber(callFrame) + 1);
+            CHECK_FOR_EXCEPTION();
+            callFrame->r(srcDst) = result;
+        }
+
+        vPC += OPCODE_LENGTH(op_pre_inc_loop_if_less);
+        NEXT_FUSED_INSTRUCTION(op_pre_inc_loop_if_less, op_loop_if_less);
+    }
     DEFINE_OPCODE(op_pre_dec) {
         /* pre_dec srcDst(r)
 
@@ -2094,12 +2255,71 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         vPC += OPCODE_LENGTH(op_get_by_id);
         NEXT_INSTRUCTION();
     }
+    DEFINE_OPCODE(op_get_by_id_call) {
+        /* get_by_id_call dst(r) base(r) property(id) structure(sID) prototypeStructure(sID) offset(n) nop(n)
+
+           Superinstruction for a get_by_id followed by a call, as in a
+           method call without arguments. Gets the property named by
+           identifier property from the value base through a one-entry
+           cache of base's Structure, and of its prototype's Structure if
+           the property was found there, then continues into the call
+           without a dispatch. If the cache misses, the property is
+           fetched and the cache refilled.
+        */
+        int dst = vPC[1].u.operand;
+        int base = vPC[2].u.operand;
+        JSValue baseValue = callFrame->r(base).jsValue();
+
+        if (LIKELY(baseValue.isCell())) {
+            JSCell* baseCell = asCell(baseValue);
+            Structure* structure = vPC[4].u.structure;
+
+            if (LIKELY(baseCell->structure() == structure)) {
+                Structure* prototypeStructure = vPC[5].u.structure;
+                int offset = vPC[6].u.operand;
+
+                if (!prototypeStructure) {
+                    ASSERT(baseCell->isObject());
+                    JSObject* baseObject = asObject(baseCell);
+
+                    ASSERT(baseObject->get(callFrame, callFrame->codeBlock()->identifier(vPC[3].u.operand)) == baseObject->getDirectOffset(offset));
+                    callFrame->r(dst) = JSValue(baseObject->getDirectOffset(offset));
+
+                    vPC += OPCODE_LENGTH(op_get_by_id_call);
+                    NEXT_FUSED_INSTRUCTION(op_get_by_id_call, op_call);
+                }
+
+                ASSERT(structure->prototypeForLookup(callFrame).isObject());
+                JSObject* protoObject = asObject(structure->prototypeForLookup(callFrame));
+
+                if (LIKELY(protoObject->structure() == prototypeStructure)) {
+                    ASSERT(baseValue.get(callFrame, callFrame->codeBlock()->identifier(vPC[3].u.operand)) == protoObject->getDirectOffset(offset));
+                    callFrame->r(dst) = JSValue(protoObject->getDirectOffset(offset));
+
+                    vPC += OPCODE_LENGTH(op_get_by_id_call);
+                    NEXT_FUSED_INSTRUCTION(op_get_by_id_call, op_call);
+                }
+            }
+        }
+
+        CodeBlock* codeBlock = callFrame->codeBlock();
+        Identifier& ident = codeBlock->identifier(vPC[3].u.operand);
+        PropertySlot slot(baseValue);
+        JSValue result = baseValue.get(callFrame, ident, slot);
+        CHECK_FOR_EXCEPTION();
+
+        tryCacheGetByIDCall(callFrame, codeBlock, vPC, baseValue, ident, slot);
+
+        callFrame->r(dst) = result;
+        vPC += OPCODE_LENGTH(op_get_by_id_call);
+        NEXT_FUSED_INSTRUCTION(op_get_by_id_call, op_call);
+    }
     DEFINE_OPCODE(op_get_by_id_self) {
         /* op_get_by_id_self dst(r) base(r) property(id) structure(sID) offset(n) nop(n) nop(n)
 
            Cached property access: Attempts to get a cached property from the
-           value base. If the cache misses, op_get_by_id_self reverts to
-           op_get_by_id.
+           value base. If the cache misses, op_get_by_id_self gets the
+           property and becomes op_get_by_id_self_list.
         */
         int base = vPC[2].u.operand;
         JSValue baseValue = callFrame->r(base).jsValue();
@@ -2122,7 +2342,17 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
             }
         }
 
-        uncacheGetByID(callFrame->codeBlock(), vPC);
+        // Cache miss: get the property and add baseValue's Structure to the cache.
+        CodeBlock* codeBlock = callFrame->codeBlock();
+        Identifier& ident = codeBlock->identifier(vPC[3].u.operand);
+        PropertySlot slot(baseValue);
+        JSValue result = baseValue.get(callFrame, ident, slot);
+        CHECK_FOR_EXCEPTION();
+
+        tryCacheGetByIDList(callFrame, codeBlock, vPC, baseValue, ident, slot);
+
+        callFrame->r(vPC[1].u.operand) = result;
+        vPC += OPCODE_LENGTH(op_get_by_id_self);
         NEXT_INSTRUCTION();
     }
     DEFINE_OPCODE(op_get_by_id_proto) {
@@ -2130,7 +2360,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
 
            Cached property access: Attempts to get a cached property from the
            value base's prototype. If the cache misses, op_get_by_id_proto
-           reverts to op_get_by_id.
+           gets the property and becomes op_get_by_id_proto_list.
         */
         int base = vPC[2].u.operand;
         JSValue baseValue = callFrame->r(base).jsValue();
@@ -2158,20 +2388,114 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
             }
         }
 
-        uncacheGetByID(callFrame->codeBlock(), vPC);
+        // Cache miss: get the property and add baseValue's Structure to the cache.
+        CodeBlock* codeBlock = callFrame->codeBlock();
+        Identifier& ident = codeBlock->identifier(vPC[3].u.operand);
+        PropertySlot slot(baseValue);
+        JSValue result = baseValue.get(callFrame, ident, slot);
+        CHECK_FOR_EXCEPTION();
+
+        tryCacheGetByIDList(callFrame, codeBlock, vPC, baseValue, ident, slot);
+
+        callFrame->r(vPC[1].u.operand) = result;
+        vPC += OPCODE_LENGTH(op_get_by_id_proto);
         NEXT_INSTRUCTION();
     }
     DEFINE_OPCODE(op_get_by_id_self_list) {
-        // Polymorphic self access caching currently only supported when JITting.
-        ASSERT_NOT_REACHED();
-        // This case of the switch must not be empty, else (op_get_by_id_self_list == op_get_by_id_chain)!
+        /* op_get_by_id_self_list dst(r) base(r) property(id) structureList(list) listSize(n) nop(n) nop(n)
+
+           Polymorphic cached property access: Attempts to get a cached
+           property from the value base, for any of the Structures in
+           structureList. If the cache misses, the property is fetched
+           and its Structure added to the list. Once the list is full, or
+           on an access that cannot be cached, op_get_by_id_self_list
+           becomes op_get_by_id_generic.
+        */
+        int base = vPC[2].u.operand;
+        JSValue baseValue = callFrame->r(base).jsValue();
+
+        if (LIKELY(baseValue.isCell())) {
+            JSCell* baseCell = asCell(baseValue);
+            Structure* structure = baseCell->structure();
+            PolymorphicAccessStructureList* polymorphicStructures = vPC[4].u.polymorphicStructures;
+            int listSize = vPC[5].u.operand;
+
+            for (int i = 0; i < listSize; ++i) {
+                if (polymorphicStructures->list[i].base == structure) {
+                    ASSERT(baseCell->isObject());
+                    JSObject* baseObject = asObject(baseCell);
+                    int dst = vPC[1].u.operand;
+                    size_t offset = polymorphicStructures->list[i].stubRoutine;
+
+                    ASSERT(baseObject->get(callFrame, callFrame->codeBlock()->identifier(vPC[3].u.operand)) == baseObject->getDirectOffset(offset));
+                    callFrame->r(dst) = JSValue(baseObject->getDirectOffset(offset));
+
+                    vPC += OPCODE_LENGTH(op_get_by_id_self_list);
+                    NEXT_INSTRUCTION();
+                }
+            }
+        }
+
+        // Cache miss: get the property and add baseValue's Structure to the cache.
+        CodeBlock* codeBlock = callFrame->codeBlock();
+        Identifier& ident = codeBlock->identifier(vPC[3].u.operand);
+        PropertySlot slot(baseValue);
+        JSValue result = baseValue.get(callFrame, ident, slot);
+        CHECK_FOR_EXCEPTION();
+
+        tryCacheGetByIDList(callFrame, codeBlock, vPC, baseValue, ident, slot);
+
+        callFrame->r(vPC[1].u.operand) = result;
         vPC += OPCODE_LENGTH(op_get_by_id_self_list);
         NEXT_INSTRUCTION();
     }
     DEFINE_OPCODE(op_get_by_id_proto_list) {
-        // Polymorphic prototype access caching currently only supported when JITting.
-        ASSERT_NOT_REACHED();
-        // This case of the switch must not be empty, else (op_get_by_id_proto_list == op_get_by_id_chain)!
+        /* op_get_by_id_proto_list dst(r) base(r) property(id) structureList(list) listSize(n) nop(n) nop(n)
+
+           Polymorphic cached property access: Attempts to get a cached
+           property from the value base's prototype, for any of the pairs
+           of base and prototype Structures in structureList. Misses are
+           handled as in op_get_by_id_self_list.
+        */
+        int base = vPC[2].u.operand;
+        JSValue baseValue = callFrame->r(base).jsValue();
+
+        if (LIKELY(baseValue.isCell())) {
+            JSCell* baseCell = asCell(baseValue);
+            Structure* structure = baseCell->structure();
+            PolymorphicAccessStructureList* polymorphicStructures = vPC[4].u.polymorphicStructures;
+            int listSize = vPC[5].u.operand;
+
+            for (int i = 0; i < listSize; ++i) {
+                if (polymorphicStructures->list[i].base != structure)
+                    continue;
+
+                ASSERT(structure->prototypeForLookup(callFrame).isObject());
+                JSObject* protoObject = asObject(structure->prototypeForLookup(callFrame));
+                if (protoObject->structure() != polymorphicStructures->list[i].u.proto)
+                    continue;
+
+                int dst = vPC[1].u.operand;
+                size_t offset = polymorphicStructures->list[i].stubRoutine;
+
+                ASSERT(baseValue.get(callFrame, callFrame->codeBlock()->identifier(vPC[3].u.operand)) == protoObject->getDirectOffset(offset));
+                callFrame->r(dst) = JSValue(protoObject->getDirectOffset(offset));
+
+                vPC += OPCODE_LENGTH(op_get_by_id_proto_list);
+                NEXT_INSTRUCTION();
+            }
+        }
+
+        // Cache miss: get the property and add baseValue's Structure to the cache.
+        CodeBlock* codeBlock = callFrame->codeBlock();
+        Identifier& ident = codeBlock->identifier(vPC[3].u.operand);
+        PropertySlot slot(baseValue);
+        JSValue result = baseValue.get(callFrame, ident, slot);
+        CHECK_FOR_EXCEPTION();
+
+        tryCacheGetByIDList(callFrame, codeBlock, vPC, baseValue, ident, slot);
+
+        callFrame->r(vPC[1].u.operand) = result;
         vPC += OPCODE_LENGTH(op_get_by_id_proto_list);
         NEXT_INSTRUCTION();
     }
@@ -3081,7 +3405,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         if (callType == CallTypeHost) {
             ScopeChainNode* scopeChain = callFrame->scopeChain();
             CallFrame* newCallFrame = CallFrame::create(callFrame->registers() + registerOffset);
-            newCallFrame->init(0, vPC + 5, scopeChain, callFrame, dst, argCount, 0);
+            newCallFrame->init(0, vPC + 5, scopeChain, callFrame, dst, argCount, asObject(v));
 
             Register* thisRegister = newCallFrame->registers() - RegisterFile::CallFrameHeaderSize - argCount;
             ArgList args(thisRegister + 1, argCount - 1);
@@ -3235,7 +3559,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         if (callType == CallTypeHost) {
             ScopeChainNode* scopeChain = callFrame->scopeChain();
             CallFrame* newCallFrame = CallFrame::create(callFrame->registers() + registerOffset);
-            newCallFrame->init(0, vPC + 5, scopeChain, callFrame, dst, argCount, 0);
+            newCallFrame->init(0, vPC + 5, scopeChain, callFrame, dst, argCount, asObject(v));
             
             Register* thisRegister = newCallFrame->registers() - RegisterFile::CallFrameHeaderSize - argCount;
             ArgList args(thisRegister + 1, argCount - 1);
@@ -3317,6 +3641,12 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
 
         int result = vPC[1].u.operand;
 
+        // Code that does its work through calls rather than loops would otherwise never be
+        // seen by the stack sampler. Without one, returns are left unchecked, as before.
+        if (globalData->stackSampler) {
+            CHECK_FOR_TIMEOUT();
+        }
+
         if (callFrame->codeBlock()->needsFullScopeChain())
             callFrame->scopeChain()->deref();
 
@@ -3893,6 +4223,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
 #endif
 #endif // USE(INTERPRETER)
     #undef NEXT_INSTRUCTION
+    #undef NEXT_FUSED_INSTRUCTION
     #undef DEFINE_OPCODE
     #undef CHECK_FOR_EXCEPTION
     #undef CHECK_FOR_TIMEOUT
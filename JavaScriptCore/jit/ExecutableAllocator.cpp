@@ -29,10 +29,331 @@
 
 #if ENABLE(ASSEMBLER)
 
+#include <wtf/Threading.h>
+
+#if HAVE(MADV_DONTNEED)
+#include <errno.h>
+#include <sys/mman.h>
+#endif
+
+#if DUMP_EXECUTABLE_ALLOCATOR_STATISTICS
+#include <stdio.h>
+#endif
+
 namespace JSC {
 
 size_t ExecutableAllocator::pageSize = 0;
 
+// Hands out page-multiple chunks of executable memory to the pools of one
+// ExecutableAllocator. Memory is taken from the system a region at a time, so compiling
+// a function costs no system call once the arena is warm, and chunks are carved first
+// fit by address to keep live code packed towards the start of each region. A chunk
+// given back when its pool dies is merged with its free neighbours at once and its pages
+// are decommitted; a region that becomes entirely free goes back to the system, except
+// for a last ordinary sized one, which is kept to absorb the next compile.
+//
+// Pools can be released on a thread other than the one that allocates from the arena
+// (a RegExp compiled for one thread may be collected on another), hence the lock.
+class ExecutableArena : public ThreadSafeShared<ExecutableArena> {
+public:
+    static PassRefPtr<ExecutableArena> create() { return adoptRef(new ExecutableArena); }
+    ~ExecutableArena();
+
+    ExecutablePool::Allocation allocate(size_t);
+    void release(const ExecutablePool::Allocation&);
+
+    ExecutableMemoryStatistics statistics();
+
+private:
+    struct Region {
+        ExecutablePool::Allocation allocation;
+        size_t freeBytes;
+    };
+
+    struct FreeChunk {
+        char* pages;
+        size_t size;
+    };
+
+    ExecutableArena();
+
+    Region* regionFor(char* pages);
+    void addRegion(size_t);
+    void releaseRegion(Region*);
+    void addFreeChunk(Region*, char* pages, size_t);
+    size_t fragmentedBytes() const;
+
+    Mutex m_lock;
+    Vector<Region> m_regions;
+    // Sorted by address; chunks that touch within a region are always merged.
+    Vector<FreeChunk> m_freeChunks;
+    size_t m_reservedBytes;
+    size_t m_allocatedBytes;
+
+#if DUMP_EXECUTABLE_ALLOCATOR_STATISTICS
+    size_t m_maxReservedBytes;
+    size_t m_maxAllocatedBytes;
+    size_t m_maxFragmentedBytes;
+    unsigned m_regionsReserved;
+    unsigned m_regionsReleased;
+#endif
+};
+
+static inline void decommitPages(char* pages, size_t size)
+{
+#if HAVE(MADV_DONTNEED)
+    // The pages read back as zeroes when next touched, so nothing has to recommit them.
+    while (madvise(pages, size, MADV_DONTNEED) == -1 && errno == EAGAIN) { }
+#else
+    UNUSED_PARAM(pages);
+    UNUSED_PARAM(size);
+#endif
+}
+
+ExecutableArena::ExecutableArena()
+    : m_reservedBytes(0)
+    , m_allocatedBytes(0)
+#if DUMP_EXECUTABLE_ALLOCATOR_STATISTICS
+    , m_maxReservedBytes(0)
+    , m_maxAllocatedBytes(0)
+    , m_maxFragmentedBytes(0)
+    , m_regionsReserved(0)
+    , m_regionsReleased(0)
+#endif
+{
+}
+
+ExecutableArena::~ExecutableArena()
+{
+    // Every pool holds a reference to the arena, so by now nothing is allocated.
+    ASSERT(!m_allocatedBytes);
+
+#if DUMP_EXECUTABLE_ALLOCATOR_STATISTICS
+    printf("\nJSC::ExecutableAllocator statistics\n\n");
+    printf("%lu bytes reserved at most\n", static_cast<unsigned long>(m_maxReservedBytes));
+    printf("%lu bytes allocated at most\n", static_cast<unsigned long>(m_maxAllocatedBytes));
+    printf("%lu bytes fragmented at most\n", static_cast<unsigned long>(m_maxFragmentedBytes));
+    printf("%u regions reserved, %u released before exit\n", m_regionsReserved, m_regionsReleased);
+#endif
+
+    for (size_t i = 0; i < m_regions.size(); ++i)
+        ExecutablePool::systemRelease(m_regions[i].allocation);
+}
+
+ExecutableArena::Region* ExecutableArena::regionFor(char* pages)
+{
+    for (size_t i = 0; i < m_regions.size(); ++i) {
+        Region& region = m_regions[i];
+        if (pages >= region.allocation.pages && pages < region.allocation.pages + region.allocation.size)
+            return &region;
+    }
+    ASSERT_NOT_REACHED();
+    return 0;
+}
+
+void ExecutableArena::addRegion(size_t size)
+{
+    ExecutablePool::Allocation allocation = ExecutablePool::systemAlloc(size);
+    if (!allocation.pages)
+        CRASH(); // Failed to allocate
+
+    Region region = { allocation, 0 };
+    m_regions.append(region);
+    m_reservedBytes += size;
+    addFreeChunk(&m_regions.last(), allocation.pages, size);
+
+#if DUMP_EXECUTABLE_ALLOCATOR_STATISTICS
+    ++m_regionsReserved;
+    if (m_reservedBytes > m_maxReservedBytes)
+        m_maxReservedBytes = m_reservedBytes;
+#endif
+}
+
+void ExecutableArena::releaseRegion(Region* region)
+{
+    // An entirely free region is a single free chunk.
+    for (size_t i = 0; i < m_freeChunks.size(); ++i) {
+        if (m_freeChunks[i].pages == region->allocation.pages) {
+            ASSERT(m_freeChunks[i].size == region->allocation.size);
+            m_freeChunks.remove(i);
+            break;
+        }
+    }
+
+    m_reservedBytes -= region->allocation.size;
+    ExecutablePool::systemRelease(region->allocation);
+    m_regions.remove(region - m_regions.begin());
+
+#if DUMP_EXECUTABLE_ALLOCATOR_STATISTICS
+    ++m_regionsReleased;
+#endif
+}
+
+void ExecutableArena::addFreeChunk(Region* region, char* pages, size_t size)
+{
+    region->freeBytes += size;
+
+    char* regionStart = region->allocation.pages;
+    char* regionEnd = regionStart + region->allocation.size;
+
+    size_t index = 0;
+    while (index < m_freeChunks.size() && m_freeChunks[index].pages < pages)
+        ++index;
+
+    // Distinct regions may happen to be adjacent in memory, but each is given back to the
+    // system whole, so a chunk is only merged with neighbours inside its own region.
+    bool mergesWithPrevious = index && m_freeChunks[index - 1].pages >= regionStart
+        && m_freeChunks[index - 1].pages + m_freeChunks[index - 1].size == pages;
+    bool mergesWithNext = index < m_freeChunks.size() && m_freeChunks[index].pages < regionEnd
+        && pages + size == m_freeChunks[index].pages;
+
+    if (mergesWithPrevious) {
+        m_freeChunks[index - 1].size += size;
+        if (mergesWithNext) {
+            m_freeChunks[index - 1].size += m_freeChunks[index].size;
+            m_freeChunks.remove(index);
+        }
+    } else if (mergesWithNext) {
+        m_freeChunks[index].pages = pages;
+        m_freeChunks[index].size += size;
+    } else {
+        FreeChunk chunk = { pages, size };
+        m_freeChunks.insert(index, chunk);
+    }
+}
+
+ExecutablePool::Allocation ExecutableArena::allocate(size_t size)
+{
+    ASSERT(!(size % JIT_ALLOCATOR_PAGE_SIZE));
+    MutexLocker locker(m_lock);
+
+    size_t index = 0;
+    while (index < m_freeChunks.size() && m_freeChunks[index].size < size)
+        ++index;
+    if (index == m_freeChunks.size()) {
+        // Requests larger than a region get a region of their own, which goes straight
+        // back to the system when its pool dies.
+        addRegion(std::max<size_t>(size, JIT_ALLOCATOR_REGION_SIZE));
+        index = 0;
+        while (m_freeChunks[index].size < size)
+            ++index;
+    }
+
+    FreeChunk& chunk = m_freeChunks[index];
+    Region* region = regionFor(chunk.pages);
+
+    // Keep whatever else the platform records about the region (the RChunk on Symbian).
+    ExecutablePool::Allocation result = region->allocation;
+    result.pages = chunk.pages;
+    result.size = size;
+
+    if (chunk.size == size)
+        m_freeChunks.remove(index);
+    else {
+        chunk.pages += size;
+        chunk.size -= size;
+    }
+    region->freeBytes -= size;
+    m_allocatedBytes += size;
+
+#if DUMP_EXECUTABLE_ALLOCATOR_STATISTICS
+    if (m_allocatedBytes > m_maxAllocatedBytes)
+        m_maxAllocatedBytes = m_allocatedBytes;
+    m_maxFragmentedBytes = std::max(m_maxFragmentedBytes, fragmentedBytes());
+#endif
+
+    return result;
+}
+
+void ExecutableArena::release(const ExecutablePool::Allocation& allocation)
+{
+    MutexLocker locker(m_lock);
+
+    Region* region = regionFor(allocation.pages);
+    m_allocatedBytes -= allocation.size;
+    addFreeChunk(region, allocation.pages, allocation.size);
+
+    if (region->freeBytes == region->allocation.size && (m_regions.size() > 1 || region->allocation.size > JIT_ALLOCATOR_REGION_SIZE)) {
+        releaseRegion(region);
+        return;
+    }
+
+    decommitPages(allocation.pages, allocation.size);
+}
+
+size_t ExecutableArena::fragmentedBytes() const
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < m_freeChunks.size(); ++i) {
+        if (m_freeChunks[i].size < JIT_ALLOCATOR_LARGE_ALLOC_SIZE)
+            bytes += m_freeChunks[i].size;
+    }
+    return bytes;
+}
+
+ExecutableMemoryStatistics ExecutableArena::statistics()
+{
+    MutexLocker locker(m_lock);
+
+    ExecutableMemoryStatistics statistics;
+    statistics.reservedBytes = m_reservedBytes;
+    statistics.allocatedBytes = m_allocatedBytes;
+    statistics.freeBytes = m_reservedBytes - m_allocatedBytes;
+    statistics.fragmentedBytes = fragmentedBytes();
+    return statistics;
+}
+
+ExecutablePool::ExecutablePool(ExecutableArena* arena, size_t n)
+    : m_arena(arena)
+{
+    size_t allocSize = roundUpAllocationSize(n, JIT_ALLOCATOR_PAGE_SIZE);
+    Allocation mem = m_arena->allocate(allocSize);
+    m_pools.append(mem);
+    m_freePtr = mem.pages;
+    m_end = m_freePtr + allocSize;
+}
+
+ExecutablePool::~ExecutablePool()
+{
+    AllocationList::const_iterator end = m_pools.end();
+    for (AllocationList::const_iterator ptr = m_pools.begin(); ptr != end; ++ptr)
+        m_arena->release(*ptr);
+}
+
+void* ExecutablePool::poolAllocate(size_t n)
+{
+    size_t allocSize = roundUpAllocationSize(n, JIT_ALLOCATOR_PAGE_SIZE);
+    
+    Allocation result = m_arena->allocate(allocSize);
+    
+    ASSERT(m_end >= m_freePtr);
+    if ((allocSize - n) > static_cast<size_t>(m_end - m_freePtr)) {
+        // Replace allocation pool
+        m_freePtr = result.pages + n;
+        m_end = result.pages + allocSize;
+    }
+
+    m_pools.append(result);
+    return result.pages;
+}
+
+ExecutableAllocator::ExecutableAllocator()
+{
+    if (!pageSize)
+        intializePageSize();
+    m_arena = ExecutableArena::create();
+    m_smallAllocationPool = ExecutablePool::create(m_arena.get(), JIT_ALLOCATOR_LARGE_ALLOC_SIZE);
+}
+
+ExecutableAllocator::~ExecutableAllocator()
+{
+}
+
+ExecutableMemoryStatistics ExecutableAllocator::statistics() const
+{
+    return m_arena->statistics();
+}
+
 }
 
 #endif // HAVE(ASSEMBLER)
@@ -51,6 +51,11 @@ extern "C" __declspec(dllimport) void CacheRangeFlush(LPVOID pAddr, DWORD dwLeng
 
 #define JIT_ALLOCATOR_PAGE_SIZE (ExecutableAllocator::pageSize)
 #define JIT_ALLOCATOR_LARGE_ALLOC_SIZE (ExecutableAllocator::pageSize * 4)
+#define JIT_ALLOCATOR_REGION_SIZE (ExecutableAllocator::pageSize * 64)
+
+// Set to 1 to print, as each ExecutableAllocator is destroyed, how much executable
+// memory it reserved and how fragmented that memory became.
+#define DUMP_EXECUTABLE_ALLOCATOR_STATISTICS 0
 
 #if ENABLE(ASSEMBLER_WX_EXCLUSIVE)
 #define PROTECTION_FLAGS_RW (PROT_READ | PROT_WRITE)
@@ -80,7 +85,17 @@ inline size_t roundUpAllocationSize(size_t request, size_t granularity)
 
 namespace JSC {
 
+class ExecutableArena;
+
+struct ExecutableMemoryStatistics {
+    size_t reservedBytes; // Taken from the system, whether in use or not.
+    size_t allocatedBytes; // Handed out to ExecutablePools.
+    size_t freeBytes; // Reserved but not allocated; these pages are decommitted where the system allows.
+    size_t fragmentedBytes; // The part of freeBytes in pieces too small to hold a new small pool.
+};
+
 class ExecutablePool : public RefCounted<ExecutablePool> {
+    friend class ExecutableArena;
 private:
     struct Allocation {
         char* pages;
@@ -92,9 +107,9 @@ private:
     typedef Vector<Allocation, 2> AllocationList;
 
 public:
-    static PassRefPtr<ExecutablePool> create(size_t n)
+    static PassRefPtr<ExecutablePool> create(ExecutableArena* arena, size_t n)
     {
-        return adoptRef(new ExecutablePool(n));
+        return adoptRef(new ExecutablePool(arena, n));
     }
 
     void* alloc(size_t n)
@@ -116,12 +131,7 @@ public:
         return poolAllocate(n);
     }
     
-    ~ExecutablePool()
-    {
-        AllocationList::const_iterator end = m_pools.end();
-        for (AllocationList::const_iterator ptr = m_pools.begin(); ptr != end; ++ptr)
-            ExecutablePool::systemRelease(*ptr);
-    }
+    ~ExecutablePool();
 
     size_t available() const { return (m_pools.size() > 1) ? 0 : m_end - m_freePtr; }
 
@@ -129,10 +139,13 @@ private:
     static Allocation systemAlloc(size_t n);
     static void systemRelease(const Allocation& alloc);
 
-    ExecutablePool(size_t n);
+    ExecutablePool(ExecutableArena*, size_t n);
 
     void* poolAllocate(size_t n);
 
+    // The pages come from, and go back to, the arena of the allocator that created the
+    // pool, which may outlive it.
+    RefPtr<ExecutableArena> m_arena;
     char* m_freePtr;
     char* m_end;
     AllocationList m_pools;
@@ -143,12 +156,8 @@ class ExecutableAllocator {
 
 public:
     static size_t pageSize;
-    ExecutableAllocator()
-    {
-        if (!pageSize)
-            intializePageSize();
-        m_smallAllocationPool = ExecutablePool::create(JIT_ALLOCATOR_LARGE_ALLOC_SIZE);
-    }
+    ExecutableAllocator();
+    ~ExecutableAllocator();
 
     PassRefPtr<ExecutablePool> poolForSize(size_t n)
     {
@@ -158,10 +167,10 @@ public:
 
         // If the request is large, we just provide a unshared allocator
         if (n > JIT_ALLOCATOR_LARGE_ALLOC_SIZE)
-            return ExecutablePool::create(n);
+            return ExecutablePool::create(m_arena.get(), n);
 
         // Create a new allocator
-        RefPtr<ExecutablePool> pool = ExecutablePool::create(JIT_ALLOCATOR_LARGE_ALLOC_SIZE);
+        RefPtr<ExecutablePool> pool = ExecutablePool::create(m_arena.get(), JIT_ALLOCATOR_LARGE_ALLOC_SIZE);
 
         // If the new allocator will result in more free space than in
         // the current small allocator, then we will use it instead
@@ -170,6 +179,8 @@ public:
         return pool.release();
     }
 
+    ExecutableMemoryStatistics statistics() const;
+
 #if ENABLE(ASSEMBLER_WX_EXCLUSIVE)
     static void makeWritable(void* start, size_t size)
     {
@@ -248,40 +259,13 @@ private:
     static void reprotectRegion(void*, size_t, ProtectionSeting);
 #endif
 
+    // Each allocator carves its pools out of its own arena, so JSGlobalData instances
+    // on different threads never contend for executable memory.
+    RefPtr<ExecutableArena> m_arena;
     RefPtr<ExecutablePool> m_smallAllocationPool;
     static void intializePageSize();
 };
 
-inline ExecutablePool::ExecutablePool(size_t n)
-{
-    size_t allocSize = roundUpAllocationSize(n, JIT_ALLOCATOR_PAGE_SIZE);
-    Allocation mem = systemAlloc(allocSize);
-    m_pools.append(mem);
-    m_freePtr = mem.pages;
-    if (!m_freePtr)
-        CRASH(); // Failed to allocate
-    m_end = m_freePtr + allocSize;
-}
-
-inline void* ExecutablePool::poolAllocate(size_t n)
-{
-    size_t allocSize = roundUpAllocationSize(n, JIT_ALLOCATOR_PAGE_SIZE);
-    
-    Allocation result = systemAlloc(allocSize);
-    if (!result.pages)
-        CRASH(); // Failed to allocate
-    
-    ASSERT(m_end >= m_freePtr);
-    if ((allocSize - n) > static_cast<size_t>(m_end - m_freePtr)) {
-        // Replace allocation pool
-        m_freePtr = result.pages + n;
-        m_end = result.pages + allocSize;
-    }
-
-    m_pools.append(result);
-    return result.pages;
-}
-
 }
 
 #endif // ENABLE(ASSEMBLER)
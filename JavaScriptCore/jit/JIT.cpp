@@ -316,6 +316,7 @@ void JIT::privateCompileMainPass()
         DEFINE_OP(op_to_primitive)
 
         case op_get_array_length:
+        case op_get_by_id_call:
         case op_get_by_id_chain:
         case op_get_by_id_generic:
         case op_get_by_id_proto:
@@ -323,6 +324,7 @@ void JIT::privateCompileMainPass()
         case op_get_by_id_self:
         case op_get_by_id_self_list:
         case op_get_string_length:
+        case op_pre_inc_loop_if_less:
         case op_put_by_id_generic:
         case op_put_by_id_replace:
         case op_put_by_id_transition:
@@ -140,6 +140,9 @@ void JIT::emit_op_ret(Instruction* currentInstruction)
 {
     unsigned dst = currentInstruction[1].u.operand;
 
+    if (m_globalData->stackSampler)
+        emitTimeoutCheck();
+
     // We could JIT generate the deref, only calling out to C when the refcount hits zero.
     if (m_codeBlock->needsFullScopeChain())
         JITStubCall(this, cti_op_ret_scopeChain).call();
@@ -151,6 +151,8 @@ void JIT::privateCompileCTIMachineTrampolines(RefPtr<ExecutablePool>* executable
     emitGetFromCallFrameHeaderPtr(RegisterFile::CallerFrame, regT1);
     emitGetFromCallFrameHeaderPtr(RegisterFile::ScopeChain, regT1, regT1);
     emitPutToCallFrameHeader(regT1, RegisterFile::ScopeChain);
+    // Host frames have no CodeBlock; clear the slot so that stack walkers can tell.
+    emitPutImmediateToCallFrameHeader(0, RegisterFile::CodeBlock);
     
 #if CPU(X86)
     emitGetFromCallFrameHeader32(RegisterFile::ArgumentCount, regT0);
@@ -1610,6 +1612,8 @@ void JIT::privateCompileCTIMachineTrampolines(RefPtr<ExecutablePool>* executable
     emitGetFromCallFrameHeaderPtr(RegisterFile::CallerFrame, regT1);
     emitGetFromCallFrameHeaderPtr(RegisterFile::ScopeChain, regT1, regT1);
     emitPutToCallFrameHeader(regT1, RegisterFile::ScopeChain);
+    // Host frames have no CodeBlock; clear the slot so that stack walkers can tell.
+    emitPutImmediateToCallFrameHeader(0, RegisterFile::CodeBlock);
     
 
 #if CPU(X86_64)
@@ -2056,6 +2060,11 @@ void JIT::emit_op_tear_off_arguments(Instruction*)
 
 void JIT::emit_op_ret(Instruction* currentInstruction)
 {
+    // As in the interpreter, returns only check for timeouts while a stack sampler is
+    // installed, so that code without loops is sampled too.
+    if (m_globalData->stackSampler)
+        emitTimeoutCheck();
+
     // We could JIT generate the deref, only calling out to C when the refcount hits zero.
     if (m_codeBlock->needsFullScopeChain())
         JITStubCall(this, cti_op_ret_scopeChain).call();
@@ -2797,8 +2806,12 @@ void JIT::emitSlow_op_get_by_val(Instruction* currentInstruction, Vector<SlowCas
     linkSlowCase(iter); // property int32 check
     linkSlowCaseIfNotJSCell(iter, base); // base cell check
     linkSlowCase(iter); // base array check
-    linkSlowCase(iter); // vector length check
     linkSlowCase(iter); // empty value
+    linkSlowCase(iter); // typed vector length check
+#if !USE(JSVALUE64)
+    linkSlowCase(iter); // typed vector holds doubles
+    linkSlowCase(iter); // int32 does not fit in an immediate
+#endif
 
     JITStubCall stubCall(this, cti_op_get_by_val);
     stubCall.addArgument(base, regT2);
@@ -2837,7 +2850,10 @@ void JIT::emitSlow_op_put_by_val(Instruction* currentInstruction, Vector<SlowCas
     linkSlowCase(iter); // property int32 check
     linkSlowCaseIfNotJSCell(iter, base); // base cell check
     linkSlowCase(iter); // base not array check
-    linkSlowCase(iter); // in vector check
+    linkSlowCase(iter); // typed vector length check
+    linkSlowCase(iter); // typed vector capacity check
+    linkSlowCase(iter); // value is not an int32
+    linkSlowCase(iter); // value is not a number, or the vector holds doubles
 
     JITStubCall stubPutByValCall(this, cti_op_put_by_val);
     stubPutByValCall.addArgument(regT0);
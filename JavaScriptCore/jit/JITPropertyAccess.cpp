@@ -380,6 +380,10 @@ void JIT::compileGetByIdHotPath()
     // to array-length / prototype access tranpolines, and finally we also the the property-map access offset as a label
     // to jump back to if one of these trampolies finds a match.
 
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+    add32(Imm32(1), AbsoluteAddress(&m_codeBlock->structureStubInfo(m_propertyAccessInstructionIndex).executionCount));
+#endif
+
     BEGIN_UNINTERRUPTED_SEQUENCE(sequenceGetByIdHotPath);
     
     Label hotPathBegin(this);
@@ -459,6 +463,10 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
 
     emitJumpSlowCaseIfNotJSCell(base, regT1);
 
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+    add32(Imm32(1), AbsoluteAddress(&m_codeBlock->structureStubInfo(m_propertyAccessInstructionIndex).executionCount));
+#endif
+
     BEGIN_UNINTERRUPTED_SEQUENCE(sequencePutById);
 
     Label hotPathBegin(this);
@@ -614,6 +622,46 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     repatchBuffer.relinkCallerToTrampoline(returnAddress, entryLabel);
 }
 
+void JIT::privateCompilePutByIdReplaceList(StructureStubInfo* stubInfo, PolymorphicAccessStructureList* polymorphicStructures, int currentIndex, Structure* structure, size_t cachedOffset, ReturnAddressPtr returnAddress)
+{
+    // Like a transition stub, this is called in place of the slow case's call to the runtime, with the base
+    // in regT1:regT0 and the value on the stack. Stubs for other Structures are chained through the failure case.
+    JumpList failureCases;
+    failureCases.append(branch32(NotEqual, regT1, Imm32(JSValue::CellTag)));
+    failureCases.append(checkStructure(regT0, structure));
+
+    load32(Address(stackPointerRegister, offsetof(struct JITStackFrame, args[2]) + sizeof(void*)), regT3);
+    load32(Address(stackPointerRegister, offsetof(struct JITStackFrame, args[2]) + sizeof(void*) + 4), regT2);
+    compilePutDirectOffset(regT0, regT2, regT3, structure, cachedOffset);
+    ret();
+
+    failureCases.link(this);
+    CodeLocationLabel previousStub = polymorphicStructures->list[currentIndex - 1].stubRoutine;
+    Jump previousStubJump;
+    Call failureCall;
+    if (previousStub.executableAddress())
+        previousStubJump = jump();
+    else {
+        restoreArgumentReferenceForTrampoline();
+        failureCall = tailRecursiveCall();
+    }
+
+    LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
+
+    if (previousStub.executableAddress())
+        patchBuffer.link(previousStubJump, previousStub);
+    else
+        patchBuffer.link(failureCall, FunctionPtr(cti_op_put_by_id_replace_fail));
+
+    CodeLocationLabel entryLabel = patchBuffer.finalizeCodeAddendum();
+
+    structure->ref();
+    polymorphicStructures->list[currentIndex].set(entryLabel, structure);
+
+    RepatchBuffer repatchBuffer(m_codeBlock);
+    repatchBuffer.relinkCallerToTrampoline(returnAddress, entryLabel);
+}
+
 void JIT::patchGetByIdSelf(CodeBlock* codeBlock, StructureStubInfo* stubInfo, Structure* structure, size_t cachedOffset, ReturnAddressPtr returnAddress)
 {
     RepatchBuffer repatchBuffer(codeBlock);
@@ -660,9 +708,8 @@ void JIT::patchPutByIdReplace(CodeBlock* codeBlock, StructureStubInfo* stubInfo,
 {
     RepatchBuffer repatchBuffer(codeBlock);
 
-    // We don't want to patch more than once - in future go to cti_op_put_by_id_generic.
-    // Should probably go to cti_op_put_by_id_fail, but that doesn't do anything interesting right now.
-    repatchBuffer.relinkCallerToFunction(returnAddress, FunctionPtr(cti_op_put_by_id_generic));
+    // Other Structures seen at this site are handled by stubs built by cti_op_put_by_id_replace_fail.
+    repatchBuffer.relinkCallerToFunction(returnAddress, FunctionPtr(cti_op_put_by_id_replace_fail));
 
     int offset = sizeof(JSValue) * cachedOffset;
 
@@ -1043,11 +1090,36 @@ void JIT::emit_op_get_by_val(Instruction* currentInstruction)
     addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr)));
 
     loadPtr(Address(regT0, OBJECT_OFFSETOF(JSArray, m_storage)), regT2);
-    addSlowCase(branch32(AboveOrEqual, regT1, Address(regT0, OBJECT_OFFSETOF(JSArray, m_vectorLength))));
+    Jump notInVector = branch32(AboveOrEqual, regT1, Address(regT0, OBJECT_OFFSETOF(JSArray, m_vectorLength)));
 
     loadPtr(BaseIndex(regT2, regT1, ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])), regT0);
     addSlowCase(branchTestPtr(Zero, regT0));
+    Jump done = jump();
+
+    // Typed storage keeps m_vectorLength at zero, so all of its reads come here. Generic storage
+    // never has more values than its vector length, so for it the bounds check below always fails.
+    notInVector.link(this);
+    addSlowCase(branch32(AboveOrEqual, regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector))));
+#if USE(JSVALUE64)
+    Jump isDouble = branch32(NotEqual, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_mode)), Imm32(Int32ArrayStorage));
+    load32(BaseIndex(regT2, regT1, TimesFour, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])), regT0);
+    emitFastArithIntToImmNoCheck(regT0, regT0);
+    Jump loadedInt32 = jump();
+
+    // A JSValue is the size of a double, so the double vector can be indexed like the boxed one.
+    isDouble.link(this);
+    loadPtr(BaseIndex(regT2, regT1, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])), regT0);
+    subPtr(tagTypeNumberRegister, regT0);
+    loadedInt32.link(this);
+#else
+    // Boxing a double would allocate a JSNumberCell, so double reads are left to the stub.
+    addSlowCase(branch32(NotEqual, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_mode)), Imm32(Int32ArrayStorage)));
+    load32(BaseIndex(regT2, regT1, TimesFour, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])), regT0);
+    addSlowCase(branchAdd32(Overflow, regT0, regT0));
+    emitFastArithReTagImmediate(regT0, regT0);
+#endif
 
+    done.link(this);
     emitPutVirtualRegister(dst);
 }
 
@@ -1123,9 +1195,9 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
 #endif
     emitJumpSlowCaseIfNotJSCell(regT0, base);
     addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr)));
-    addSlowCase(branch32(AboveOrEqual, regT1, Address(regT0, OBJECT_OFFSETOF(JSArray, m_vectorLength))));
 
     loadPtr(Address(regT0, OBJECT_OFFSETOF(JSArray, m_storage)), regT2);
+    Jump notInVector = branch32(AboveOrEqual, regT1, Address(regT0, OBJECT_OFFSETOF(JSArray, m_vectorLength)));
 
     Jump empty = branchTestPtr(Zero, BaseIndex(regT2, regT1, ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
 
@@ -1143,6 +1215,45 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
     store32(regT0, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_length)));
     jump().linkTo(storeResult, this);
 
+    // Typed storage: the index may overwrite a value or append one, as long as the vector has room.
+    // Generic storage has no typed vector, so for it the capacity check below always fails.
+    // The base stays in regT0 until all slow cases have been checked, since the stub call needs it.
+    notInVector.link(this);
+    addSlowCase(branch32(Above, regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector))));
+    addSlowCase(branch32(AboveOrEqual, regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_typedVectorLength))));
+    emitGetVirtualRegister(value, regT3);
+
+    Jump isDouble = branch32(NotEqual, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_mode)), Imm32(Int32ArrayStorage));
+    emitJumpSlowCaseIfNotImmediateInteger(regT3);
+    emitFastArithImmToInt(regT3);
+    store32(regT3, BaseIndex(regT2, regT1, TimesFour, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
+#if USE(JSVALUE64)
+    Jump storedInt32 = jump();
+
+    isDouble.link(this);
+    Jump valueIsInt32 = emitJumpIfImmediateInteger(regT3);
+    addSlowCase(emitJumpIfNotImmediateNumber(regT3));
+    addPtr(tagTypeNumberRegister, regT3);
+    Jump haveDouble = jump();
+    valueIsInt32.link(this);
+    convertInt32ToDouble(regT3, fpRegT0);
+    moveDoubleToPtr(fpRegT0, regT3);
+    haveDouble.link(this);
+    storePtr(regT3, BaseIndex(regT2, regT1, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
+    storedInt32.link(this);
+#else
+    // Storing into a double vector would unbox a JSNumberCell; leave it to the stub.
+    addSlowCase(isDouble);
+#endif
+
+    Jump overwrote = branch32(NotEqual, regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)));
+    add32(Imm32(1), Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)));
+    Jump withinLength = branch32(Below, regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_length)));
+    add32(Imm32(1), regT1);
+    store32(regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_length)));
+
+    overwrote.link(this);
+    withinLength.link(this);
     end.link(this);
 }
 
@@ -1333,6 +1444,10 @@ void JIT::compileGetByIdHotPath(int, int baseVReg, Identifier*, unsigned propert
 
     emitJumpSlowCaseIfNotJSCell(regT0, baseVReg);
 
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+    add32(Imm32(1), AbsoluteAddress(&m_codeBlock->structureStubInfo(propertyAccessInstructionIndex).executionCount));
+#endif
+
     BEGIN_UNINTERRUPTED_SEQUENCE(sequenceGetByIdHotPath);
 
     Label hotPathBegin(this);
@@ -1414,6 +1529,10 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
     // Jump to a slow case if either the base object is an immediate, or if the Structure does not match.
     emitJumpSlowCaseIfNotJSCell(regT0, baseVReg);
 
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+    add32(Imm32(1), AbsoluteAddress(&m_codeBlock->structureStubInfo(propertyAccessInstructionIndex).executionCount));
+#endif
+
     BEGIN_UNINTERRUPTED_SEQUENCE(sequencePutById);
 
     Label hotPathBegin(this);
@@ -1565,6 +1684,44 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     repatchBuffer.relinkCallerToTrampoline(returnAddress, entryLabel);
 }
 
+void JIT::privateCompilePutByIdReplaceList(StructureStubInfo* stubInfo, PolymorphicAccessStructureList* polymorphicStructures, int currentIndex, Structure* structure, size_t cachedOffset, ReturnAddressPtr returnAddress)
+{
+    // Like a transition stub, this is called in place of the slow case's call to the runtime, with the base
+    // in regT0 and the value in regT1. Stubs for other Structures are chained through the failure case.
+    JumpList failureCases;
+    failureCases.append(emitJumpIfNotJSCell(regT0));
+    failureCases.append(checkStructure(regT0, structure));
+
+    compilePutDirectOffset(regT0, regT1, structure, cachedOffset);
+    ret();
+
+    failureCases.link(this);
+    CodeLocationLabel previousStub = polymorphicStructures->list[currentIndex - 1].stubRoutine;
+    Jump previousStubJump;
+    Call failureCall;
+    if (previousStub.executableAddress())
+        previousStubJump = jump();
+    else {
+        restoreArgumentReferenceForTrampoline();
+        failureCall = tailRecursiveCall();
+    }
+
+    LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
+
+    if (previousStub.executableAddress())
+        patchBuffer.link(previousStubJump, previousStub);
+    else
+        patchBuffer.link(failureCall, FunctionPtr(cti_op_put_by_id_replace_fail));
+
+    CodeLocationLabel entryLabel = patchBuffer.finalizeCodeAddendum();
+
+    structure->ref();
+    polymorphicStructures->list[currentIndex].set(entryLabel, structure);
+
+    RepatchBuffer repatchBuffer(m_codeBlock);
+    repatchBuffer.relinkCallerToTrampoline(returnAddress, entryLabel);
+}
+
 void JIT::patchGetByIdSelf(CodeBlock* codeBlock, StructureStubInfo* stubInfo, Structure* structure, size_t cachedOffset, ReturnAddressPtr returnAddress)
 {
     RepatchBuffer repatchBuffer(codeBlock);
@@ -1610,9 +1767,8 @@ void JIT::patchPutByIdReplace(CodeBlock* codeBlock, StructureStubInfo* stubInfo,
 {
     RepatchBuffer repatchBuffer(codeBlock);
 
-    // We don't want to patch more than once - in future go to cti_op_put_by_id_generic.
-    // Should probably go to cti_op_put_by_id_fail, but that doesn't do anything interesting right now.
-    repatchBuffer.relinkCallerToFunction(returnAddress, FunctionPtr(cti_op_put_by_id_generic));
+    // Other Structures seen at this site are handled by stubs built by cti_op_put_by_id_replace_fail.
+    repatchBuffer.relinkCallerToFunction(returnAddress, FunctionPtr(cti_op_put_by_id_replace_fail));
 
     int offset = sizeof(JSValue) * cachedOffset;
 
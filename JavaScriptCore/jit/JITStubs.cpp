@@ -48,6 +48,7 @@
 #include "JSPropertyNameIterator.h"
 #include "JSStaticScopeObject.h"
 #include "JSString.h"
+#include "MegamorphicAccessCache.h"
 #include "ObjectPrototype.h"
 #include "Operations.h"
 #include "Parser.h"
@@ -1010,6 +1011,12 @@ static NEVER_INLINE void throwStackOverflowError(CallFrame* callFrame, JSGlobalD
         } \
     } while (0)
 
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS)
+#define COUNT_PROPERTY_ACCESS_SLOW_CASE() (stackFrame.callFrame->codeBlock()->getStubInfo(STUB_RETURN_ADDRESS).slowCaseCount++)
+#else
+#define COUNT_PROPERTY_ACCESS_SLOW_CASE()
+#endif
+
 #if CPU(ARM_THUMB2)
 
 #define DEFINE_STUB_FUNCTION(rtype, op) \
@@ -1193,25 +1200,47 @@ DEFINE_STUB_FUNCTION(JSObject*, op_new_object)
     return constructEmptyObject(stackFrame.callFrame);
 }
 
+// Used by get_by_id and put_by_id sites that have given up on caching in code, either because
+// they have seen too many Structures or because their accesses can't be cached per site.
+static inline JSValue megamorphicGetById(CallFrame* callFrame, JSValue baseValue, const Identifier& ident)
+{
+    MegamorphicAccessCache* cache = callFrame->globalData().megamorphicAccessCache;
+    JSValue result;
+    if (cache->get(baseValue, ident, result))
+        return result;
+
+    PropertySlot slot(baseValue);
+    result = baseValue.get(callFrame, ident, slot);
+    cache->addGet(baseValue, ident, slot);
+    return result;
+}
+
+static inline void megamorphicPutById(CallFrame* callFrame, JSValue baseValue, const Identifier& ident, JSValue value)
+{
+    MegamorphicAccessCache* cache = callFrame->globalData().megamorphicAccessCache;
+    if (cache->put(baseValue, ident, value))
+        return;
+
+    PutPropertySlot slot;
+    baseValue.put(callFrame, ident, value, slot);
+    cache->addPut(baseValue, ident, slot);
+}
+
 DEFINE_STUB_FUNCTION(void, op_put_by_id_generic)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
-    PutPropertySlot slot;
-    stackFrame.args[0].jsValue().put(stackFrame.callFrame, stackFrame.args[1].identifier(), stackFrame.args[2].jsValue(), slot);
+    megamorphicPutById(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier(), stackFrame.args[2].jsValue());
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_generic)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
-    CallFrame* callFrame = stackFrame.callFrame;
-    Identifier& ident = stackFrame.args[1].identifier();
-
-    JSValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(callFrame, ident, slot);
+    JSValue result = megamorphicGetById(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier());
 
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
@@ -1222,6 +1251,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_generic)
 DEFINE_STUB_FUNCTION(void, op_put_by_id)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
     CallFrame* callFrame = stackFrame.callFrame;
     Identifier& ident = stackFrame.args[1].identifier();
 
@@ -1241,14 +1271,58 @@ DEFINE_STUB_FUNCTION(void, op_put_by_id)
 DEFINE_STUB_FUNCTION(void, op_put_by_id_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
+
+    megamorphicPutById(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier(), stackFrame.args[2].jsValue());
+
+    CHECK_FOR_EXCEPTION_AT_END();
+}
+
+DEFINE_STUB_FUNCTION(void, op_put_by_id_replace_fail)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
     CallFrame* callFrame = stackFrame.callFrame;
     Identifier& ident = stackFrame.args[1].identifier();
+    JSValue baseValue = stackFrame.args[0].jsValue();
+
+    CodeBlock* codeBlock = callFrame->codeBlock();
+    StructureStubInfo* stubInfo = &codeBlock->getStubInfo(STUB_RETURN_ADDRESS);
+
+    // Once the list is full the stubs fall through to here, rather than to the generic stub.
+    if (stubInfo->accessType == access_put_by_id_replace_list && stubInfo->u.putByIdReplaceList.listSize == POLYMORPHIC_LIST_CACHE_SIZE) {
+        megamorphicPutById(callFrame, baseValue, ident, stackFrame.args[2].jsValue());
+        CHECK_FOR_EXCEPTION_AT_END();
+        return;
+    }
 
     PutPropertySlot slot;
-    stackFrame.args[0].jsValue().put(callFrame, ident, stackFrame.args[2].jsValue(), slot);
+    baseValue.put(callFrame, ident, stackFrame.args[2].jsValue(), slot);
 
-    CHECK_FOR_EXCEPTION_AT_END();
+    CHECK_FOR_EXCEPTION_VOID();
+
+    if (baseValue.isCell()
+        && slot.type() == PutPropertySlot::ExistingProperty
+        && slot.base() == baseValue
+        && !asCell(baseValue)->structure()->isDictionary()) {
+
+        PolymorphicAccessStructureList* polymorphicStructureList;
+        int listIndex = 1;
+
+        if (stubInfo->accessType == access_put_by_id_replace) {
+            ASSERT(!stubInfo->stubRoutine);
+            polymorphicStructureList = new PolymorphicAccessStructureList(CodeLocationLabel(), stubInfo->u.putByIdReplace.baseObjectStructure);
+            stubInfo->initPutByIdReplaceList(polymorphicStructureList, 2);
+        } else {
+            polymorphicStructureList = stubInfo->u.putByIdReplaceList.structureList;
+            listIndex = stubInfo->u.putByIdReplaceList.listSize;
+            stubInfo->u.putByIdReplaceList.listSize++;
+        }
+
+        JIT::compilePutByIdReplaceList(callFrame->scopeChain()->globalData, codeBlock, stubInfo, polymorphicStructureList, listIndex, asCell(baseValue)->structure(), slot.cachedOffset(), STUB_RETURN_ADDRESS);
+    } else
+        ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_put_by_id_generic));
 }
 
 DEFINE_STUB_FUNCTION(JSObject*, op_put_by_id_transition_realloc)
@@ -1269,6 +1343,7 @@ DEFINE_STUB_FUNCTION(JSObject*, op_put_by_id_transition_realloc)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_method_check)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
     CallFrame* callFrame = stackFrame.callFrame;
     Identifier& ident = stackFrame.args[1].identifier();
@@ -1342,6 +1417,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_method_check)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
     CallFrame* callFrame = stackFrame.callFrame;
     Identifier& ident = stackFrame.args[1].identifier();
 
@@ -1363,6 +1439,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_self_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
     CallFrame* callFrame = stackFrame.callFrame;
     Identifier& ident = stackFrame.args[1].identifier();
@@ -1437,6 +1514,7 @@ static PolymorphicAccessStructureList* getPolymorphicAccessStructureListSlot(Str
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
     CallFrame* callFrame = stackFrame.callFrame;
     const Identifier& propertyName = stackFrame.args[1].identifier();
@@ -1498,10 +1576,9 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list_full)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
-    JSValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(stackFrame.callFrame, stackFrame.args[1].identifier(), slot);
+    JSValue result = megamorphicGetById(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier());
 
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
@@ -1510,10 +1587,9 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list_full)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
-    JSValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(stackFrame.callFrame, stackFrame.args[1].identifier(), slot);
+    JSValue result = megamorphicGetById(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier());
 
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
@@ -1522,6 +1598,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_fail)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_array_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
     JSValue baseValue = stackFrame.args[0].jsValue();
     PropertySlot slot(baseValue);
@@ -1534,6 +1611,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_array_fail)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_string_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    COUNT_PROPERTY_ACCESS_SLOW_CASE();
 
     JSValue baseValue = stackFrame.args[0].jsValue();
     PropertySlot slot(baseValue);
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "MegamorphicAccessCache.h"
+
+#if ENABLE(JIT)
+
+namespace JSC {
+
+MegamorphicAccessCache::MegamorphicAccessCache()
+    : m_hits(0)
+    , m_misses(0)
+{
+}
+
+// Only Structures that are not dictionaries are cached: a dictionary keeps its Structure when
+// properties are added to or removed from it, so its offsets can change under the entry.
+void MegamorphicAccessCache::addGet(JSValue base, const Identifier& propertyName, const PropertySlot& slot)
+{
+    if (!base.isObject() || !slot.isCacheable())
+        return;
+
+    Structure* structure = asObject(base)->structure();
+    if (structure->isDictionary())
+        return;
+
+    Structure* prototypeStructure = 0;
+    if (slot.slotBase() != base) {
+        if (slot.slotBase() != structure->storedPrototype())
+            return;
+        prototypeStructure = asObject(slot.slotBase())->structure();
+        if (prototypeStructure->isDictionary())
+            return;
+    }
+
+    Entry& entry = m_getEntries[tableIndex(structure, propertyName.ustring().rep())];
+    entry.structure = structure;
+    entry.propertyName = propertyName.ustring().rep();
+    entry.prototypeStructure = prototypeStructure;
+    entry.offset = slot.cachedOffset();
+}
+
+void MegamorphicAccessCache::addPut(JSValue base, const Identifier& propertyName, const PutPropertySlot& slot)
+{
+    // New properties change the object's Structure, so only stores to existing ones are cached.
+    if (!base.isObject() || slot.type() != PutPropertySlot::ExistingProperty || slot.base() != asObject(base))
+        return;
+
+    Structure* structure = asObject(base)->structure();
+    if (structure->isDictionary())
+        return;
+
+    Entry& entry = m_putEntries[tableIndex(structure, propertyName.ustring().rep())];
+    entry.structure = structure;
+    entry.propertyName = propertyName.ustring().rep();
+    entry.prototypeStructure = 0;
+    entry.offset = slot.cachedOffset();
+}
+
+void MegamorphicAccessCache::clear()
+{
+    for (unsigned i = 0; i < tableSize; ++i) {
+        m_getEntries[i] = Entry();
+        m_putEntries[i] = Entry();
+    }
+}
+
+} // namespace JSC
+
+#endif // ENABLE(JIT)
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MegamorphicAccessCache_h
+#define MegamorphicAccessCache_h
+
+#if ENABLE(JIT)
+
+#include "JSObject.h"
+#include "PropertySlot.h"
+#include "PutPropertySlot.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+
+namespace JSC {
+
+    // Remembers where recently accessed properties are stored, for get_by_id and put_by_id sites
+    // that have seen more Structures than their polymorphic caches hold. Entries are keyed by the
+    // base object's Structure and the property name, and keep both alive so that neither can be
+    // reused for something else while the entry is in the table.
+    class MegamorphicAccessCache : public Noncopyable {
+    public:
+        MegamorphicAccessCache();
+
+        bool get(JSValue base, const Identifier& propertyName, JSValue& result);
+        bool put(JSValue base, const Identifier& propertyName, JSValue value);
+
+        // Called after a full lookup or store, to remember where the property was found.
+        void addGet(JSValue base, const Identifier& propertyName, const PropertySlot&);
+        void addPut(JSValue base, const Identifier& propertyName, const PutPropertySlot&);
+
+        void clear();
+
+        unsigned hits() const { return m_hits; }
+        unsigned misses() const { return m_misses; }
+
+    private:
+        struct Entry {
+            RefPtr<Structure> structure;
+            RefPtr<UString::Rep> propertyName;
+            // Set when the property is stored in the object's prototype.
+            RefPtr<Structure> prototypeStructure;
+            size_t offset;
+        };
+
+        static const unsigned tableSize = 256;
+
+        static unsigned tableIndex(Structure* structure, UString::Rep* propertyName)
+        {
+            return ((reinterpret_cast<uintptr_t>(structure) >> 4) ^ propertyName->existingHash()) & (tableSize - 1);
+        }
+
+        Entry m_getEntries[tableSize];
+        Entry m_putEntries[tableSize];
+        unsigned m_hits;
+        unsigned m_misses;
+    };
+
+    inline bool MegamorphicAccessCache::get(JSValue base, const Identifier& propertyName, JSValue& result)
+    {
+        if (!base.isObject())
+            return false;
+
+        JSObject* object = asObject(base);
+        Structure* structure = object->structure();
+        Entry& entry = m_getEntries[tableIndex(structure, propertyName.ustring().rep())];
+        if (entry.structure != structure || entry.propertyName != propertyName.ustring().rep()) {
+            ++m_misses;
+            return false;
+        }
+
+        if (entry.prototypeStructure) {
+            JSObject* prototype = asObject(structure->storedPrototype());
+            if (prototype->structure() != entry.prototypeStructure) {
+                ++m_misses;
+                return false;
+            }
+            object = prototype;
+        }
+
+        ++m_hits;
+        result = object->getDirectOffset(entry.offset);
+        return true;
+    }
+
+    inline bool MegamorphicAccessCache::put(JSValue base, const Identifier& propertyName, JSValue value)
+    {
+        if (!base.isObject())
+            return false;
+
+        JSObject* object = asObject(base);
+        Entry& entry = m_putEntries[tableIndex(object->structure(), propertyName.ustring().rep())];
+        if (entry.structure != object->structure() || entry.propertyName != propertyName.ustring().rep()) {
+            ++m_misses;
+            return false;
+        }
+
+        ++m_hits;
+        object->putDirectOffset(entry.offset, value);
+        return true;
+    }
+
+} // namespace JSC
+
+#endif // ENABLE(JIT)
+
+#endif // MegamorphicAccessCache_h
@@ -30,6 +30,7 @@
 #include "JSFunction.h"
 #include "JSLock.h"
 #include "JSString.h"
+#include "ParseCache.h"
 #include "PrototypeFunction.h"
 #include "SamplingTool.h"
 #include <math.h>
@@ -101,11 +102,19 @@ struct Options {
     Options()
         : interactive(false)
         , dump(false)
+        , loadCount(0)
+        , profileFileName(0)
+        , sampleRate(1000)
+        , heapProfileFileName(0)
     {
     }
 
     bool interactive;
     bool dump;
+    int loadCount;
+    const char* profileFileName;
+    unsigned sampleRate;
+    const char* heapProfileFileName;
     Vector<Script> scripts;
     Vector<UString> arguments;
 };
@@ -414,6 +423,46 @@ static bool runWithScripts(GlobalObject* globalObject, const Vector<Script>& scr
     return success;
 }
 
+// Loads the scripts repeatedly, each time into a new global object, the way a page that
+// uses a large library would on every visit. The first load is cold; later ones can reuse
+// the syntax trees kept by the parse cache.
+static bool runLoadTest(JSGlobalData* globalData, const Options& options)
+{
+    Vector<UString> sources;
+    Vector<char> scriptBuffer;
+    for (size_t i = 0; i < options.scripts.size(); ++i) {
+        if (!options.scripts[i].isFile) {
+            sources.append(options.scripts[i].argument);
+            continue;
+        }
+        if (!fillBufferWithContentsOfFile(options.scripts[i].argument, scriptBuffer))
+            return false;
+        sources.append(scriptBuffer.data());
+    }
+
+    bool success = true;
+    for (int load = 0; load < options.loadCount; ++load) {
+        GlobalObject* globalObject = new (globalData) GlobalObject(options.arguments);
+
+        StopWatch stopWatch;
+        stopWatch.start();
+        for (size_t i = 0; i < sources.size(); ++i) {
+            // Every load gets its own copy of the text, as it would from the network.
+            UString source(sources[i].data(), sources[i].size());
+            Completion completion = evaluate(globalObject->globalExec(), globalObject->globalScopeChain(), makeSource(source, options.scripts[i].argument));
+            success = success && completion.complType() != Throw;
+            globalObject->globalExec()->clearException();
+        }
+        stopWatch.stop();
+
+        printf("Load %d: %ld ms\n", load + 1, stopWatch.getElapsedMS());
+    }
+
+    ParseCache* parseCache = globalData->parseCache;
+    printf("Parse cache: %u hits, %u misses, %lu characters cached\n", parseCache->hits(), parseCache->misses(), static_cast<unsigned long>(parseCache->size()));
+    return success;
+}
+
 #define RUNNING_FROM_XCODE 0
 
 static void runInteractive(GlobalObject* globalObject)
@@ -455,11 +504,21 @@ static void runInteractive(GlobalObject* globalObject)
 static NO_RETURN void printUsageStatement(JSGlobalData* globalData, bool help = false)
 {
     fprintf(stderr, "Usage: jsc [options] [files] [-- arguments]\n");
+    fprintf(stderr, "  -a         Samples allocations and writes the stacks that own sampled memory at exit to the given file\n");
     fprintf(stderr, "  -d         Dumps bytecode (debug builds only)\n");
     fprintf(stderr, "  -e         Evaluate argument as script code\n");
     fprintf(stderr, "  -f         Specifies a source file (deprecated)\n");
+#if ENABLE(GENERATIONAL_COLLECTION)
+    fprintf(stderr, "  -g         Enables generational garbage collection\n");
+#endif
     fprintf(stderr, "  -h|--help  Prints this help message\n");
     fprintf(stderr, "  -i         Enables interactive mode (default if no files are specified)\n");
+    fprintf(stderr, "  -l         Loads the scripts the given number of times, each into a new global object, and reports the time taken\n");
+#if ENABLE(PARALLEL_MARKING)
+    fprintf(stderr, "  -m         Specifies the number of garbage collector marking threads\n");
+#endif
+    fprintf(stderr, "  -p         Samples the JavaScript stack and writes the samples to the given file, as collapsed stacks for flame graph tools\n");
+    fprintf(stderr, "  -r         Specifies the number of stack samples per second taken by -p (default 1000)\n");
 #if HAVE(SIGNAL_H)
     fprintf(stderr, "  -s         Installs signal handlers that exit on a crash (Unix platforms only)\n");
 #endif
@@ -489,6 +548,44 @@ static void parseArguments(int argc, char** argv, Options& options, JSGlobalData
             options.interactive = true;
             continue;
         }
+        if (!strcmp(arg, "-l")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.loadCount = atoi(argv[i]);
+            continue;
+        }
+#if ENABLE(GENERATIONAL_COLLECTION)
+        if (!strcmp(arg, "-g")) {
+            globalData->heap.setGenerationalCollectionEnabled(true);
+            continue;
+        }
+#endif
+#if ENABLE(PARALLEL_MARKING)
+        if (!strcmp(arg, "-m")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            globalData->heap.setMarkingThreadCount(atoi(argv[i]));
+            continue;
+        }
+#endif
+        if (!strcmp(arg, "-p")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.profileFileName = argv[i];
+            continue;
+        }
+        if (!strcmp(arg, "-r")) {
+            if (++i == argc || atoi(argv[i]) <= 0)
+                printUsageStatement(globalData);
+            options.sampleRate = atoi(argv[i]);
+            continue;
+        }
+        if (!strcmp(arg, "-a")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.heapProfileFileName = argv[i];
+            continue;
+        }
         if (!strcmp(arg, "-d")) {
             options.dump = true;
             continue;
@@ -518,6 +615,15 @@ static void parseArguments(int argc, char** argv, Options& options, JSGlobalData
         options.arguments.append(argv[i]);
 }
 
+static void writeHeapProfileEntry(const FastMallocHeapProfileEntry& entry, void* context)
+{
+    FILE* file = static_cast<FILE*>(context);
+    fprintf(file, "%lu %lu", static_cast<unsigned long>(entry.estimatedSize), static_cast<unsigned long>(entry.sampleCount));
+    for (size_t i = 0; i < entry.stackDepth; ++i)
+        fprintf(file, " %p", entry.stack[i]);
+    fprintf(file, "\n");
+}
+
 int jscmain(int argc, char** argv, JSGlobalData* globalData)
 {
     JSLock lock(SilenceAssertionsOnly);
@@ -525,10 +631,42 @@ int jscmain(int argc, char** argv, JSGlobalData* globalData)
     Options options;
     parseArguments(argc, argv, options, globalData);
 
-    GlobalObject* globalObject = new (globalData) GlobalObject(options.arguments);
-    bool success = runWithScripts(globalObject, options.scripts, options.dump);
-    if (options.interactive && success)
-        runInteractive(globalObject);
+    OwnPtr<StackSampler> stackSampler;
+    if (options.profileFileName) {
+        stackSampler.set(new StackSampler(options.sampleRate));
+        globalData->stackSampler = stackSampler.get();
+    }
+    if (options.heapProfileFileName)
+        setFastMallocHeapProfilingInterval(128 * 1024);
+
+    bool success;
+    if (options.loadCount)
+        success = runLoadTest(globalData, options);
+    else {
+        GlobalObject* globalObject = new (globalData) GlobalObject(options.arguments);
+        success = runWithScripts(globalObject, options.scripts, options.dump);
+        if (options.interactive && success)
+            runInteractive(globalObject);
+    }
+
+    if (stackSampler) {
+        globalData->stackSampler = 0;
+        if (FILE* file = fopen(options.profileFileName, "w")) {
+            stackSampler->writeCollapsedStacks(file);
+            fclose(file);
+            fprintf(stderr, "Wrote %u stack samples to %s\n", stackSampler->sampleCount(), options.profileFileName);
+        } else
+            fprintf(stderr, "Could not open file: %s\n", options.profileFileName);
+    }
+
+    if (options.heapProfileFileName) {
+        setFastMallocHeapProfilingInterval(0);
+        if (FILE* file = fopen(options.heapProfileFileName, "w")) {
+            dumpFastMallocHeapProfile(writeHeapProfileEntry, file);
+            fclose(file);
+        } else
+            fprintf(stderr, "Could not open file: %s\n", options.heapProfileFileName);
+    }
 
     return success ? 0 : 3;
 }
@@ -139,6 +139,8 @@ void Lexer::setCode(const SourceCode& source, ParserArena& arena)
     m_lineNumber = source.firstLine();
     m_delimited = false;
     m_lastToken = -1;
+    m_functionHeaderState = NotInFunctionHeader;
+    m_functionBodyDepth = 0;
 
     const UChar* data = source.provider()->data();
 
@@ -202,6 +204,57 @@ ALWAYS_INLINE const Identifier* Lexer::makeIdentifier(const UChar* characters, s
     return &m_arena->makeIdentifier(m_globalData, characters, length);
 }
 
+// The grammar for a nested function body only looks at a name to check the "get" or "set"
+// of an accessor property, so no other name needs to become an Identifier.
+inline const Identifier* Lexer::makeIdentifierInFunctionBody(const UChar* characters, size_t length)
+{
+    const CommonIdentifiers& propertyNames = *m_globalData->propertyNames;
+    if (length == 3 && characters[1] == 'e' && characters[2] == 't') {
+        if (characters[0] == 'g')
+            return &propertyNames.get;
+        if (characters[0] == 's')
+            return &propertyNames.set;
+    }
+    return &propertyNames.emptyIdentifier;
+}
+
+// Follows "function name(a, b) {" so that the lexer knows when it is inside a nested function
+// body. Braces in regular expressions are skipped by the parser, so only brace tokens count.
+ALWAYS_INLINE void Lexer::recordFunctionBodyToken(int token)
+{
+    if (m_functionBodyDepth) {
+        if (token == OPENBRACE)
+            ++m_functionBodyDepth;
+        else if (token == CLOSEBRACE)
+            --m_functionBodyDepth;
+        return;
+    }
+
+    switch (m_functionHeaderState) {
+    case NotInFunctionHeader:
+        if (token == FUNCTION)
+            m_functionHeaderState = SawFunctionKeyword;
+        return;
+    case SawFunctionKeyword:
+        if (token == '(')
+            m_functionHeaderState = InFunctionParameters;
+        else if (token != IDENT)
+            m_functionHeaderState = NotInFunctionHeader;
+        return;
+    case InFunctionParameters:
+        if (token == ')')
+            m_functionHeaderState = SawFunctionParameters;
+        else if (token != IDENT && token != ',')
+            m_functionHeaderState = NotInFunctionHeader;
+        return;
+    case SawFunctionParameters:
+        if (token == OPENBRACE)
+            m_functionBodyDepth = 1;
+        m_functionHeaderState = NotInFunctionHeader;
+        return;
+    }
+}
+
 inline bool Lexer::lastTokenWasRestrKeyword() const
 {
     return m_lastToken == CONTINUE || m_lastToken == BREAK || m_lastToken == RETURN || m_lastToken == THROW;
@@ -573,7 +626,10 @@ startString: {
         }
         shift1();
     }
-    lvalp->ident = makeIdentifier(stringStart, currentCharacter() - stringStart);
+    if (UNLIKELY(m_functionBodyDepth))
+        lvalp->ident = &m_globalData->propertyNames->emptyIdentifier;
+    else
+        lvalp->ident = makeIdentifier(stringStart, currentCharacter() - stringStart);
     shift1();
     m_atLineStart = false;
     m_delimited = false;
@@ -664,7 +720,16 @@ startIdentifierOrKeyword: {
     while (isIdentPart(m_current))
         shift1();
     if (LIKELY(m_current != '\\')) {
-        lvalp->ident = makeIdentifier(identifierStart, currentCharacter() - identifierStart);
+        size_t length = currentCharacter() - identifierStart;
+        if (UNLIKELY(m_functionBodyDepth)) {
+            const HashEntry* entry = m_keywordTable.entry(m_globalData, identifierStart, length);
+            lvalp->ident = makeIdentifierInFunctionBody(identifierStart, length);
+            m_atLineStart = false;
+            m_delimited = false;
+            token = entry ? entry->lexerValue() : IDENT;
+            goto returnToken;
+        }
+        lvalp->ident = makeIdentifier(identifierStart, length);
         goto doneIdentifierOrKeyword;
     }
     m_buffer16.append(identifierStart, currentCharacter() - identifierStart);
@@ -838,7 +903,7 @@ startNumber:
 doneNumber:
     // Null-terminate string for strtod.
     m_buffer8.append('\0');
-    lvalp->doubleValue = WTF::strtod(m_buffer8.data(), 0);
+    lvalp->doubleValue = UNLIKELY(m_functionBodyDepth) ? 0 : WTF::strtod(m_buffer8.data(), 0);
     m_buffer8.resize(0);
 
     // Fall through into doneNumeric.
@@ -861,7 +926,10 @@ doneSemicolon:
 doneIdentifier:
     m_atLineStart = false;
     m_delimited = false;
-    lvalp->ident = makeIdentifier(m_buffer16.data(), m_buffer16.size());
+    if (UNLIKELY(m_functionBodyDepth))
+        lvalp->ident = makeIdentifierInFunctionBody(m_buffer16.data(), m_buffer16.size());
+    else
+        lvalp->ident = makeIdentifier(m_buffer16.data(), m_buffer16.size());
     m_buffer16.resize(0);
     token = IDENT;
     goto returnToken;
@@ -880,7 +948,10 @@ doneString:
     shift1();
     m_atLineStart = false;
     m_delimited = false;
-    lvalp->ident = makeIdentifier(m_buffer16.data(), m_buffer16.size());
+    if (UNLIKELY(m_functionBodyDepth))
+        lvalp->ident = &m_globalData->propertyNames->emptyIdentifier;
+    else
+        lvalp->ident = makeIdentifier(m_buffer16.data(), m_buffer16.size());
     m_buffer16.resize(0);
     token = STRING;
 
@@ -893,6 +964,7 @@ returnToken: {
     llocp->first_column = startOffset;
     llocp->last_column = currentOffset();
 
+    recordFunctionBodyToken(token);
     m_lastToken = token;
     return token;
 }
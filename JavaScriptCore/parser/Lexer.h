@@ -80,8 +80,10 @@ namespace JSC {
         const UChar* currentCharacter() const;
 
         const Identifier* makeIdentifier(const UChar* characters, size_t length);
+        const Identifier* makeIdentifierInFunctionBody(const UChar* characters, size_t length);
 
         bool lastTokenWasRestrKeyword() const;
+        void recordFunctionBodyToken(int token);
 
         static const size_t initialReadBufferCapacity = 32;
 
@@ -93,6 +95,12 @@ namespace JSC {
         bool m_delimited; // encountered delimiter like "'" and "}" on last run
         int m_lastToken;
 
+        // Nested function bodies are only checked for syntax, and parsed again when the
+        // function is compiled, so identifiers and literal values in them are not needed.
+        enum FunctionHeaderState { NotInFunctionHeader, SawFunctionKeyword, InFunctionParameters, SawFunctionParameters };
+        FunctionHeaderState m_functionHeaderState;
+        int m_functionBodyDepth;
+
         const SourceCode* m_source;
         const UChar* m_code;
         const UChar* m_codeStart;
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "ParseCache.h"
+
+namespace JSC {
+
+// Trees take several times the memory of their source, so this is kept to
+// roughly one large library.
+static const size_t defaultParseCacheCapacity = 256 * 1024;
+
+ParseCache::ParseCache()
+    : m_capacity(defaultParseCacheCapacity)
+    , m_size(0)
+    , m_useCount(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+ParseCache::~ParseCache()
+{
+}
+
+// A tree depends on the text it was parsed from, and on where that text sits in its
+// provider, since nodes record absolute offsets and line numbers.
+static bool matches(const SourceCode& cachedSource, const SourceCode& source)
+{
+    if (cachedSource.startOffset() != source.startOffset()
+        || cachedSource.endOffset() != source.endOffset()
+        || cachedSource.firstLine() != source.firstLine()
+        || cachedSource.provider()->hasBOMs() != source.provider()->hasBOMs())
+        return false;
+
+    const UChar* cachedCharacters = cachedSource.data();
+    const UChar* characters = source.data();
+    return cachedCharacters == characters || !memcmp(cachedCharacters, characters, source.length() * sizeof(UChar));
+}
+
+ScopeNode* ParseCache::get(const SourceCode& source, unsigned hash, bool isFunction)
+{
+    EntryMap::iterator it = m_entries.find(hash);
+    if (it == m_entries.end())
+        return 0;
+
+    Entry& entry = it->second;
+    if (entry.isFunction != isFunction || !matches(entry.node->source(), source))
+        return 0;
+
+    entry.lastUse = ++m_useCount;
+    return entry.node.get();
+}
+
+void ParseCache::add(const SourceCode& source, unsigned hash, PassRefPtr<ScopeNode> node, bool isFunction)
+{
+    // A hash collision replaces the older tree.
+    pair<EntryMap::iterator, bool> result = m_entries.add(hash, Entry());
+    Entry& entry = result.first->second;
+    if (!result.second)
+        m_size -= entry.node->source().length();
+
+    entry.node = node;
+    entry.isFunction = isFunction;
+    entry.lastUse = ++m_useCount;
+    m_size += source.length();
+
+    prune();
+}
+
+void ParseCache::prune()
+{
+    while (m_size > m_capacity) {
+        EntryMap::iterator leastRecentlyUsed = m_entries.begin();
+        EntryMap::iterator end = m_entries.end();
+        for (EntryMap::iterator it = leastRecentlyUsed; it != end; ++it) {
+            if (it->second.lastUse < leastRecentlyUsed->second.lastUse)
+                leastRecentlyUsed = it;
+        }
+
+        m_size -= leastRecentlyUsed->second.node->source().length();
+        m_entries.remove(leastRecentlyUsed);
+    }
+}
+
+static bool canFinishInPlace(FunctionBodyNode* body, FunctionParameters* parameters, const Identifier& name, bool forceUsesArguments)
+{
+    // Forcing 'arguments' on would change the features of every later compile of the tree.
+    if (forceUsesArguments && !body->usesArguments())
+        return false;
+    // A tree that has not been finished yet takes the parameters of its first compile.
+    if (!body->parameters())
+        return true;
+    return body->ident() == name && *body->parameters() == *parameters;
+}
+
+PassRefPtr<FunctionBodyNode> ParseCache::parseFunctionBody(JSGlobalData* globalData, const SourceCode& source, PassRefPtr<FunctionParameters> parameters, const Identifier& name, bool forceUsesArguments)
+{
+    RefPtr<FunctionBodyNode> body = parse<FunctionBodyNode>(globalData, 0, 0, source);
+    if (!body->hasOneRef() && !canFinishInPlace(body.get(), parameters.get(), name, forceUsesArguments))
+        body = globalData->parser->parse<FunctionBodyNode>(globalData, 0, 0, source);
+
+    if (forceUsesArguments)
+        body->setUsesArguments();
+    body->finishParsing(parameters, name);
+    return body.release();
+}
+
+void ParseCache::clear()
+{
+    m_entries.clear();
+    m_size = 0;
+}
+
+void ParseCache::setCapacity(size_t capacity)
+{
+    m_capacity = capacity;
+    prune();
+}
+
+} // namespace JSC
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ParseCache_h
+#define ParseCache_h
+
+#include "Parser.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/StringHashFunctions.h>
+
+namespace JSC {
+
+    // Keeps the syntax trees of recently compiled programs and function bodies, so that
+    // compiling the same source text again - a library shared by several pages, or a page
+    // that is reloaded - skips lexing and parsing. Trees are looked up by a hash of the
+    // text and are not tied to a global object; bytecode is still generated per compile.
+    class ParseCache : public Noncopyable {
+    public:
+        ParseCache();
+        ~ParseCache();
+
+        template <class ParsedNode>
+        PassRefPtr<ParsedNode> parse(JSGlobalData*, Debugger*, ExecState*, const SourceCode&, int* errLine = 0, UString* errMsg = 0);
+
+        // Parses a function body and finishes it with the parameters and name of the function
+        // being compiled. A cached tree is only finished in place when that leaves it as the
+        // previous compile left it; otherwise the caller gets a tree of its own, so no compile
+        // sees parameters or features set by another.
+        PassRefPtr<FunctionBodyNode> parseFunctionBody(JSGlobalData*, const SourceCode&, PassRefPtr<FunctionParameters>, const Identifier& name, bool forceUsesArguments);
+
+        // Called once bytecode has been generated from a tree returned by parse(). Frees
+        // the tree's statements unless the cache is holding on to it.
+        static void didGenerateCode(ScopeNode* node)
+        {
+            if (node->hasOneRef())
+                node->destroyData();
+        }
+
+        void clear();
+
+        // Limit on the number of source characters whose trees are kept.
+        void setCapacity(size_t);
+        size_t capacity() const { return m_capacity; }
+        size_t size() const { return m_size; }
+
+        unsigned hits() const { return m_hits; }
+        unsigned misses() const { return m_misses; }
+
+    private:
+        struct Entry {
+            Entry()
+                : isFunction(false)
+                , lastUse(0)
+            {
+            }
+
+            RefPtr<ScopeNode> node;
+            bool isFunction;
+            unsigned lastUse;
+        };
+
+        ScopeNode* get(const SourceCode&, unsigned hash, bool isFunction);
+        void add(const SourceCode&, unsigned hash, PassRefPtr<ScopeNode>, bool isFunction);
+        void prune();
+
+        typedef HashMap<unsigned, Entry> EntryMap;
+        EntryMap m_entries;
+
+        size_t m_capacity;
+        size_t m_size;
+        unsigned m_useCount;
+        unsigned m_hits;
+        unsigned m_misses;
+    };
+
+    template <class ParsedNode>
+    PassRefPtr<ParsedNode> ParseCache::parse(JSGlobalData* globalData, Debugger* debugger, ExecState* debuggerExecState, const SourceCode& source, int* errLine, UString* errMsg)
+    {
+        // A debugger is told about each script as it is parsed, so it always gets a fresh parse.
+        if (debugger || static_cast<size_t>(source.length()) > m_capacity)
+            return globalData->parser->parse<ParsedNode>(globalData, debugger, debuggerExecState, source, errLine, errMsg);
+
+        unsigned hash = WTF::stringHash(source.data(), source.length());
+        if (ScopeNode* node = get(source, hash, ParsedNode::scopeIsFunction)) {
+            ++m_hits;
+            return static_cast<ParsedNode*>(node);
+        }
+
+        ++m_misses;
+        RefPtr<ParsedNode> node = globalData->parser->parse<ParsedNode>(globalData, 0, 0, source, errLine, errMsg);
+        if (node)
+            add(source, hash, node, ParsedNode::scopeIsFunction);
+        return node.release();
+    }
+
+} // namespace JSC
+
+#endif // ParseCache_h
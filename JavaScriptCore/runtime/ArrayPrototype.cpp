@@ -277,7 +277,9 @@ JSValue JSC_HOST_CALL arrayProtoFuncJoin(ExecState* exec, JSObject*, JSValue thi
         }
 
         JSValue element = thisObj->get(exec, k);
-        if (!element.isUndefinedOrNull())
+        if (element.isString())
+            strBuffer.append(asString(element));
+        else if (!element.isUndefinedOrNull())
             strBuffer.append(element.toString(exec));
     }
     arrayVisitedElements.remove(thisObj);
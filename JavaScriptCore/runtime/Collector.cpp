@@ -39,7 +39,9 @@
 #include <algorithm>
 #include <limits.h>
 #include <setjmp.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/HashCountedSet.h>
 #include <wtf/UnusedParam.h>
@@ -95,20 +97,37 @@
 #endif
 
 #define COLLECT_ON_EVERY_ALLOCATION 0
+// Traces the roots of every full collection serially and then in parallel, and crashes if the
+// results differ.
+#define VERIFY_PARALLEL_MARKING 0
+
+#if ENABLE(GENERATIONAL_COLLECTION) && ENABLE(JSC_ZOMBIES)
+#error "JSC_ZOMBIES marks dead cells, which would promote them into the old generation"
+#endif
 
 using std::max;
+using std::min;
 
 namespace JSC {
 
 // tunable parameters
 
+// Capacity policy for the array of block pointers.
 const size_t GROWTH_FACTOR = 2;
 const size_t LOW_WATER_FACTOR = 4;
 const size_t ALLOCATIONS_PER_COLLECTION = 3600;
+// After a collection, the heap is sized to leave HEAP_GROWTH_RATIO free bytes per live byte,
+// but never less than MIN_FREE_BYTES. It is only shrunk once it exceeds that size by
+// HEAP_SHRINK_SLACK, so a heap with a steady live size is not resized on every collection.
+const size_t MIN_FREE_BYTES = ALLOCATIONS_PER_COLLECTION * CELL_SIZE;
+const float HEAP_GROWTH_RATIO = 1.0f;
+const float HEAP_SHRINK_SLACK = 1.25f;
 // This value has to be a macro to be used in max() without introducing
 // a PIC branch in Mach-O binaries, see <rdar://problem/5971391>.
 #define MIN_ARRAY_SIZE (static_cast<size_t>(14))
 
+COMPILE_ASSERT(sizeof(CollectorBlock) <= BLOCK_SIZE, CollectorBlock_fits_in_block);
+
 #if OS(SYMBIAN)
 const size_t MAX_NUM_BLOCKS = 256; // Max size of collector heap set to 16 MB
 static RHeap* userChunk = 0;
@@ -170,6 +189,9 @@ Heap::Heap(JSGlobalData* globalData)
 #endif // OS(SYMBIAN)
     
     memset(&m_heap, 0, sizeof(CollectorHeap));
+#if OS(SYMBIAN)
+    m_heap.maxBlocks = MAX_NUM_BLOCKS;
+#endif
     allocateBlock();
 }
 
@@ -196,6 +218,10 @@ void Heap::destroy()
     delete m_markListSet;
     m_markListSet = 0;
 
+#if ENABLE(PARALLEL_MARKING)
+    m_parallelMarker.clear();
+#endif
+
     freeBlocks();
 
 #if ENABLE(JSC_MULTIPLE_THREADS)
@@ -416,7 +442,12 @@ allocate:
 
                 m_heap.operationInProgress = Allocation;
                 JSCell* imp = reinterpret_cast<JSCell*>(cell);
-                imp->~JSCell();
+                if (imp->structure()->typeInfo().hasTrivialDestructor())
+                    ++m_heap.skippedDestructors;
+                else {
+                    imp->~JSCell();
+                    ++m_heap.cellsSweptByAllocation;
+                }
                 m_heap.operationInProgress = NoOperation;
 
                 ++m_heap.nextCell;
@@ -436,17 +467,90 @@ void Heap::resizeBlocks()
 {
     m_heap.didShrink = false;
 
-    size_t usedCellCount = markedCells();
-    size_t minCellCount = usedCellCount + max(ALLOCATIONS_PER_COLLECTION, usedCellCount);
-    size_t minBlockCount = (minCellCount + HeapConstants::cellsPerBlock - 1) / HeapConstants::cellsPerBlock;
+    static const size_t blockBytes = HeapConstants::cellsPerBlock * HeapConstants::cellSize;
+    size_t liveBytes = markedCells() * HeapConstants::cellSize;
+    size_t freeBytes = max(MIN_FREE_BYTES, static_cast<size_t>(HEAP_GROWTH_RATIO * liveBytes));
 
-    size_t maxCellCount = 1.25f * minCellCount;
-    size_t maxBlockCount = (maxCellCount + HeapConstants::cellsPerBlock - 1) / HeapConstants::cellsPerBlock;
+    size_t minBlockCount = (liveBytes + freeBytes + blockBytes - 1) / blockBytes;
+    size_t maxBlockCount = (static_cast<size_t>(HEAP_SHRINK_SLACK * (liveBytes + freeBytes)) + blockBytes - 1) / blockBytes;
 
+    bool reachedLimit = false;
+    if (m_heap.maxBlocks && minBlockCount > m_heap.maxBlocks) {
+        // Collect more often instead of growing past the limit, but keep MIN_FREE_BYTES
+        // free so the heap does not collect on nearly every allocation.
+        reachedLimit = true;
+        size_t liveBlockCount = (liveBytes + MIN_FREE_BYTES + blockBytes - 1) / blockBytes;
+        minBlockCount = max(m_heap.maxBlocks, liveBlockCount);
+        maxBlockCount = minBlockCount;
+    } else if (m_heap.maxBlocks)
+        maxBlockCount = min(maxBlockCount, m_heap.maxBlocks);
+
+#if OS(SYMBIAN)
+    // Blocks come from a chunk reserved up front, which cannot grow, so unlike the soft limit
+    // MAX_NUM_BLOCKS is never exceeded. Once every cell in it is live, the heap is out of memory.
+    if (minBlockCount > MAX_NUM_BLOCKS) {
+        reachedLimit = true;
+        if (liveBytes >= MAX_NUM_BLOCKS * blockBytes)
+            CRASH();
+        minBlockCount = MAX_NUM_BLOCKS;
+        maxBlockCount = MAX_NUM_BLOCKS;
+    }
+#endif
+
+    size_t oldBlockCount = m_heap.usedBlocks;
     if (m_heap.usedBlocks < minBlockCount)
         growBlocks(minBlockCount);
     else if (m_heap.usedBlocks > maxBlockCount)
         shrinkBlocks(maxBlockCount);
+
+    if (m_heap.usedBlocks != oldBlockCount || reachedLimit)
+        recordGrowthEvent(liveBytes, oldBlockCount, reachedLimit);
+}
+
+void Heap::recordGrowthEvent(size_t liveBytes, size_t oldBlockCount, bool reachedLimit)
+{
+    HeapGrowthEvent& event = m_heap.growthTrace[m_heap.growthEventCount++ % HEAP_GROWTH_TRACE_LENGTH];
+    event.time = currentTime();
+    event.liveBytes = liveBytes;
+    event.sizeBeforeResize = oldBlockCount * BLOCK_SIZE;
+    event.sizeAfterResize = m_heap.usedBlocks * BLOCK_SIZE;
+    event.reachedLimit = reachedLimit;
+}
+
+void Heap::setMaxHeapSize(size_t size)
+{
+    m_heap.maxBlocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+#if OS(SYMBIAN)
+    // The soft limit cannot usefully exceed the hard cap enforced by resizeBlocks().
+    if (!m_heap.maxBlocks || m_heap.maxBlocks > MAX_NUM_BLOCKS)
+        m_heap.maxBlocks = MAX_NUM_BLOCKS;
+#endif
+}
+
+size_t Heap::maxHeapSize() const
+{
+    return m_heap.maxBlocks * BLOCK_SIZE;
+}
+
+Vector<HeapGrowthEvent> Heap::growthTrace() const
+{
+    size_t count = min(m_heap.growthEventCount, HEAP_GROWTH_TRACE_LENGTH);
+    Vector<HeapGrowthEvent> trace(count);
+    for (size_t i = 0; i < count; ++i)
+        trace[i] = m_heap.growthTrace[(m_heap.growthEventCount - count + i) % HEAP_GROWTH_TRACE_LENGTH];
+    return trace;
+}
+
+void Heap::dumpGrowthTrace() const
+{
+    Vector<HeapGrowthEvent> trace = growthTrace();
+    printf("JavaScript heap growth (%d events, limit %d KB):\n", static_cast<int>(m_heap.growthEventCount), static_cast<int>(maxHeapSize() / 1024));
+    for (size_t i = 0; i < trace.size(); ++i) {
+        const HeapGrowthEvent& event = trace[i];
+        printf("  %.3fs: %d KB live, %d KB -> %d KB%s\n", event.time - trace[0].time,
+            static_cast<int>(event.liveBytes / 1024), static_cast<int>(event.sizeBeforeResize / 1024),
+            static_cast<int>(event.sizeAfterResize / 1024), event.reachedLimit ? " (limited)" : "");
+    }
 }
 
 void Heap::growBlocks(size_t neededBlocks)
@@ -1040,6 +1144,10 @@ void Heap::clearMarkBits(CollectorBlock* block)
     // allocate assumes that the last cell in every block is marked.
     block->marked.clearAll();
     block->marked.set(HeapConstants::cellsPerBlock - 1);
+#if ENABLE(GENERATIONAL_COLLECTION)
+    // Without mark bits there are no old cells, so there is nothing to remember.
+    block->cards.clearAll();
+#endif
 }
 
 size_t Heap::markedCells(size_t startBlock, size_t startCell) const
@@ -1065,32 +1173,119 @@ void Heap::sweep()
         CRASH();
     m_heap.operationInProgress = Collection;
     
-#if !ENABLE(JSC_ZOMBIES)
-    Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
-#endif
-
+#if ENABLE(JSC_ZOMBIES)
     DeadObjectIterator it(m_heap, m_heap.nextBlock, m_heap.nextCell);
     DeadObjectIterator end(m_heap, m_heap.usedBlocks);
     for ( ; it != end; ++it) {
         JSCell* cell = *it;
-#if ENABLE(JSC_ZOMBIES)
         if (!cell->isZombie()) {
             const ClassInfo* info = cell->classInfo();
             cell->~JSCell();
             new (cell) JSZombie(info, JSZombie::leakedZombieStructure());
             Heap::markCell(cell);
         }
+    }
 #else
+    for (size_t block = max(m_heap.nextBlock, m_heap.nextSweepBlock); block < m_heap.usedBlocks; ++block)
+        m_heap.cellsSweptDuringCollection += sweepBlock(block, block == m_heap.nextBlock ? m_heap.nextCell : 0);
+    m_heap.nextSweepBlock = m_heap.usedBlocks;
+#endif
+
+    m_heap.operationInProgress = NoOperation;
+}
+
+size_t Heap::sweepBlock(size_t block, size_t startCell)
+{
+    Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
+    CollectorBlock* curBlock = m_heap.blocks[block];
+    size_t sweptCells = 0;
+
+    // The last cell in every block is a dummy sentinel.
+    for (size_t i = startCell; i < HeapConstants::cellsPerBlock - 1; ++i) {
+        if (curBlock->marked.get(i))
+            continue;
+        JSCell* cell = reinterpret_cast<JSCell*>(curBlock->cells + i);
+        if (cell->structure()->typeInfo().hasTrivialDestructor())
+            continue;
         cell->~JSCell();
         // Callers of sweep assume it's safe to mark any cell in the heap.
         new (cell) JSCell(dummyMarkableCellStructure);
-#endif
+        ++sweptCells;
     }
+    return sweptCells;
+}
+
+bool Heap::sweepIncrementally(double timeLimit)
+{
+    ASSERT(m_heap.operationInProgress == NoOperation);
+    if (m_heap.operationInProgress != NoOperation)
+        CRASH();
+    m_heap.operationInProgress = Collection;
+
+    double deadline = currentTime() + timeLimit;
+    size_t block = max(m_heap.nextBlock, m_heap.nextSweepBlock);
+    while (block < m_heap.usedBlocks) {
+        m_heap.cellsSweptIncrementally += sweepBlock(block, block == m_heap.nextBlock ? m_heap.nextCell : 0);
+        ++block;
+        if (currentTime() >= deadline)
+            break;
+    }
+    m_heap.nextSweepBlock = block;
 
     m_heap.operationInProgress = NoOperation;
+    return block < m_heap.usedBlocks;
 }
 
-void Heap::markRoots()
+#if ENABLE(GENERATIONAL_COLLECTION)
+void Heap::markRememberedCells(MarkStack& markStack)
+{
+    for (size_t block = 0; block < m_heap.usedBlocks; ++block) {
+        CollectorBlock* curBlock = m_heap.blocks[block];
+        for (size_t card = 0; card < CARDS_PER_BLOCK; ++card) {
+            if (curBlock->cards.get(card) == CardClean)
+                continue;
+            curBlock->cards.clean(card);
+
+            // The last cell in every block is a dummy sentinel.
+            size_t end = min((card + 1) * CELLS_PER_CARD, HeapConstants::cellsPerBlock - 1);
+            for (size_t i = card * CELLS_PER_CARD; i < end; ++i) {
+                if (curBlock->marked.get(i))
+                    markStack.appendOldCell(reinterpret_cast<JSCell*>(curBlock->cells + i));
+            }
+        }
+    }
+    markStack.drain();
+}
+#endif
+
+#if ENABLE(PARALLEL_MARKING) && VERIFY_PARALLEL_MARKING
+void Heap::verifyParallelMarking(MarkStack& markStack)
+{
+    // Gathering the roots marked them and left them on the stack. Trace from that same root
+    // set twice, rather than gathering the conservative roots again, which could find more.
+    MarkStack::Roots roots;
+    markStack.saveRoots(roots);
+    Vector<CollectorBitmap> rootMarks(m_heap.usedBlocks);
+    for (size_t block = 0; block < m_heap.usedBlocks; ++block)
+        rootMarks[block] = m_heap.blocks[block]->marked;
+
+    markStack.drain();
+    Vector<CollectorBitmap> serialMarks(m_heap.usedBlocks);
+    for (size_t block = 0; block < m_heap.usedBlocks; ++block) {
+        serialMarks[block] = m_heap.blocks[block]->marked;
+        m_heap.blocks[block]->marked = rootMarks[block];
+    }
+
+    markStack.restoreRoots(roots);
+    markStack.drainInParallel(*m_parallelMarker);
+    for (size_t block = 0; block < m_heap.usedBlocks; ++block) {
+        if (memcmp(&serialMarks[block], &m_heap.blocks[block]->marked, sizeof(CollectorBitmap)))
+            CRASH();
+    }
+}
+#endif
+
+void Heap::markRoots(CollectionType collectionType)
 {
 #ifndef NDEBUG
     if (m_globalData->isSharedInstance) {
@@ -1107,8 +1302,26 @@ void Heap::markRoots()
 
     MarkStack& markStack = m_globalData->markStack;
 
+#if ENABLE(PARALLEL_MARKING)
+    // Gather all roots on the collecting thread's stack first; tracing from them is
+    // shared with the helper threads below.
+    bool markInParallel = m_parallelMarker;
+    markStack.setDrainDeferred(markInParallel);
+#endif
+
+#if ENABLE(GENERATIONAL_COLLECTION)
+    // A nursery collection keeps the mark bits of old cells, so tracing stops at them. Old
+    // cells that may point into the nursery are revisited through the card table instead.
+    if (collectionType == NurseryCollection)
+        markRememberedCells(markStack);
+    else
+        clearMarkBits();
+#else
+    ASSERT_UNUSED(collectionType, collectionType == FullCollection);
+
     // Reset mark bits.
     clearMarkBits();
+#endif
 
     // Mark stack roots.
     markStackObjectsConservatively(markStack);
@@ -1127,6 +1340,18 @@ void Heap::markRoots()
     if (m_globalData->firstStringifierToMark)
         JSONObject::markStringifiers(markStack, m_globalData->firstStringifierToMark);
 
+#if ENABLE(PARALLEL_MARKING)
+    if (markInParallel) {
+        markStack.setDrainDeferred(false);
+#if VERIFY_PARALLEL_MARKING
+        if (collectionType == FullCollection)
+            verifyParallelMarking(markStack);
+        else
+#endif
+            markStack.drainInParallel(*m_parallelMarker);
+    }
+#endif
+
     // Mark the small strings cache last, since it will clear itself if nothing
     // else has marked it.
     m_globalData->smallStrings.markChildren(markStack);
@@ -1134,6 +1359,9 @@ void Heap::markRoots()
     markStack.drain();
     markStack.compact();
 
+    // New mark bits mean every block needs to be swept again.
+    m_heap.nextSweepBlock = 0;
+
     m_heap.operationInProgress = NoOperation;
 }
 
@@ -1147,8 +1375,29 @@ size_t Heap::objectCount() const
 
 void Heap::addToStatistics(Heap::Statistics& statistics) const
 {
+    size_t objects = objectCount();
     statistics.size += m_heap.usedBlocks * BLOCK_SIZE;
-    statistics.free += m_heap.usedBlocks * BLOCK_SIZE - (objectCount() * HeapConstants::cellSize);
+    statistics.free += m_heap.usedBlocks * BLOCK_SIZE - (objects * HeapConstants::cellSize);
+    statistics.cellsSweptByAllocation += m_heap.cellsSweptByAllocation;
+    statistics.cellsSweptIncrementally += m_heap.cellsSweptIncrementally;
+    statistics.cellsSweptDuringCollection += m_heap.cellsSweptDuringCollection;
+    statistics.skippedDestructors += m_heap.skippedDestructors;
+
+#if ENABLE(GENERATIONAL_COLLECTION)
+    if (!m_heap.generationalCollectionEnabled)
+        return;
+
+    // Allocation never sets mark bits, so between collections the marked cells are exactly
+    // the old generation (minus the sentinel cell in each block).
+    size_t oldCells = markedCells() - m_heap.usedBlocks;
+    statistics.nurseryCollections += m_heap.nurseryCollections;
+    statistics.fullCollections += m_heap.fullCollections;
+    statistics.oldCells += oldCells;
+    statistics.nurseryCells += objects - oldCells;
+    statistics.promotedCells += m_heap.promotedCells;
+#else
+    UNUSED_PARAM(objects);
+#endif
 }
 
 Heap::Statistics Heap::statistics() const
@@ -1239,11 +1488,77 @@ bool Heap::isBusy()
     return m_heap.operationInProgress != NoOperation;
 }
 
+#if ENABLE(PARALLEL_MARKING)
+void Heap::setMarkingThreadCount(unsigned count)
+{
+    ASSERT(m_heap.operationInProgress == NoOperation);
+    if (count <= 1) {
+        m_parallelMarker.clear();
+        return;
+    }
+
+    if (!m_parallelMarker)
+        m_parallelMarker.set(new ParallelMarker(m_globalData->jsArrayVPtr));
+    m_parallelMarker->setHelperThreadCount(count - 1);
+}
+
+unsigned Heap::markingThreadCount() const
+{
+    return m_parallelMarker ? m_parallelMarker->helperThreadCount() + 1 : 1;
+}
+#endif
+
+#if ENABLE(GENERATIONAL_COLLECTION)
+void Heap::setGenerationalCollectionEnabled(bool enabled)
+{
+    if (m_heap.generationalCollectionEnabled == enabled)
+        return;
+    m_heap.generationalCollectionEnabled = enabled;
+
+    // Start from an exact old generation, so the growth policy in didCollect has a baseline.
+    m_heap.fullCollectionNeeded = true;
+}
+
+CollectionType Heap::nextCollectionType() const
+{
+    if (!m_heap.generationalCollectionEnabled || m_heap.fullCollectionNeeded)
+        return FullCollection;
+    return NurseryCollection;
+}
+
+void Heap::didCollect(CollectionType collectionType, size_t oldCellsBeforeCollection)
+{
+    size_t oldCells = markedCells() - m_heap.usedBlocks;
+
+    if (collectionType == FullCollection) {
+        ++m_heap.fullCollections;
+        m_heap.fullCollectionNeeded = false;
+        m_heap.oldCellsAfterFullCollection = oldCells;
+        return;
+    }
+
+    ++m_heap.nurseryCollections;
+    m_heap.promotedCells += oldCells - oldCellsBeforeCollection;
+
+    // Dead old cells are only reclaimed by a full collection. Schedule one once the old
+    // generation has doubled since the last time we knew exactly what was live.
+    if (oldCells > 2 * m_heap.oldCellsAfterFullCollection + ALLOCATIONS_PER_COLLECTION)
+        m_heap.fullCollectionNeeded = true;
+}
+#endif
+
 void Heap::reset()
 {
     JAVASCRIPTCORE_GC_BEGIN();
 
+#if ENABLE(GENERATIONAL_COLLECTION)
+    CollectionType collectionType = nextCollectionType();
+    size_t oldCellsBeforeCollection = collectionType == NurseryCollection ? markedCells() - m_heap.usedBlocks : 0;
+    markRoots(collectionType);
+    didCollect(collectionType, oldCellsBeforeCollection);
+#else
     markRoots();
+#endif
 
     JAVASCRIPTCORE_GC_MARKED();
 
@@ -1259,7 +1574,7 @@ void Heap::reset()
     JAVASCRIPTCORE_GC_END();
 }
 
-void Heap::collectAllGarbage()
+void Heap::collectAllGarbage(SweepMode sweepMode)
 {
     JAVASCRIPTCORE_GC_BEGIN();
 
@@ -1270,6 +1585,9 @@ void Heap::collectAllGarbage()
         sweep();
 
     markRoots();
+#if ENABLE(GENERATIONAL_COLLECTION)
+    didCollect(FullCollection, 0);
+#endif
 
     JAVASCRIPTCORE_GC_MARKED();
 
@@ -1277,7 +1595,14 @@ void Heap::collectAllGarbage()
     m_heap.nextBlock = 0;
     m_heap.nextNumber = 0;
     m_heap.extraCost = 0;
+#if ENABLE(JSC_ZOMBIES)
+    // Zombies are created by the sweep, so it can't be deferred.
+    UNUSED_PARAM(sweepMode);
     sweep();
+#else
+    if (sweepMode == EagerSweep)
+        sweep();
+#endif
     resizeBlocks();
 
     JAVASCRIPTCORE_GC_END();
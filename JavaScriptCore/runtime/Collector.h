@@ -30,6 +30,7 @@
 #include <wtf/OwnPtr.h>
 #include <wtf/StdLibExtras.h>
 #include <wtf/Threading.h>
+#include <wtf/Vector.h>
 
 #if ENABLE(JSC_MULTIPLE_THREADS)
 #include <pthread.h>
@@ -45,11 +46,28 @@ namespace JSC {
     class JSValue;
     class MarkedArgumentBuffer;
     class MarkStack;
+#if ENABLE(PARALLEL_MARKING)
+    class ParallelMarker;
+#endif
 
     enum OperationInProgress { NoOperation, Allocation, Collection };
+    enum CollectionType { FullCollection, NurseryCollection };
+    enum SweepMode { EagerSweep, IncrementalSweep };
 
     class LiveObjectIterator;
 
+    // One entry is recorded each time a collection resizes the heap, or is held back by the
+    // heap size limit.
+    struct HeapGrowthEvent {
+        double time;
+        size_t liveBytes; // Bytes in marked cells after the collection.
+        size_t sizeBeforeResize;
+        size_t sizeAfterResize;
+        bool reachedLimit;
+    };
+
+    const size_t HEAP_GROWTH_TRACE_LENGTH = 64;
+
     struct CollectorHeap {
         size_t nextBlock;
         size_t nextCell;
@@ -59,11 +77,32 @@ namespace JSC {
 
         size_t numBlocks;
         size_t usedBlocks;
+        size_t maxBlocks; // 0 if the heap size is not limited.
 
         size_t extraCost;
         bool didShrink;
 
         OperationInProgress operationInProgress;
+
+        // Blocks before this index have been swept since the last collection.
+        size_t nextSweepBlock;
+
+        size_t cellsSweptByAllocation;
+        size_t cellsSweptIncrementally;
+        size_t cellsSweptDuringCollection;
+        size_t skippedDestructors;
+
+        HeapGrowthEvent growthTrace[HEAP_GROWTH_TRACE_LENGTH]; // Circular.
+        size_t growthEventCount;
+
+#if ENABLE(GENERATIONAL_COLLECTION)
+        bool generationalCollectionEnabled;
+        bool fullCollectionNeeded;
+        size_t oldCellsAfterFullCollection;
+        size_t nurseryCollections;
+        size_t fullCollections;
+        size_t promotedCells;
+#endif
     };
 
     class Heap : public Noncopyable {
@@ -76,7 +115,14 @@ namespace JSC {
         void* allocate(size_t);
 
         bool isBusy(); // true if an allocation or collection is in progress
-        void collectAllGarbage();
+
+        // With IncrementalSweep, dead cells are destroyed later, either as allocation reaches
+        // them or by calls to sweepIncrementally, instead of during the collection pause.
+        void collectAllGarbage(SweepMode = EagerSweep);
+
+        // Sweeps blocks ahead of the allocator until timeLimit seconds have passed.
+        // Returns true if there are blocks left to sweep.
+        bool sweepIncrementally(double timeLimit);
 
         static const size_t minExtraCost = 256;
         static const size_t maxExtraCost = 1024 * 1024;
@@ -87,9 +133,46 @@ namespace JSC {
         struct Statistics {
             size_t size;
             size_t free;
+
+            // Per-generation counters. These stay zero unless generational collection is enabled.
+            size_t nurseryCollections;
+            size_t fullCollections;
+            size_t nurseryCells; // Cells allocated since the last collection.
+            size_t oldCells; // Cells that survived a collection, including garbage awaiting a full collection.
+            size_t promotedCells; // Cells promoted out of the nursery since the heap was created.
+
+            // Sweeping counters, since the heap was created. Only cells swept during a
+            // collection add to GC pause time; the others were deferred.
+            size_t cellsSweptByAllocation;
+            size_t cellsSweptIncrementally;
+            size_t cellsSweptDuringCollection;
+            size_t skippedDestructors; // Cells reused by allocation without a destructor call.
         };
         Statistics statistics() const;
 
+        // A soft limit on heap size, in bytes. Near the limit, the heap collects more often
+        // instead of growing; it only grows past the limit if nearly every cell is live.
+        // 0, the default on most platforms, means no limit. Symbian also has a hard cap,
+        // the size of the chunk its blocks come from, which the heap never grows past.
+        void setMaxHeapSize(size_t);
+        size_t maxHeapSize() const;
+
+        Vector<HeapGrowthEvent> growthTrace() const; // Oldest event first.
+        void dumpGrowthTrace() const;
+
+#if ENABLE(GENERATIONAL_COLLECTION)
+        // In generational mode, most collections only trace cells allocated since the
+        // previous collection. Survivors are promoted in place by keeping their mark bits,
+        // and old cells are reclaimed by an occasional full collection.
+        void setGenerationalCollectionEnabled(bool);
+        bool isGenerationalCollectionEnabled() const { return m_heap.generationalCollectionEnabled; }
+#endif
+
+        // Must be called after storing a value into a cell, so nursery collections can find
+        // pointers from old cells to young ones. No-ops unless GENERATIONAL_COLLECTION is enabled.
+        static void writeBarrier(const JSCell* owner, JSValue);
+        static void writeBarrier(const JSCell* owner);
+
         void protect(JSValue);
         void unprotect(JSValue);
 
@@ -106,6 +189,15 @@ namespace JSC {
 
         static bool isCellMarked(const JSCell*);
         static void markCell(JSCell*);
+#if ENABLE(PARALLEL_MARKING)
+        // Atomically marks the cell. Returns true if it was already marked.
+        static bool testAndSetMarked(JSCell*);
+
+        // Number of threads, including the collecting thread, that trace the heap during
+        // a collection. The default of 1 marks serially.
+        void setMarkingThreadCount(unsigned);
+        unsigned markingThreadCount() const;
+#endif
 
         void markConservatively(MarkStack&, void* start, void* end);
 
@@ -120,10 +212,12 @@ namespace JSC {
     private:
         void reset();
         void sweep();
+        size_t sweepBlock(size_t block, size_t startCell);
         static CollectorBlock* cellBlock(const JSCell*);
         static size_t cellOffset(const JSCell*);
 
         friend class JSGlobalData;
+        friend class MarkStack;
         Heap(JSGlobalData*);
         ~Heap();
 
@@ -134,6 +228,7 @@ namespace JSC {
         void resizeBlocks();
         void growBlocks(size_t neededBlocks);
         void shrinkBlocks(size_t neededBlocks);
+        void recordGrowthEvent(size_t liveBytes, size_t oldBlockCount, bool reachedLimit);
         void clearMarkBits();
         void clearMarkBits(CollectorBlock*);
         size_t markedCells(size_t startBlock = 0, size_t startCell = 0) const;
@@ -142,8 +237,16 @@ namespace JSC {
 
         void addToStatistics(Statistics&) const;
 
-        void markRoots();
+        void markRoots(CollectionType = FullCollection);
+#if ENABLE(PARALLEL_MARKING)
+        void verifyParallelMarking(MarkStack&);
+#endif
         void markProtectedObjects(MarkStack&);
+#if ENABLE(GENERATIONAL_COLLECTION)
+        void markRememberedCells(MarkStack&);
+        CollectionType nextCollectionType() const;
+        void didCollect(CollectionType, size_t oldCellsBeforeCollection);
+#endif
         void markCurrentThreadConservatively(MarkStack&);
         void markCurrentThreadConservativelyInternal(MarkStack&);
         void markOtherThreadConservatively(MarkStack&, Thread*);
@@ -157,6 +260,10 @@ namespace JSC {
 
         HashSet<MarkedArgumentBuffer*>* m_markListSet;
 
+#if ENABLE(PARALLEL_MARKING)
+        OwnPtr<ParallelMarker> m_parallelMarker;
+#endif
+
 #if ENABLE(JSC_MULTIPLE_THREADS)
         void makeUsableFromMultipleThreads();
 
@@ -197,7 +304,13 @@ namespace JSC {
     const size_t SMALL_CELL_SIZE = CELL_SIZE / 2;
     const size_t CELL_MASK = CELL_SIZE - 1;
     const size_t CELL_ALIGN_MASK = ~CELL_MASK;
-    const size_t CELLS_PER_BLOCK = (BLOCK_SIZE - sizeof(Heap*)) * 8 * CELL_SIZE / (8 * CELL_SIZE + 1) / CELL_SIZE; // one bitmap byte can represent 8 cells.
+#if ENABLE(GENERATIONAL_COLLECTION)
+    const size_t CELLS_PER_CARD = 64;
+    const size_t CARD_TABLE_SIZE = BLOCK_SIZE / CELL_SIZE / CELLS_PER_CARD; // one card byte for every CELLS_PER_CARD cells.
+#else
+    const size_t CARD_TABLE_SIZE = 0;
+#endif
+    const size_t CELLS_PER_BLOCK = (BLOCK_SIZE - sizeof(Heap*) - CARD_TABLE_SIZE) * 8 * CELL_SIZE / (8 * CELL_SIZE + 1) / CELL_SIZE; // one bitmap byte can represent 8 cells.
     
     const size_t BITMAP_SIZE = (CELLS_PER_BLOCK + 7) / 8;
     const size_t BITMAP_WORDS = (BITMAP_SIZE + 3) / sizeof(uint32_t);
@@ -206,6 +319,13 @@ namespace JSC {
         uint32_t bits[BITMAP_WORDS];
         bool get(size_t n) const { return !!(bits[n >> 5] & (1 << (n & 0x1F))); } 
         void set(size_t n) { bits[n >> 5] |= (1 << (n & 0x1F)); } 
+#if ENABLE(PARALLEL_MARKING)
+        bool testAndSet(size_t n) // Atomic. Returns the previous value of the bit.
+        {
+            uint32_t mask = 1 << (n & 0x1F);
+            return !!(__sync_fetch_and_or(&bits[n >> 5], mask) & mask);
+        }
+#endif
         void clear(size_t n) { bits[n >> 5] &= ~(1 << (n & 0x1F)); } 
         void clearAll() { memset(bits, 0, sizeof(bits)); }
         size_t count(size_t startCell = 0)
@@ -228,6 +348,24 @@ namespace JSC {
         }
     };
   
+#if ENABLE(GENERATIONAL_COLLECTION)
+    const size_t CARDS_PER_BLOCK = (CELLS_PER_BLOCK + CELLS_PER_CARD - 1) / CELLS_PER_CARD;
+
+    // A card is dirtied by the write barrier when a cell is stored into an old cell it covers.
+    // Cards holding old cells whose children are not tracked by write barriers (cells that
+    // override markChildren, other than arrays) stay flagged until the next full collection.
+    enum CardState { CardClean = 0, CardDirty = 1, CardHasUnbarrieredCells = 2 };
+
+    struct CollectorCardTable {
+        uint8_t cards[CARD_TABLE_SIZE];
+        uint8_t get(size_t card) const { return cards[card]; }
+        void dirty(size_t cell) { cards[cell / CELLS_PER_CARD] |= CardDirty; }
+        void setHasUnbarrieredCells(size_t cell) { cards[cell / CELLS_PER_CARD] |= CardHasUnbarrieredCells; }
+        void clean(size_t card) { cards[card] &= ~CardDirty; }
+        void clearAll() { memset(cards, 0, sizeof(cards)); }
+    };
+#endif
+
     struct CollectorCell {
         double memory[CELL_ARRAY_LENGTH];
     };
@@ -236,6 +374,9 @@ namespace JSC {
     public:
         CollectorCell cells[CELLS_PER_BLOCK];
         CollectorBitmap marked;
+#if ENABLE(GENERATIONAL_COLLECTION)
+        CollectorCardTable cards;
+#endif
         Heap* heap;
     };
 
@@ -266,6 +407,24 @@ namespace JSC {
         cellBlock(cell)->marked.set(cellOffset(cell));
     }
 
+#if ENABLE(PARALLEL_MARKING)
+    inline bool Heap::testAndSetMarked(JSCell* cell)
+    {
+        return cellBlock(cell)->marked.testAndSet(cellOffset(cell));
+    }
+#endif
+
+#if ENABLE(GENERATIONAL_COLLECTION)
+    inline void Heap::writeBarrier(const JSCell* owner)
+    {
+        cellBlock(owner)->cards.dirty(cellOffset(owner));
+    }
+#else
+    inline void Heap::writeBarrier(const JSCell*)
+    {
+    }
+#endif
+
     inline void Heap::reportExtraMemoryCost(size_t cost)
     {
         if (cost > minExtraCost) 
@@ -29,6 +29,7 @@
 #include "BytecodeGenerator.h"
 #include "CodeBlock.h"
 #include "JIT.h"
+#include "ParseCache.h"
 #include "Parser.h"
 #include "StringBuilder.h"
 #include "Vector.h"
@@ -95,7 +96,7 @@ JSObject* ProgramExecutable::compile(ExecState* exec, ScopeChainNode* scopeChain
 {
     int errLine;
     UString errMsg;
-    RefPtr<ProgramNode> programNode = exec->globalData().parser->parse<ProgramNode>(&exec->globalData(), exec->lexicalGlobalObject()->debugger(), exec, m_source, &errLine, &errMsg);
+    RefPtr<ProgramNode> programNode = exec->globalData().parseCache->parse<ProgramNode>(&exec->globalData(), exec->lexicalGlobalObject()->debugger(), exec, m_source, &errLine, &errMsg);
     if (!programNode)
         return Error::create(exec, SyntaxError, errMsg, errLine, m_source.provider()->asID(), m_source.provider()->url());
     recordParse(programNode->features(), programNode->lineNo(), programNode->lastLine());
@@ -108,17 +109,14 @@ JSObject* ProgramExecutable::compile(ExecState* exec, ScopeChainNode* scopeChain
     OwnPtr<BytecodeGenerator> generator(new BytecodeGenerator(programNode.get(), globalObject->debugger(), scopeChain, &globalObject->symbolTable(), m_programCodeBlock));
     generator->generate();
 
-    programNode->destroyData();
+    ParseCache::didGenerateCode(programNode.get());
     return 0;
 }
 
 void FunctionExecutable::compile(ExecState*, ScopeChainNode* scopeChainNode)
 {
     JSGlobalData* globalData = scopeChainNode->globalData;
-    RefPtr<FunctionBodyNode> body = globalData->parser->parse<FunctionBodyNode>(globalData, 0, 0, m_source);
-    if (m_forceUsesArguments)
-        body->setUsesArguments();
-    body->finishParsing(m_parameters, m_name);
+    RefPtr<FunctionBodyNode> body = globalData->parseCache->parseFunctionBody(globalData, m_source, m_parameters, m_name, m_forceUsesArguments);
     recordParse(body->features(), body->lineNo(), body->lastLine());
 
     ScopeChain scopeChain(scopeChainNode);
@@ -132,7 +130,7 @@ void FunctionExecutable::compile(ExecState*, ScopeChainNode* scopeChainNode)
     ASSERT(m_numParameters);
     m_numVariables = m_codeBlock->m_numVars;
 
-    body->destroyData();
+    ParseCache::didGenerateCode(body.get());
 }
 
 #if ENABLE(JIT)
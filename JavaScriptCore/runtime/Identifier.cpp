@@ -22,6 +22,7 @@
 #include "Identifier.h"
 
 #include "CallFrame.h"
+#include "Lookup.h"
 #include <new> // for placement new
 #include <string.h> // for strlen
 #include <wtf/Assertions.h>
@@ -69,6 +70,7 @@ private:
 
 IdentifierTable* createIdentifierTable()
 {
+    sealSharedIdentifierTable();
     return new IdentifierTable;
 }
 
@@ -121,6 +123,98 @@ struct CStringTranslator {
     }
 };
 
+// Identifiers that every IdentifierTable resolves to the same static string, such as the
+// common identifiers and the property names of the built-in lookup tables. Each per-thread
+// table is layered over this one, so these names are hashed and allocated once per process
+// rather than once per JSGlobalData. The table is filled during initialization and sealed
+// when the first IdentifierTable is created; it is never written to after that, which is what
+// makes it safe to read from any thread without locking.
+class SharedIdentifierTable : public FastAllocBase {
+public:
+    SharedIdentifierTable()
+        : m_sealed(false)
+    {
+    }
+
+    bool isSealed() const { return m_sealed; }
+    void seal() { m_sealed = true; }
+
+    void add(const char* c)
+    {
+        ASSERT(!m_sealed);
+        // The empty string and single characters are already shared through SmallStrings.
+        size_t length = strlen(c);
+        if (length <= 1 || m_literalTable.contains(c))
+            return;
+
+        UString::Rep* r;
+        HashSet<UString::Rep*>::iterator iter = m_table.find<const char*, CStringTranslator>(c);
+        if (iter != m_table.end())
+            r = *iter;
+        else {
+            r = UString::Rep::createStatic(c, length);
+            r->setIsIdentifier(true);
+            m_table.add(r);
+        }
+        m_literalTable.add(c, r);
+    }
+
+    UString::Rep* findLiteral(const char* c) const
+    {
+        HashMap<const char*, UString::Rep*, PtrHash<const char*> >::const_iterator iter = m_literalTable.find(c);
+        return iter == m_literalTable.end() ? 0 : iter->second;
+    }
+
+    template<typename U, typename V>
+    UString::Rep* find(const U& value) const
+    {
+        HashSet<UString::Rep*>::const_iterator iter = m_table.find<U, V>(value);
+        return iter == m_table.end() ? 0 : *iter;
+    }
+
+    UString::Rep* find(UString::Rep* r) const
+    {
+        HashSet<UString::Rep*>::const_iterator iter = m_table.find(r);
+        return iter == m_table.end() ? 0 : *iter;
+    }
+
+private:
+    HashSet<UString::Rep*> m_table;
+    HashMap<const char*, UString::Rep*, PtrHash<const char*> > m_literalTable;
+    bool m_sealed;
+};
+
+static SharedIdentifierTable& sharedIdentifierTable()
+{
+    static SharedIdentifierTable* table = new SharedIdentifierTable;
+    return *table;
+}
+
+void addSharedIdentifiers(const char* const* names)
+{
+    SharedIdentifierTable& table = sharedIdentifierTable();
+    ASSERT(!table.isSealed());
+    if (table.isSealed())
+        return;
+    for (int i = 0; names[i]; ++i)
+        table.add(names[i]);
+}
+
+void addSharedIdentifiers(const HashTable& hashTable)
+{
+    SharedIdentifierTable& table = sharedIdentifierTable();
+    ASSERT(!table.isSealed());
+    if (table.isSealed())
+        return;
+    for (int i = 0; hashTable.values[i].key; ++i)
+        table.add(hashTable.values[i].key);
+}
+
+void sealSharedIdentifierTable()
+{
+    sharedIdentifierTable().seal();
+}
+
 PassRefPtr<UString::Rep> Identifier::add(JSGlobalData* globalData, const char* c)
 {
     ASSERT(c);
@@ -132,6 +226,10 @@ PassRefPtr<UString::Rep> Identifier::add(JSGlobalData* globalData, const char* c
     if (!c[1])
         return add(globalData, globalData->smallStrings.singleCharacterStringRep(static_cast<unsigned char>(c[0])));
 
+    SharedIdentifierTable& sharedTable = sharedIdentifierTable();
+    if (UString::Rep* shared = sharedTable.findLiteral(c))
+        return shared;
+
     IdentifierTable& identifierTable = *globalData->identifierTable;
     LiteralIdentifierTable& literalIdentifierTable = identifierTable.literalTable();
 
@@ -139,6 +237,12 @@ PassRefPtr<UString::Rep> Identifier::add(JSGlobalData* globalData, const char* c
     if (iter != literalIdentifierTable.end())
         return iter->second;
 
+    // A literal with different storage than the one the shared table was given.
+    if (UString::Rep* shared = sharedTable.find<const char*, CStringTranslator>(c)) {
+        literalIdentifierTable.add(c, shared);
+        return shared;
+    }
+
     pair<HashSet<UString::Rep*>::iterator, bool> addResult = identifierTable.add<const char*, CStringTranslator>(c);
 
     // If the string is newly-translated, then we need to adopt it.
@@ -155,15 +259,18 @@ PassRefPtr<UString::Rep> Identifier::add(ExecState* exec, const char* c)
     return add(&exec->globalData(), c);
 }
 
+// The hash is computed once by the caller, since a buffer is looked up in the shared
+// identifier table before it is added to the per-thread one.
 struct UCharBuffer {
     const UChar* s;
     unsigned int length;
+    unsigned hash;
 };
 
 struct UCharBufferTranslator {
     static unsigned hash(const UCharBuffer& buf)
     {
-        return UString::Rep::computeHash(buf.s, buf.length);
+        return buf.hash;
     }
 
     static bool equal(UString::Rep* str, const UCharBuffer& buf)
@@ -193,7 +300,10 @@ PassRefPtr<UString::Rep> Identifier::add(JSGlobalData* globalData, const UChar*
         UString::Rep::empty().hash();
         return &UString::Rep::empty();
     }
-    UCharBuffer buf = {s, length}; 
+    UCharBuffer buf = {s, length, UString::Rep::computeHash(s, length)};
+    if (UString::Rep* shared = sharedIdentifierTable().find<UCharBuffer, UCharBufferTranslator>(buf))
+        return shared;
+
     pair<HashSet<UString::Rep*>::iterator, bool> addResult = globalData->identifierTable->add<UCharBuffer, UCharBufferTranslator>(buf);
 
     // If the string is newly-translated, then we need to adopt it.
@@ -224,6 +334,8 @@ PassRefPtr<UString::Rep> Identifier::addSlowCase(JSGlobalData* globalData, UStri
         UString::Rep::empty().hash();
         return &UString::Rep::empty();
     }
+    if (UString::Rep* shared = sharedIdentifierTable().find(r))
+        return shared;
     return *globalData->identifierTable->add(r).first;
 }
 
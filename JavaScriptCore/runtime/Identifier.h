@@ -142,6 +142,16 @@ namespace JSC {
     IdentifierTable* createIdentifierTable();
     void deleteIdentifierTable(IdentifierTable*);
 
+    struct HashTable;
+
+    // Names added here are interned once per process as static strings that every
+    // IdentifierTable shares, instead of once per JSGlobalData. Embedders may add the keys
+    // of their own lookup tables, but only before the first JSGlobalData is created; the
+    // shared table is sealed at that point and is read-only from then on.
+    void addSharedIdentifiers(const char* const* names); // Null terminated, only to be used with string literals.
+    void addSharedIdentifiers(const HashTable&);
+    void sealSharedIdentifierTable();
+
     struct ThreadIdentifierTableData {
         ThreadIdentifierTableData()
             : defaultIdentifierTable(0)
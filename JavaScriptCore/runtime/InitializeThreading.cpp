@@ -34,6 +34,7 @@
 #include "Identifier.h"
 #include "JSGlobalObject.h"
 #include "UString.h"
+#include "yarr/RegexJIT.h"
 #include <wtf/DateMath.h>
 #include <wtf/Threading.h>
 
@@ -50,6 +51,10 @@ static void initializeThreadingOnce()
     WTF::initializeThreading();
     initializeUString();
     JSGlobalData::storeVPtrs();
+    JSGlobalData::addSharedIdentifiers();
+#if ENABLE(YARR_JIT_CACHE)
+    Yarr::RegexCodeCache::shared();
+#endif
 #if ENABLE(JSC_MULTIPLE_THREADS)
     s_dtoaP5Mutex = new Mutex;
     initializeDates();
@@ -30,6 +30,7 @@
 #include "PropertyNameArray.h"
 #include <wtf/AVLTree.h>
 #include <wtf/Assertions.h>
+#include <wtf/MathExtras.h>
 #include <wtf/OwnPtr.h>
 #include <Operations.h>
 
@@ -66,6 +67,14 @@ ASSERT_CLASS_FITS_IN_CELL(JSArray);
 //     (1 / minDensityMultiplier) of the entries would be populated).
 //   * Where (MAX_STORAGE_VECTOR_INDEX < i <= MAX_ARRAY_INDEX) the value will always be stored
 //     in the sparse array.
+//
+// A new array starts out with typed storage instead (see ArrayStorageMode): its values are kept
+// unboxed, as int32s or doubles, at indices 0 to m_numValuesInVector - 1. Writing a value that is
+// not a number, or writing to an index that would leave a hole before it, converts the storage to
+// the generic form above; storage never converts back. An int32 vector that is given a number that
+// is not an int32 is widened to a double vector, except under JSVALUE32: there every read from a
+// double vector would allocate a new JSNumberCell, so such numbers convert to generic storage and
+// keep the cell they were boxed in.
 
 // The definition of MAX_STORAGE_VECTOR_LENGTH is dependant on the definition storageSize
 // function below - the MAX_STORAGE_VECTOR_LENGTH limit is defined such that the storage
@@ -73,6 +82,9 @@ ASSERT_CLASS_FITS_IN_CELL(JSArray);
 // (vectorLength * sizeof(JSValue)) must be <= 0xFFFFFFFFU (which is maximum value of size_t).
 #define MAX_STORAGE_VECTOR_LENGTH static_cast<unsigned>((0xFFFFFFFFU - (sizeof(ArrayStorage) - sizeof(JSValue))) / sizeof(JSValue))
 
+// The same limit for typed vectors, sized for their largest element type.
+#define MAX_TYPED_VECTOR_LENGTH static_cast<unsigned>((0xFFFFFFFFU - (sizeof(ArrayStorage) - sizeof(JSValue))) / sizeof(double))
+
 // These values have to be macros to be used in max() and min() without introducing
 // a PIC branch in Mach-O binaries, see <rdar://problem/5971391>.
 #define MIN_SPARSE_ARRAY_INDEX 10000U
@@ -102,6 +114,15 @@ static inline size_t storageSize(unsigned vectorLength)
     return size;
 }
 
+static inline size_t typedStorageSize(unsigned mode, unsigned vectorLength)
+{
+    ASSERT(mode != GenericArrayStorage);
+    ASSERT(vectorLength <= MAX_TYPED_VECTOR_LENGTH);
+
+    size_t elementSize = mode == Int32ArrayStorage ? sizeof(int32_t) : sizeof(double);
+    return (sizeof(ArrayStorage) - sizeof(JSValue)) + (vectorLength * elementSize);
+}
+
 static inline unsigned increasedVectorLength(unsigned newLength)
 {
     ASSERT(newLength <= MAX_STORAGE_VECTOR_LENGTH);
@@ -136,16 +157,34 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure)
     unsigned initialCapacity = 0;
 
     m_storage = static_cast<ArrayStorage*>(fastZeroedMalloc(storageSize(initialCapacity)));
-    m_vectorLength = initialCapacity;
+    m_storage->m_mode = Int32ArrayStorage;
+    m_vectorLength = 0;
 
     checkConsistency();
 }
 
-JSArray::JSArray(NonNullPassRefPtr<Structure> structure, unsigned initialLength)
+JSArray::JSArray(NonNullPassRefPtr<Structure> structure, unsigned initialLength, ArrayStorageMode mode)
     : JSObject(structure)
 {
     unsigned initialCapacity = min(initialLength, MIN_SPARSE_ARRAY_INDEX);
 
+    if (mode != GenericArrayStorage) {
+        m_storage = static_cast<ArrayStorage*>(fastMalloc(typedStorageSize(mode, initialCapacity)));
+        m_storage->m_length = initialLength;
+        m_vectorLength = 0;
+        m_storage->m_numValuesInVector = 0;
+        m_storage->m_sparseValueMap = 0;
+        m_storage->lazyCreationData = 0;
+        m_storage->reportedMapCapacity = 0;
+        m_storage->m_mode = mode;
+        m_storage->m_typedVectorLength = initialCapacity;
+
+        checkConsistency();
+
+        Heap::heap(this)->reportExtraMemoryCost(typedStorageSize(mode, initialCapacity));
+        return;
+    }
+
     m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialCapacity)));
     m_storage->m_length = initialLength;
     m_vectorLength = initialCapacity;
@@ -153,6 +192,8 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, unsigned initialLength)
     m_storage->m_sparseValueMap = 0;
     m_storage->lazyCreationData = 0;
     m_storage->reportedMapCapacity = 0;
+    m_storage->m_mode = GenericArrayStorage;
+    m_storage->m_typedVectorLength = 0;
 
     JSValue* vector = m_storage->m_vector;
     for (size_t i = 0; i < initialCapacity; ++i)
@@ -168,6 +209,51 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, const ArgList& list)
 {
     unsigned initialCapacity = list.size();
 
+    ArrayStorageMode mode = Int32ArrayStorage;
+    ArgList::const_iterator end = list.end();
+    for (ArgList::const_iterator it = list.begin(); it != end; ++it) {
+        if (it->isInt32())
+            continue;
+#if USE(JSVALUE32)
+        mode = GenericArrayStorage;
+        break;
+#else
+        if (!it->isNumber()) {
+            mode = GenericArrayStorage;
+            break;
+        }
+        mode = DoubleArrayStorage;
+#endif
+    }
+
+    if (mode != GenericArrayStorage) {
+        m_storage = static_cast<ArrayStorage*>(fastMalloc(typedStorageSize(mode, initialCapacity)));
+        m_storage->m_length = initialCapacity;
+        m_vectorLength = 0;
+        m_storage->m_numValuesInVector = initialCapacity;
+        m_storage->m_sparseValueMap = 0;
+        m_storage->lazyCreationData = 0;
+        m_storage->reportedMapCapacity = 0;
+        m_storage->m_mode = mode;
+        m_storage->m_typedVectorLength = initialCapacity;
+
+        size_t i = 0;
+        if (mode == Int32ArrayStorage) {
+            int32_t* vector = m_storage->int32Vector();
+            for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i)
+                vector[i] = it->asInt32();
+        } else {
+            double* vector = m_storage->doubleVector();
+            for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i)
+                vector[i] = it->uncheckedGetNumber();
+        }
+
+        checkConsistency();
+
+        Heap::heap(this)->reportExtraMemoryCost(typedStorageSize(mode, initialCapacity));
+        return;
+    }
+
     m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialCapacity)));
     m_storage->m_length = initialCapacity;
     m_vectorLength = initialCapacity;
@@ -175,9 +261,10 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, const ArgList& list)
     m_storage->m_sparseValueMap = 0;
     m_storage->lazyCreationData = 0;
     m_storage->reportedMapCapacity = 0;
+    m_storage->m_mode = GenericArrayStorage;
+    m_storage->m_typedVectorLength = 0;
 
     size_t i = 0;
-    ArgList::const_iterator end = list.end();
     for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i)
         m_storage->m_vector[i] = *it;
 
@@ -211,6 +298,11 @@ bool JSArray::getOwnPropertySlot(ExecState* exec, unsigned i, PropertySlot& slot
             slot.setValueSlot(&valueSlot);
             return true;
         }
+    } else if (storage->m_mode != GenericArrayStorage) {
+        if (i < storage->m_numValuesInVector) {
+            slot.setValue(getTypedIndex(i));
+            return true;
+        }
     } else if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
         if (i >= MIN_SPARSE_ARRAY_INDEX) {
             SparseArrayValueMap::iterator it = map->find(i);
@@ -257,6 +349,11 @@ bool JSArray::getOwnPropertyDescriptor(ExecState* exec, const Identifier& proper
                 descriptor.setDescriptor(value, 0);
                 return true;
             }
+        } else if (m_storage->m_mode != GenericArrayStorage) {
+            if (i < m_storage->m_numValuesInVector) {
+                descriptor.setDescriptor(getTypedIndex(i), 0);
+                return true;
+            }
         } else if (SparseArrayValueMap* map = m_storage->m_sparseValueMap) {
             if (i >= MIN_SPARSE_ARRAY_INDEX) {
                 SparseArrayValueMap::iterator it = map->find(i);
@@ -297,6 +394,13 @@ void JSArray::put(ExecState* exec, unsigned i, JSValue value)
 {
     checkConsistency();
 
+    if (m_storage->m_mode != GenericArrayStorage && putTypedIndex(i, value)) {
+        checkConsistency();
+        return;
+    }
+
+    Heap::writeBarrier(this, value);
+
     unsigned length = m_storage->m_length;
     if (i >= length && i <= MAX_ARRAY_INDEX) {
         length = i + 1;
@@ -438,6 +542,17 @@ bool JSArray::deleteProperty(ExecState* exec, unsigned i)
 
     ArrayStorage* storage = m_storage;
 
+    if (storage->m_mode != GenericArrayStorage && i < storage->m_numValuesInVector) {
+        // Deleting the last value leaves typed storage dense; deleting any other one leaves a hole.
+        if (i + 1 == storage->m_numValuesInVector) {
+            --storage->m_numValuesInVector;
+            checkConsistency();
+            return true;
+        }
+        convertToGenericStorage();
+        storage = m_storage;
+    }
+
     if (i < m_vectorLength) {
         JSValue& valueSlot = storage->m_vector[i];
         if (!valueSlot) {
@@ -477,6 +592,12 @@ void JSArray::getOwnPropertyNames(ExecState* exec, PropertyNameArray& propertyNa
 
     ArrayStorage* storage = m_storage;
 
+    if (storage->m_mode != GenericArrayStorage) {
+        unsigned numValues = storage->m_numValuesInVector;
+        for (unsigned i = 0; i < numValues; ++i)
+            propertyNames.add(Identifier::from(exec, i));
+    }
+
     unsigned usedVectorLength = min(storage->m_length, m_vectorLength);
     for (unsigned i = 0; i < usedVectorLength; ++i) {
         if (storage->m_vector[i])
@@ -522,6 +643,157 @@ bool JSArray::increaseVectorLength(unsigned newLength)
     return true;
 }
 
+// Stores the value if the storage can stay typed. Otherwise converts the storage to the generic form
+// and returns false, leaving the caller to store the value the generic way.
+bool JSArray::putTypedIndex(unsigned i, JSValue value)
+{
+    ArrayStorage* storage = m_storage;
+    ASSERT(storage->m_mode != GenericArrayStorage);
+
+    if (i > storage->m_numValuesInVector || !value.isNumber()) {
+        convertToGenericStorage();
+        return false;
+    }
+
+    if (i == storage->m_typedVectorLength) {
+        if (!increaseTypedVectorLength(i + 1)) {
+            convertToGenericStorage();
+            return false;
+        }
+        storage = m_storage;
+    }
+
+    if (storage->m_mode == Int32ArrayStorage) {
+        if (value.isInt32())
+            storage->int32Vector()[i] = value.asInt32();
+        else {
+            double number = value.uncheckedGetNumber();
+            int32_t asInt32 = static_cast<int32_t>(number);
+            if (asInt32 == number && (asInt32 || !signbit(number)))
+                storage->int32Vector()[i] = asInt32;
+            else {
+#if USE(JSVALUE32)
+                convertToGenericStorage();
+                return false;
+#else
+                convertInt32ToDoubleStorage();
+                storage = m_storage;
+                storage->doubleVector()[i] = number;
+#endif
+            }
+        }
+    } else
+        storage->doubleVector()[i] = value.uncheckedGetNumber();
+
+    if (i == storage->m_numValuesInVector) {
+        ++storage->m_numValuesInVector;
+        if (i >= storage->m_length)
+            storage->m_length = i + 1;
+    }
+    return true;
+}
+
+bool JSArray::increaseTypedVectorLength(unsigned newLength)
+{
+    ArrayStorage* storage = m_storage;
+    unsigned mode = storage->m_mode;
+
+    unsigned vectorLength = storage->m_typedVectorLength;
+    ASSERT(newLength > vectorLength);
+    if (newLength > MAX_TYPED_VECTOR_LENGTH)
+        return false;
+    unsigned newVectorLength = min(increasedVectorLength(newLength), MAX_TYPED_VECTOR_LENGTH);
+
+    if (!tryFastRealloc(storage, typedStorageSize(mode, newVectorLength)).getValue(storage))
+        return false;
+
+    storage->m_typedVectorLength = newVectorLength;
+    m_storage = storage;
+
+    Heap::heap(this)->reportExtraMemoryCost(typedStorageSize(mode, newVectorLength) - typedStorageSize(mode, vectorLength));
+
+    return true;
+}
+
+void JSArray::convertInt32ToDoubleStorage()
+{
+    ArrayStorage* int32Storage = m_storage;
+    ASSERT(int32Storage->m_mode == Int32ArrayStorage);
+
+    // The values are copied into a new block rather than widened in place, so that no memory is
+    // ever accessed as both an int32_t and a double.
+    unsigned vectorLength = int32Storage->m_typedVectorLength;
+    ArrayStorage* storage = static_cast<ArrayStorage*>(fastMalloc(typedStorageSize(DoubleArrayStorage, vectorLength)));
+    storage->m_length = int32Storage->m_length;
+    storage->m_numValuesInVector = int32Storage->m_numValuesInVector;
+    storage->m_sparseValueMap = 0;
+    storage->lazyCreationData = int32Storage->lazyCreationData;
+    storage->reportedMapCapacity = 0;
+    storage->m_mode = DoubleArrayStorage;
+    storage->m_typedVectorLength = vectorLength;
+
+    int32_t* from = int32Storage->int32Vector();
+    double* to = storage->doubleVector();
+    unsigned numValues = storage->m_numValuesInVector;
+    for (unsigned i = 0; i < numValues; ++i)
+        to[i] = from[i];
+
+    m_storage = storage;
+    fastFree(int32Storage);
+
+    Heap::heap(this)->reportExtraMemoryCost(typedStorageSize(DoubleArrayStorage, vectorLength) - typedStorageSize(Int32ArrayStorage, vectorLength));
+}
+
+void JSArray::convertToGenericStorage()
+{
+    ArrayStorage* typedStorage = m_storage;
+    ASSERT(typedStorage->m_mode != GenericArrayStorage);
+    ASSERT(!m_vectorLength);
+
+    unsigned vectorLength = typedStorage->m_typedVectorLength;
+    unsigned numValues = typedStorage->m_numValuesInVector;
+    ArrayStorage* storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(vectorLength)));
+    storage->m_length = typedStorage->m_length;
+    storage->m_numValuesInVector = numValues;
+    storage->m_sparseValueMap = 0;
+    storage->lazyCreationData = typedStorage->lazyCreationData;
+    storage->reportedMapCapacity = 0;
+    storage->m_mode = GenericArrayStorage;
+    storage->m_typedVectorLength = 0;
+    for (unsigned i = 0; i < vectorLength; ++i)
+        storage->m_vector[i] = JSValue();
+
+    // Boxing a number may allocate a cell, and so collect, so the new vector is put in place before
+    // it is filled, and each value goes through the write barrier as it is stored.
+    m_storage = storage;
+    m_vectorLength = vectorLength;
+
+    JSGlobalData* globalData = Heap::heap(this)->globalData();
+    if (typedStorage->m_mode == Int32ArrayStorage) {
+        int32_t* from = typedStorage->int32Vector();
+        for (unsigned i = 0; i < numValues; ++i) {
+            JSValue value = jsNumber(globalData, from[i]);
+            storage->m_vector[i] = value;
+            Heap::writeBarrier(this, value);
+        }
+    } else {
+        double* from = typedStorage->doubleVector();
+        for (unsigned i = 0; i < numValues; ++i) {
+            JSValue value = jsNumber(globalData, from[i]);
+            storage->m_vector[i] = value;
+            Heap::writeBarrier(this, value);
+        }
+    }
+
+    size_t typedSize = typedStorageSize(typedStorage->m_mode, vectorLength);
+    fastFree(typedStorage);
+
+    if (storageSize(vectorLength) > typedSize)
+        Heap::heap(this)->reportExtraMemoryCost(storageSize(vectorLength) - typedSize);
+
+    checkConsistency();
+}
+
 void JSArray::setLength(unsigned newLength)
 {
     checkConsistency();
@@ -531,6 +803,9 @@ void JSArray::setLength(unsigned newLength)
     unsigned length = m_storage->m_length;
 
     if (newLength < length) {
+        if (storage->m_mode != GenericArrayStorage)
+            storage->m_numValuesInVector = min(storage->m_numValuesInVector, newLength);
+
         unsigned usedVectorLength = min(length, m_vectorLength);
         for (unsigned i = newLength; i < usedVectorLength; ++i) {
             JSValue& valueSlot = storage->m_vector[i];
@@ -578,6 +853,12 @@ JSValue JSArray::pop()
             valueSlot = JSValue();
         } else
             result = jsUndefined();
+    } else if (m_storage->m_mode != GenericArrayStorage) {
+        if (length < m_storage->m_numValuesInVector) {
+            result = getTypedIndex(length);
+            m_storage->m_numValuesInVector = length;
+        } else
+            result = jsUndefined();
     } else {
         result = jsUndefined();
         if (SparseArrayValueMap* map = m_storage->m_sparseValueMap) {
@@ -604,6 +885,13 @@ void JSArray::push(ExecState* exec, JSValue value)
 {
     checkConsistency();
 
+    if (m_storage->m_mode != GenericArrayStorage && putTypedIndex(m_storage->m_length, value)) {
+        checkConsistency();
+        return;
+    }
+
+    Heap::writeBarrier(this, value);
+
     if (m_storage->m_length < m_vectorLength) {
         m_storage->m_vector[m_storage->m_length] = value;
         ++m_storage->m_numValuesInVector;
@@ -643,6 +931,20 @@ static int compareNumbersForQSort(const void* a, const void* b)
     return (da > db) - (da < db);
 }
 
+static int compareInt32sForQSort(const void* a, const void* b)
+{
+    int32_t ia = *static_cast<const int32_t*>(a);
+    int32_t ib = *static_cast<const int32_t*>(b);
+    return (ia > ib) - (ia < ib);
+}
+
+static int compareDoublesForQSort(const void* a, const void* b)
+{
+    double da = *static_cast<const double*>(a);
+    double db = *static_cast<const double*>(b);
+    return (da > db) - (da < db);
+}
+
 typedef std::pair<JSValue, UString> ValueStringPair;
 
 static int compareByStringPairForQSort(const void* a, const void* b)
@@ -654,6 +956,19 @@ static int compareByStringPairForQSort(const void* a, const void* b)
 
 void JSArray::sortNumeric(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
 {
+    // Typed storage is already compact: it has no undefined values and its holes all follow its values.
+    ArrayStorage* storage = m_storage;
+    if (storage->m_mode == Int32ArrayStorage) {
+        qsort(storage->int32Vector(), storage->m_numValuesInVector, sizeof(int32_t), compareInt32sForQSort);
+        checkConsistency(SortConsistencyCheck);
+        return;
+    }
+    if (storage->m_mode == DoubleArrayStorage) {
+        qsort(storage->doubleVector(), storage->m_numValuesInVector, sizeof(double), compareDoublesForQSort);
+        checkConsistency(SortConsistencyCheck);
+        return;
+    }
+
     unsigned lengthNotIncludingUndefined = compactForSorting();
     if (m_storage->m_sparseValueMap) {
         throwOutOfMemoryError(exec);
@@ -685,6 +1000,9 @@ void JSArray::sortNumeric(ExecState* exec, JSValue compareFunction, CallType cal
 
 void JSArray::sort(ExecState* exec)
 {
+    if (m_storage->m_mode != GenericArrayStorage)
+        convertToGenericStorage();
+
     unsigned lengthNotIncludingUndefined = compactForSorting();
     if (m_storage->m_sparseValueMap) {
         throwOutOfMemoryError(exec);
@@ -825,6 +1143,9 @@ void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType,
 {
     checkConsistency();
 
+    if (m_storage->m_mode != GenericArrayStorage)
+        convertToGenericStorage();
+
     // FIXME: This ignores exceptions raised in the compare function or in toNumber.
 
     // The maximum tree depth is compiled in - but the caller is clearly up to no good
@@ -932,6 +1253,15 @@ void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType,
 
 void JSArray::fillArgList(ExecState* exec, MarkedArgumentBuffer& args)
 {
+    if (m_storage->m_mode != GenericArrayStorage) {
+        unsigned i = 0;
+        for (; i < m_storage->m_numValuesInVector; ++i)
+            args.append(getTypedIndex(i));
+        for (; i < m_storage->m_length; ++i)
+            args.append(get(exec, i));
+        return;
+    }
+
     JSValue* vector = m_storage->m_vector;
     unsigned vectorEnd = min(m_storage->m_length, m_vectorLength);
     unsigned i = 0;
@@ -950,6 +1280,16 @@ void JSArray::copyToRegisters(ExecState* exec, Register* buffer, uint32_t maxSiz
 {
     ASSERT(m_storage->m_length == maxSize);
     UNUSED_PARAM(maxSize);
+
+    if (m_storage->m_mode != GenericArrayStorage) {
+        unsigned i = 0;
+        for (; i < m_storage->m_numValuesInVector; ++i)
+            buffer[i] = getTypedIndex(i);
+        for (; i < m_storage->m_length; ++i)
+            buffer[i] = get(exec, i);
+        return;
+    }
+
     JSValue* vector = m_storage->m_vector;
     unsigned vectorEnd = min(m_storage->m_length, m_vectorLength);
     unsigned i = 0;
@@ -967,6 +1307,7 @@ void JSArray::copyToRegisters(ExecState* exec, Register* buffer, uint32_t maxSiz
 unsigned JSArray::compactForSorting()
 {
     checkConsistency();
+    ASSERT(m_storage->m_mode == GenericArrayStorage);
 
     ArrayStorage* storage = m_storage;
 
@@ -1040,6 +1381,14 @@ void JSArray::checkConsistency(ConsistencyCheckType type)
     if (type == SortConsistencyCheck)
         ASSERT(!m_storage->m_sparseValueMap);
 
+    if (m_storage->m_mode != GenericArrayStorage) {
+        ASSERT(!m_vectorLength);
+        ASSERT(!m_storage->m_sparseValueMap);
+        ASSERT(m_storage->m_numValuesInVector <= m_storage->m_length);
+        ASSERT(m_storage->m_numValuesInVector <= m_storage->m_typedVectorLength);
+        return;
+    }
+
     unsigned numValuesInVector = 0;
     for (unsigned i = 0; i < m_vectorLength; ++i) {
         if (JSValue value = m_storage->m_vector[i]) {
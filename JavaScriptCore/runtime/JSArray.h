@@ -27,13 +27,30 @@ namespace JSC {
 
     typedef HashMap<unsigned, JSValue> SparseArrayValueMap;
 
+    // An array that has only ever held int32s, or only numbers, keeps its elements unboxed in
+    // m_vector, reinterpreted as int32Vector() or doubleVector(). Such storage is dense: the
+    // first m_numValuesInVector indices hold values, any others below m_length are holes, and
+    // there is no sparse map. JSVALUE32 never uses double storage, since boxing each double read
+    // from it would allocate a JSNumberCell. JSArray keeps m_vectorLength at zero while storage is typed, so
+    // code that only understands boxed vectors sees every index as out of range.
+    enum ArrayStorageMode {
+        GenericArrayStorage,
+        Int32ArrayStorage,
+        DoubleArrayStorage
+    };
+
     struct ArrayStorage {
         unsigned m_length;
         unsigned m_numValuesInVector;
         SparseArrayValueMap* m_sparseValueMap;
         void* lazyCreationData; // A JSArray subclass can use this to fill the vector lazily.
         size_t reportedMapCapacity;
-        JSValue m_vector[1];
+        unsigned m_mode; // An ArrayStorageMode.
+        unsigned m_typedVectorLength; // Capacity of the typed vector, in elements; zero for generic storage.
+        WTF_ALIGNED(JSValue, m_vector[1], 8);
+
+        int32_t* int32Vector() { return reinterpret_cast<int32_t*>(m_vector); }
+        double* doubleVector() { return reinterpret_cast<double*>(m_vector); }
     };
 
     class JSArray : public JSObject {
@@ -42,7 +59,7 @@ namespace JSC {
 
     public:
         explicit JSArray(NonNullPassRefPtr<Structure>);
-        JSArray(NonNullPassRefPtr<Structure>, unsigned initialLength);
+        JSArray(NonNullPassRefPtr<Structure>, unsigned initialLength, ArrayStorageMode = Int32ArrayStorage);
         JSArray(NonNullPassRefPtr<Structure>, const ArgList& initialValues);
         virtual ~JSArray();
 
@@ -63,17 +80,32 @@ namespace JSC {
         void push(ExecState*, JSValue);
         JSValue pop();
 
-        bool canGetIndex(unsigned i) { return i < m_vectorLength && m_storage->m_vector[i]; }
+        bool canGetIndex(unsigned i)
+        {
+            if (i < m_vectorLength)
+                return m_storage->m_vector[i];
+            return m_storage->m_mode != GenericArrayStorage && i < m_storage->m_numValuesInVector;
+        }
         JSValue getIndex(unsigned i)
         {
             ASSERT(canGetIndex(i));
-            return m_storage->m_vector[i];
+            if (LIKELY(i < m_vectorLength))
+                return m_storage->m_vector[i];
+            return getTypedIndex(i);
         }
 
-        bool canSetIndex(unsigned i) { return i < m_vectorLength; }
+        bool canSetIndex(unsigned i)
+        {
+            if (i < m_vectorLength)
+                return true;
+            return m_storage->m_mode != GenericArrayStorage && i < m_storage->m_numValuesInVector;
+        }
         void setIndex(unsigned i, JSValue v)
         {
             ASSERT(canSetIndex(i));
+            // If the value does not fit typed storage, the storage is converted and the index is then in the vector.
+            if (UNLIKELY(i >= m_vectorLength) && putTypedIndex(i, v))
+                return;
             JSValue& x = m_storage->m_vector[i];
             if (!x) {
                 ++m_storage->m_numValuesInVector;
@@ -81,6 +113,7 @@ namespace JSC {
                     m_storage->m_length = i + 1;
             }
             x = v;
+            Heap::writeBarrier(this, v);
         }
 
         void fillArgList(ExecState*, MarkedArgumentBuffer&);
@@ -111,6 +144,12 @@ namespace JSC {
         void putSlowCase(ExecState*, unsigned propertyName, JSValue);
 
         bool increaseVectorLength(unsigned newLength);
+
+        inline JSValue getTypedIndex(unsigned);
+        bool putTypedIndex(unsigned, JSValue);
+        bool increaseTypedVectorLength(unsigned newLength);
+        void convertInt32ToDoubleStorage();
+        void convertToGenericStorage();
         
         unsigned compactForSorting();
 
@@ -140,6 +179,18 @@ namespace JSC {
     }
     inline bool isJSArray(JSGlobalData* globalData, JSCell* cell) { return cell->vptr() == globalData->jsArrayVPtr; }
 
+    inline JSValue JSArray::getTypedIndex(unsigned i)
+    {
+        ArrayStorage* storage = m_storage;
+        ASSERT(storage->m_mode != GenericArrayStorage);
+        ASSERT(i < storage->m_numValuesInVector);
+
+        JSGlobalData* globalData = Heap::heap(this)->globalData();
+        if (storage->m_mode == Int32ArrayStorage)
+            return jsNumber(globalData, storage->int32Vector()[i]);
+        return jsNumber(globalData, storage->doubleVector()[i]);
+    }
+
     inline void JSArray::markChildrenDirect(MarkStack& markStack)
     {
         JSObject::markChildrenDirect(markStack);
@@ -175,11 +226,20 @@ namespace JSC {
             asArray(cell)->markChildrenDirect(*this);
             return;
         }
+#if ENABLE(GENERATIONAL_COLLECTION)
+        // Custom markChildren implementations may find children that were never stored
+        // through a write barrier, so nursery collections must always revisit this cell.
+        Heap::cellBlock(cell)->cards.setHasUnbarrieredCells(Heap::cellOffset(cell));
+#endif
         cell->markChildren(*this);
     }
 
     inline void MarkStack::drain()
     {
+#if ENABLE(PARALLEL_MARKING)
+        if (m_isDrainDeferred)
+            return;
+#endif
         while (!m_markSets.isEmpty() || !m_values.isEmpty()) {
             while (!m_markSets.isEmpty() && m_values.size() < 50) {
                 ASSERT(!m_markSets.isEmpty());
@@ -194,7 +254,7 @@ namespace JSC {
                 current.m_values++;
 
                 JSCell* cell;
-                if (!value || !value.isCell() || Heap::isCellMarked(cell = value.asCell())) {
+                if (!value || !value.isCell() || testAndSetMarked(cell = value.asCell())) {
                     if (current.m_values == end) {
                         m_markSets.removeLast();
                         continue;
@@ -202,7 +262,6 @@ namespace JSC {
                     goto findNextUnmarkedNullValue;
                 }
 
-                Heap::markCell(cell);
                 if (cell->structure()->typeInfo().type() < CompoundType) {
                     if (current.m_values == end) {
                         m_markSets.removeLast();
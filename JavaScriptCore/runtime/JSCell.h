@@ -52,7 +52,7 @@ namespace JSC {
     public:
         static PassRefPtr<Structure> createDummyStructure()
         {
-            return Structure::create(jsNull(), TypeInfo(UnspecifiedType), AnonymousSlotCount);
+            return Structure::create(jsNull(), TypeInfo(UnspecifiedType, HasTrivialDestructor), AnonymousSlotCount);
         }
 
         // Querying the type.
@@ -325,13 +325,24 @@ namespace JSC {
         return isCell() ? asCell()->toThisObject(exec) : toThisObjectSlowCase(exec);
     }
 
+    ALWAYS_INLINE bool MarkStack::testAndSetMarked(JSCell* cell)
+    {
+#if ENABLE(PARALLEL_MARKING)
+        if (m_isMarkingInParallel)
+            return Heap::testAndSetMarked(cell);
+#endif
+        if (Heap::isCellMarked(cell))
+            return true;
+        Heap::markCell(cell);
+        return false;
+    }
+
     ALWAYS_INLINE void MarkStack::append(JSCell* cell)
     {
         ASSERT(!m_isCheckingForDefaultMarkViolation);
         ASSERT(cell);
-        if (Heap::isCellMarked(cell))
+        if (testAndSetMarked(cell))
             return;
-        Heap::markCell(cell);
         if (cell->structure()->typeInfo().type() >= CompoundType)
             m_values.append(cell);
     }
@@ -343,6 +354,28 @@ namespace JSC {
             append(value.asCell());
     }
 
+#if ENABLE(GENERATIONAL_COLLECTION)
+    ALWAYS_INLINE void MarkStack::appendOldCell(JSCell* cell)
+    {
+        ASSERT(Heap::isCellMarked(cell));
+        if (cell->structure()->typeInfo().type() >= CompoundType)
+            m_values.append(cell);
+    }
+#endif
+
+#if ENABLE(GENERATIONAL_COLLECTION)
+    inline void Heap::writeBarrier(const JSCell* owner, JSValue value)
+    {
+        // Only a young cell stored into an old cell needs to be remembered.
+        if (value.isCell() && isCellMarked(owner) && !isCellMarked(value.asCell()))
+            writeBarrier(owner);
+    }
+#else
+    inline void Heap::writeBarrier(const JSCell*, JSValue)
+    {
+    }
+#endif
+
     inline Heap* Heap::heap(JSValue v)
     {
         if (!v.isCell())
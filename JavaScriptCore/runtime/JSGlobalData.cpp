@@ -41,13 +41,16 @@
 #include "JSByteArray.h"
 #include "JSClassRef.h"
 #include "JSFunction.h"
+#include "JSGlobalObject.h"
 #include "JSLock.h"
 #include "JSNotAnObject.h"
 #include "JSPropertyNameIterator.h"
 #include "JSStaticScopeObject.h"
 #include "Lexer.h"
 #include "Lookup.h"
+#include "MegamorphicAccessCache.h"
 #include "Nodes.h"
+#include "ParseCache.h"
 #include "Parser.h"
 
 #if ENABLE(JSC_MULTIPLE_THREADS)
@@ -65,6 +68,7 @@ namespace JSC {
 extern JSC_CONST_HASHTABLE HashTable arrayTable;
 extern JSC_CONST_HASHTABLE HashTable jsonTable;
 extern JSC_CONST_HASHTABLE HashTable dateTable;
+extern JSC_CONST_HASHTABLE HashTable globalObjectTable;
 extern JSC_CONST_HASHTABLE HashTable mathTable;
 extern JSC_CONST_HASHTABLE HashTable numberTable;
 extern JSC_CONST_HASHTABLE HashTable regExpTable;
@@ -76,6 +80,29 @@ void* JSGlobalData::jsByteArrayVPtr;
 void* JSGlobalData::jsStringVPtr;
 void* JSGlobalData::jsFunctionVPtr;
 
+void JSGlobalData::addSharedIdentifiers()
+{
+#define JSC_IDENTIFIER_NAME(name) #name,
+    static const char* const commonIdentifierNames[] = {
+        "__proto__",
+        "this",
+        JSC_COMMON_IDENTIFIERS_EACH_PROPERTY_NAME(JSC_IDENTIFIER_NAME)
+        0
+    };
+#undef JSC_IDENTIFIER_NAME
+
+    JSC::addSharedIdentifiers(commonIdentifierNames);
+    JSC::addSharedIdentifiers(JSC::arrayTable);
+    JSC::addSharedIdentifiers(JSC::dateTable);
+    JSC::addSharedIdentifiers(JSC::globalObjectTable);
+    JSC::addSharedIdentifiers(JSC::jsonTable);
+    JSC::addSharedIdentifiers(JSC::mathTable);
+    JSC::addSharedIdentifiers(JSC::numberTable);
+    JSC::addSharedIdentifiers(JSC::regExpTable);
+    JSC::addSharedIdentifiers(JSC::regExpConstructorTable);
+    JSC::addSharedIdentifiers(JSC::stringTable);
+}
+
 void JSGlobalData::storeVPtrs()
 {
     CollectorCell cell;
@@ -107,6 +134,7 @@ JSGlobalData::JSGlobalData(bool isShared)
     , clientData(0)
     , arrayTable(fastNew<HashTable>(JSC::arrayTable))
     , dateTable(fastNew<HashTable>(JSC::dateTable))
+    , globalObjectTable(fastNew<HashTable>(JSC::globalObjectTable))
     , jsonTable(fastNew<HashTable>(JSC::jsonTable))
     , mathTable(fastNew<HashTable>(JSC::mathTable))
     , numberTable(fastNew<HashTable>(JSC::numberTable))
@@ -131,10 +159,13 @@ JSGlobalData::JSGlobalData(bool isShared)
     , emptyList(new MarkedArgumentBuffer)
     , lexer(new Lexer(this))
     , parser(new Parser)
+    , parseCache(new ParseCache)
     , interpreter(new Interpreter)
 #if ENABLE(JIT)
     , jitStubs(this)
+    , megamorphicAccessCache(new MegamorphicAccessCache)
 #endif
+    , stackSampler(0)
     , heap(this)
     , initializingLazyNumericCompareFunction(false)
     , head(0)
@@ -165,6 +196,7 @@ JSGlobalData::~JSGlobalData()
 
     arrayTable->deleteTable();
     dateTable->deleteTable();
+    globalObjectTable->deleteTable();
     jsonTable->deleteTable();
     mathTable->deleteTable();
     numberTable->deleteTable();
@@ -174,6 +206,7 @@ JSGlobalData::~JSGlobalData()
 
     fastDelete(const_cast<HashTable*>(arrayTable));
     fastDelete(const_cast<HashTable*>(dateTable));
+    fastDelete(const_cast<HashTable*>(globalObjectTable));
     fastDelete(const_cast<HashTable*>(jsonTable));
     fastDelete(const_cast<HashTable*>(mathTable));
     fastDelete(const_cast<HashTable*>(numberTable));
@@ -181,6 +214,10 @@ JSGlobalData::~JSGlobalData()
     fastDelete(const_cast<HashTable*>(regExpConstructorTable));
     fastDelete(const_cast<HashTable*>(stringTable));
 
+#if ENABLE(JIT)
+    delete megamorphicAccessCache;
+#endif
+    delete parseCache;
     delete parser;
     delete lexer;
 
@@ -264,6 +301,17 @@ void JSGlobalData::resetDateCache()
     dateInstanceCache.reset();
 }
 
+void JSGlobalData::clearGlobalEvalCodeCaches()
+{
+    JSGlobalObject* globalObject = head;
+    if (!globalObject)
+        return;
+    do {
+        globalObject->evalCodeCache().clear();
+        globalObject = globalObject->next();
+    } while (globalObject != head);
+}
+
 void JSGlobalData::startSampling()
 {
     interpreter->startSampling();
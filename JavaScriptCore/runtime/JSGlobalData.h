@@ -55,7 +55,10 @@ namespace JSC {
     class JSGlobalObject;
     class JSObject;
     class Lexer;
+    class MegamorphicAccessCache;
+    class ParseCache;
     class Parser;
+    class StackSampler;
     class Stringifier;
     class Structure;
     class UString;
@@ -107,6 +110,7 @@ namespace JSC {
 
         const HashTable* arrayTable;
         const HashTable* dateTable;
+        const HashTable* globalObjectTable;
         const HashTable* jsonTable;
         const HashTable* mathTable;
         const HashTable* numberTable;
@@ -130,6 +134,9 @@ namespace JSC {
 #endif
 
         static void storeVPtrs();
+        // Seeds the shared identifier table with the common identifiers and the keys of
+        // the built-in lookup tables. Called once, by initializeThreading().
+        static void addSharedIdentifiers();
         static JS_EXPORTDATA void* jsArrayVPtr;
         static JS_EXPORTDATA void* jsByteArrayVPtr;
         static JS_EXPORTDATA void* jsStringVPtr;
@@ -148,11 +155,15 @@ namespace JSC {
 
         Lexer* lexer;
         Parser* parser;
+        ParseCache* parseCache;
         Interpreter* interpreter;
 #if ENABLE(JIT)
         JITThunks jitStubs;
+        MegamorphicAccessCache* megamorphicAccessCache;
 #endif
         TimeoutChecker timeoutChecker;
+        // Not owned; set while the embedder wants the JavaScript stack sampled.
+        StackSampler* stackSampler;
         Heap heap;
 
         JSValue exception;
@@ -190,6 +201,10 @@ namespace JSC {
 
         void resetDateCache();
 
+        // Drops the code compiled for evals made at global scope, which each global object
+        // keeps for as long as it lives. For embedders to call when memory is low.
+        void clearGlobalEvalCodeCaches();
+
         void startSampling();
         void stopSampling();
         void dumpSampleData(ExecState* exec);
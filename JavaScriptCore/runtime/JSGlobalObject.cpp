@@ -70,10 +70,27 @@
 #include "StringPrototype.h"
 #include "Debugger.h"
 
+#include "JSGlobalObject.lut.h"
+
 namespace JSC {
 
 ASSERT_CLASS_FITS_IN_CELL(JSGlobalObject);
 
+/* Source for JSGlobalObject.lut.h
+@begin globalObjectTable
+  parseInt              globalFuncParseInt              DontEnum|Function 2
+  parseFloat            globalFuncParseFloat            DontEnum|Function 1
+  isNaN                 globalFuncIsNaN                 DontEnum|Function 1
+  isFinite              globalFuncIsFinite              DontEnum|Function 1
+  escape                globalFuncEscape                DontEnum|Function 1
+  unescape              globalFuncUnescape              DontEnum|Function 1
+  decodeURI             globalFuncDecodeURI             DontEnum|Function 1
+  decodeURIComponent    globalFuncDecodeURIComponent    DontEnum|Function 1
+  encodeURI             globalFuncEncodeURI             DontEnum|Function 1
+  encodeURIComponent    globalFuncEncodeURIComponent    DontEnum|Function 1
+@end
+*/
+
 // Default number of ticks before a timeout check should be done.
 static const int initialTickCountThreshold = 255;
 
@@ -157,6 +174,10 @@ void JSGlobalObject::put(ExecState* exec, const Identifier& propertyName, JSValu
 
     if (symbolTablePut(propertyName, value))
         return;
+    if (const HashEntry* entry = takeGlobalFunction(exec, propertyName)) {
+        putDirect(propertyName, value, entry->attributes() & ~Function);
+        return;
+    }
     JSVariableObject::put(exec, propertyName, value, slot);
 }
 
@@ -167,6 +188,13 @@ void JSGlobalObject::putWithAttributes(ExecState* exec, const Identifier& proper
     if (symbolTablePutWithAttributes(propertyName, value, attributes))
         return;
 
+    // Replacing a global function that was never created keeps its attributes, as it would
+    // have if reset() had put it in place.
+    if (const HashEntry* entry = takeGlobalFunction(exec, propertyName)) {
+        putDirect(propertyName, value, entry->attributes() & ~Function);
+        return;
+    }
+
     JSValue valueBefore = getDirect(propertyName);
     PutPropertySlot slot;
     JSVariableObject::put(exec, propertyName, value, slot);
@@ -180,15 +208,74 @@ void JSGlobalObject::putWithAttributes(ExecState* exec, const Identifier& proper
 void JSGlobalObject::defineGetter(ExecState* exec, const Identifier& propertyName, JSObject* getterFunc, unsigned attributes)
 {
     PropertySlot slot;
-    if (!symbolTableGet(propertyName, slot))
+    if (!symbolTableGet(propertyName, slot)) {
+        takeGlobalFunction(exec, propertyName);
         JSVariableObject::defineGetter(exec, propertyName, getterFunc, attributes);
+    }
 }
 
 void JSGlobalObject::defineSetter(ExecState* exec, const Identifier& propertyName, JSObject* setterFunc, unsigned attributes)
 {
     PropertySlot slot;
-    if (!symbolTableGet(propertyName, slot))
+    if (!symbolTableGet(propertyName, slot)) {
+        takeGlobalFunction(exec, propertyName);
         JSVariableObject::defineSetter(exec, propertyName, setterFunc, attributes);
+    }
+}
+
+bool JSGlobalObject::deleteProperty(ExecState* exec, const Identifier& propertyName)
+{
+    takeGlobalFunction(exec, propertyName);
+    return JSVariableObject::deleteProperty(exec, propertyName);
+}
+
+static inline uint64_t globalFunctionBit(const HashTable* table, const HashEntry* entry)
+{
+    ptrdiff_t index = entry - table->table;
+    ASSERT(index >= 0 && index < 64);
+    return static_cast<uint64_t>(1) << index;
+}
+
+void JSGlobalObject::getOwnPropertyNames(ExecState* exec, PropertyNameArray& propertyNames, EnumerationMode mode)
+{
+    JSVariableObject::getOwnPropertyNames(exec, propertyNames, mode);
+
+    // Global functions that have not been created yet are own properties all the same.
+    const HashTable* table = ExecState::globalObjectTable(exec);
+    table->initializeIfNeeded(exec);
+    for (int i = 0; i < table->compactSize; ++i) {
+        const HashEntry* entry = &table->table[i];
+        if (!entry->key() || (d()->takenGlobalFunctions & globalFunctionBit(table, entry)))
+            continue;
+        if (!(entry->attributes() & DontEnum) || (mode == IncludeDontEnumProperties))
+            propertyNames.add(entry->key());
+    }
+}
+
+const HashEntry* JSGlobalObject::takeGlobalFunction(ExecState* exec, const Identifier& propertyName)
+{
+    const HashTable* table = ExecState::globalObjectTable(exec);
+    const HashEntry* entry = table->entry(exec, propertyName);
+    if (!entry)
+        return 0;
+
+    uint64_t bit = globalFunctionBit(table, entry);
+    if (d()->takenGlobalFunctions & bit)
+        return 0;
+    d()->takenGlobalFunctions |= bit;
+    return entry;
+}
+
+bool JSGlobalObject::materializeGlobalFunction(ExecState* exec, const Identifier& propertyName)
+{
+    const HashEntry* entry = takeGlobalFunction(exec, propertyName);
+    if (!entry)
+        return false;
+
+    // Use this global object's function structure, not the lexical one; the lookup may come from another frame.
+    ASSERT(entry->attributes() & Function);
+    putDirectFunction(propertyName, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), entry->functionLength(), propertyName, entry->function()), entry->attributes());
+    return true;
 }
 
 static inline JSObject* lastInPrototypeChain(JSObject* object)
@@ -327,20 +414,10 @@ void JSGlobalObject::reset(JSValue prototype)
 
     addStaticGlobals(staticGlobals, sizeof(staticGlobals) / sizeof(GlobalPropertyInfo));
 
-    // Set global functions.
+    // Set global functions. The others in globalObjectTable are created when first looked up.
 
     d()->evalFunction = new (exec) GlobalEvalFunction(exec, GlobalEvalFunction::createStructure(d()->functionPrototype), 1, exec->propertyNames().eval, globalFuncEval, this);
     putDirectFunctionWithoutTransition(exec, d()->evalFunction, DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 2, Identifier(exec, "parseInt"), globalFuncParseInt), DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "parseFloat"), globalFuncParseFloat), DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "isNaN"), globalFuncIsNaN), DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "isFinite"), globalFuncIsFinite), DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "escape"), globalFuncEscape), DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "unescape"), globalFuncUnescape), DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "decodeURI"), globalFuncDecodeURI), DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "decodeURIComponent"), globalFuncDecodeURIComponent), DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "encodeURI"), globalFuncEncodeURI), DontEnum);
-    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "encodeURIComponent"), globalFuncEncodeURIComponent), DontEnum);
 #ifndef NDEBUG
     putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, d()->prototypeFunctionStructure.get(), 1, Identifier(exec, "jscprint"), globalFuncJSCPrint), DontEnum);
 #endif
@@ -22,6 +22,7 @@
 #ifndef JSGlobalObject_h
 #define JSGlobalObject_h
 
+#include "EvalCodeCache.h"
 #include "JSArray.h"
 #include "JSGlobalData.h"
 #include "JSVariableObject.h"
@@ -41,6 +42,7 @@ namespace JSC {
     class FunctionPrototype;
     class GlobalCodeBlock;
     class GlobalEvalFunction;
+    class HashEntry;
     class NativeErrorConstructor;
     class ProgramCodeBlock;
     class PrototypeFunction;
@@ -90,6 +92,8 @@ namespace JSC {
                 , datePrototype(0)
                 , regExpPrototype(0)
                 , methodCallDummy(0)
+                , takenGlobalFunctions(0)
+                , evalCodeCache(EvalCodeCache::defaultGlobalCapacity)
             {
             }
             
@@ -147,12 +151,20 @@ namespace JSC {
             RefPtr<Structure> regExpStructure;
             RefPtr<Structure> stringObjectStructure;
 
+            // One bit per globalObjectTable slot, set once that global function has been
+            // created, assigned, redefined or deleted. See takeGlobalFunction().
+            uint64_t takenGlobalFunctions;
+
             SymbolTable symbolTable;
             unsigned profileGroup;
 
             RefPtr<JSGlobalData> globalData;
 
             HashSet<GlobalCodeBlock*> codeBlocks;
+
+            // Compiled code of evals made at global scope, shared by all code blocks
+            // running in this global object.
+            EvalCodeCache evalCodeCache;
         };
 
     public:
@@ -181,6 +193,8 @@ namespace JSC {
         virtual bool hasOwnPropertyForWrite(ExecState*, const Identifier&);
         virtual void put(ExecState*, const Identifier&, JSValue, PutPropertySlot&);
         virtual void putWithAttributes(ExecState*, const Identifier& propertyName, JSValue value, unsigned attributes);
+        virtual bool deleteProperty(ExecState*, const Identifier& propertyName);
+        virtual void getOwnPropertyNames(ExecState*, PropertyNameArray&, EnumerationMode mode = ExcludeDontEnumProperties);
 
         virtual void defineGetter(ExecState*, const Identifier& propertyName, JSObject* getterFunc, unsigned attributes);
         virtual void defineSetter(ExecState*, const Identifier& propertyName, JSObject* setterFunc, unsigned attributes);
@@ -256,6 +270,7 @@ namespace JSC {
         virtual bool isDynamicScope() const;
 
         HashSet<GlobalCodeBlock*>& codeBlocks() { return d()->codeBlocks; }
+        EvalCodeCache& evalCodeCache() { return d()->evalCodeCache; }
 
         void copyGlobalsFrom(RegisterFile&);
         void copyGlobalsTo(RegisterFile&);
@@ -297,6 +312,12 @@ namespace JSC {
 
         void setRegisters(Register* registers, Register* registerArray, size_t count);
 
+        // The global functions in globalObjectTable (parseInt, escape, encodeURI and so on)
+        // are created the first time they are looked up rather than by reset(). Each entry
+        // can be taken once; after that the property lives in the object like any other.
+        const HashEntry* takeGlobalFunction(ExecState*, const Identifier& propertyName);
+        bool materializeGlobalFunction(ExecState*, const Identifier& propertyName);
+
         void* operator new(size_t); // can only be allocated with JSGlobalData
     };
 
@@ -336,14 +357,18 @@ namespace JSC {
     {
         if (JSVariableObject::getOwnPropertySlot(exec, propertyName, slot))
             return true;
-        return symbolTableGet(propertyName, slot);
+        if (symbolTableGet(propertyName, slot))
+            return true;
+        return materializeGlobalFunction(exec, propertyName) && JSVariableObject::getOwnPropertySlot(exec, propertyName, slot);
     }
 
     inline bool JSGlobalObject::getOwnPropertyDescriptor(ExecState* exec, const Identifier& propertyName, PropertyDescriptor& descriptor)
     {
         if (symbolTableGet(propertyName, descriptor))
             return true;
-        return JSVariableObject::getOwnPropertyDescriptor(exec, propertyName, descriptor);
+        if (JSVariableObject::getOwnPropertyDescriptor(exec, propertyName, descriptor))
+            return true;
+        return materializeGlobalFunction(exec, propertyName) && JSVariableObject::getOwnPropertyDescriptor(exec, propertyName, descriptor);
     }
 
     inline bool JSGlobalObject::hasOwnPropertyForWrite(ExecState* exec, const Identifier& propertyName)
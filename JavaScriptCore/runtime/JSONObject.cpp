@@ -30,7 +30,7 @@
 #include "Error.h"
 #include "ExceptionHelpers.h"
 #include "JSArray.h"
-#include "LiteralParser.h"
+#include "JSONParser.h"
 #include "PropertyNameArray.h"
 #include "StringBuilder.h"
 #include <wtf/MathExtras.h>
@@ -91,6 +91,8 @@ private:
     friend class Holder;
 
     static void appendQuotedString(StringBuilder&, const UString&);
+    static void appendQuotedString(StringBuilder&, JSString*);
+    static void appendEscapedCharacters(StringBuilder&, const UChar*, int length);
 
     JSValue toJSON(JSValue, const PropertyNameForFunctionCall&);
 
@@ -279,8 +281,23 @@ void Stringifier::appendQuotedString(StringBuilder& builder, const UString& valu
     builder.reserveCapacity(builder.size() + length + 2 + 8);
 
     builder.append('"');
+    appendEscapedCharacters(builder, value.data(), length);
+    builder.append('"');
+}
+
+void Stringifier::appendQuotedString(StringBuilder& builder, JSString* value)
+{
+    builder.reserveCapacity(builder.size() + value->length() + 2 + 8);
 
-    const UChar* data = value.data();
+    // Escape a rope fiber by fiber, rather than resolving it first.
+    builder.append('"');
+    for (JSString::RopeIterator iterator(value); !iterator.atEnd(); iterator.advance())
+        appendEscapedCharacters(builder, iterator.characters(), iterator.length());
+    builder.append('"');
+}
+
+void Stringifier::appendEscapedCharacters(StringBuilder& builder, const UChar* data, int length)
+{
     for (int i = 0; i < length; ++i) {
         int start = i;
         while (i < length && (data[i] > 0x1F && data[i] != '"' && data[i] != '\\'))
@@ -325,8 +342,6 @@ void Stringifier::appendQuotedString(StringBuilder& builder, const UString& valu
                 break;
         }
     }
-
-    builder.append('"');
 }
 
 inline JSValue Stringifier::toJSON(JSValue value, const PropertyNameForFunctionCall& propertyName)
@@ -387,9 +402,8 @@ Stringifier::StringifyResult Stringifier::appendStringifiedValue(StringBuilder&
         return StringifySucceeded;
     }
 
-    UString stringValue;
-    if (value.getString(m_exec, stringValue)) {
-        appendQuotedString(builder, stringValue);
+    if (value.isString()) {
+        appendQuotedString(builder, asString(value));
         return StringifySucceeded;
     }
 
@@ -841,8 +855,8 @@ JSValue JSC_HOST_CALL JSONProtoFuncParse(ExecState* exec, JSObject*, JSValue, co
     if (exec->hadException())
         return jsNull();
     
-    LiteralParser jsonParser(exec, source, LiteralParser::StrictJSON);
-    JSValue unfiltered = jsonParser.tryLiteralParse();
+    JSONParser jsonParser(exec, source);
+    JSValue unfiltered = jsonParser.parse();
     if (!unfiltered)
         return throwError(exec, SyntaxError, "Unable to parse JSON string");
     
@@ -0,0 +1,478 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "JSONParser.h"
+
+#include "JSArray.h"
+#include "JSGlobalObject.h"
+#include "JSString.h"
+#include "Lexer.h"
+#include <wtf/ASCIICType.h>
+#include <wtf/dtoa.h>
+
+namespace JSC {
+
+// The characters that may appear unescaped in a string; matches LiteralParser's StrictJSON mode.
+static inline bool isSafeStringCharacter(UChar c)
+{
+    return (c >= ' ' && c != '\\' && c != '"') || c == '\t';
+}
+
+// Finds the end of a run of characters that can be copied out of a string as they are.
+// Nearly every character of a typical string is in such a run, so this loop is kept free
+// of anything but the end check and the test of the character.
+static inline const UChar* scanStringRun(const UChar* ptr, const UChar* end)
+{
+    while (ptr < end && isSafeStringCharacter(*ptr))
+        ++ptr;
+    return ptr;
+}
+
+static const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
+JSONParser::JSONParser(ExecState* exec, const UString& source)
+    : m_exec(exec)
+    , m_source(source)
+    , m_ptr(source.data())
+    , m_end(source.data() + source.size())
+{
+}
+
+JSONParser::~JSONParser()
+{
+}
+
+inline void JSONParser::skipWhitespace()
+{
+    while (m_ptr < m_end && isASCIISpace(*m_ptr))
+        ++m_ptr;
+}
+
+JSValue JSONParser::parse()
+{
+    JSValue value;
+    while (true) {
+        skipWhitespace();
+        if (m_ptr >= m_end)
+            return JSValue();
+
+        switch (*m_ptr) {
+            case '[': {
+                ++m_ptr;
+                skipWhitespace();
+                if (m_ptr < m_end && *m_ptr == ']') {
+                    ++m_ptr;
+                    value = constructEmptyArray(m_exec);
+                    break;
+                }
+                Frame frame = { false, m_values.size(), m_keys.size(), 0 };
+                m_frames.append(frame);
+                continue;
+            }
+            case '{': {
+                ++m_ptr;
+                skipWhitespace();
+                if (m_ptr < m_end && *m_ptr == '}') {
+                    ++m_ptr;
+                    value = constructEmptyObject(m_exec);
+                    break;
+                }
+                StructureCacheEntry* shape = (!m_frames.isEmpty() && !m_frames.last().isObject) ? m_frames.last().shape : 0;
+                Frame frame = { true, m_values.size(), m_keys.size(), shape };
+                m_frames.append(frame);
+                if (!parseKey(m_frames.last()))
+                    return JSValue();
+                continue;
+            }
+            case '"':
+                value = parseStringValue();
+                if (!value)
+                    return JSValue();
+                break;
+            case 't':
+                if (m_end - m_ptr < 4 || m_ptr[1] != 'r' || m_ptr[2] != 'u' || m_ptr[3] != 'e')
+                    return JSValue();
+                m_ptr += 4;
+                value = jsBoolean(true);
+                break;
+            case 'f':
+                if (m_end - m_ptr < 5 || m_ptr[1] != 'a' || m_ptr[2] != 'l' || m_ptr[3] != 's' || m_ptr[4] != 'e')
+                    return JSValue();
+                m_ptr += 5;
+                value = jsBoolean(false);
+                break;
+            case 'n':
+                if (m_end - m_ptr < 4 || m_ptr[1] != 'u' || m_ptr[2] != 'l' || m_ptr[3] != 'l')
+                    return JSValue();
+                m_ptr += 4;
+                value = jsNull();
+                break;
+            case '-':
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+                value = parseNumber();
+                if (!value)
+                    return JSValue();
+                break;
+            default:
+                return JSValue();
+        }
+
+        // Add the value to the array or object that contains it, and build each of the
+        // containers that it completes.
+        while (true) {
+            if (m_frames.isEmpty()) {
+                skipWhitespace();
+                if (m_ptr != m_end)
+                    return JSValue();
+                return value;
+            }
+
+            m_values.append(value);
+            skipWhitespace();
+            if (m_ptr >= m_end)
+                return JSValue();
+
+            Frame& frame = m_frames.last();
+            UChar c = *m_ptr++;
+            if (c == ',') {
+                if (frame.isObject && !parseKey(frame))
+                    return JSValue();
+                break;
+            }
+            if (c != (frame.isObject ? '}' : ']'))
+                return JSValue();
+
+            if (!frame.isObject) {
+                value = createArray(frame);
+                m_frames.removeLast();
+                continue;
+            }
+            value = createObject(frame);
+            StructureCacheEntry* shape = frame.shape;
+            m_frames.removeLast();
+            if (!m_frames.isEmpty() && !m_frames.last().isObject)
+                m_frames.last().shape = shape;
+        }
+    }
+}
+
+bool JSONParser::parseKey(Frame& frame)
+{
+    skipWhitespace();
+    if (m_ptr >= m_end || *m_ptr != '"')
+        return false;
+
+    const UChar* start = ++m_ptr;
+    m_ptr = scanStringRun(m_ptr, m_end);
+    if (m_ptr < m_end && *m_ptr == '"') {
+        int length = m_ptr - start;
+        ++m_ptr;
+
+        // Objects in a list usually have the same keys as the one before, so check for
+        // that before hashing the key to look it up in the identifier table.
+        size_t index = m_keys.size() - frame.keysStart;
+        StructureCacheEntry* shape = frame.shape;
+        if (shape && index < shape->keys.size()) {
+            const UString& expected = shape->keys[index].ustring();
+            if (expected.size() == length && !memcmp(expected.data(), start, length * sizeof(UChar)))
+                m_keys.append(shape->keys[index]);
+            else
+                m_keys.append(Identifier(m_exec, start, length));
+        } else
+            m_keys.append(Identifier(m_exec, start, length));
+    } else {
+        UString key;
+        if (!parseEscapedString(start, key))
+            return false;
+        m_keys.append(Identifier(m_exec, key));
+    }
+
+    skipWhitespace();
+    if (m_ptr >= m_end || *m_ptr != ':')
+        return false;
+    ++m_ptr;
+    return true;
+}
+
+JSValue JSONParser::parseStringValue()
+{
+    ASSERT(*m_ptr == '"');
+    const UChar* start = ++m_ptr;
+    m_ptr = scanStringRun(m_ptr, m_end);
+    if (m_ptr < m_end && *m_ptr == '"') {
+        int length = m_ptr - start;
+        ++m_ptr;
+        if (!length)
+            return jsEmptyString(m_exec);
+        if (length == 1)
+            return jsSingleCharacterString(m_exec, *start);
+        return jsNontrivialString(m_exec, UString(start, length));
+    }
+
+    UString string;
+    if (!parseEscapedString(start, string))
+        return JSValue();
+    return jsString(m_exec, string);
+}
+
+// Called with m_ptr at the first character after runStart that could not be copied as it
+// is; finishes the string, leaving m_ptr after the closing quote.
+bool JSONParser::parseEscapedString(const UChar* runStart, UString& result)
+{
+    Vector<UChar, 64> buffer;
+    buffer.append(runStart, m_ptr - runStart);
+    while (true) {
+        if (m_ptr >= m_end)
+            return false;
+        if (*m_ptr == '"')
+            break;
+        if (*m_ptr != '\\')
+            return false;
+
+        if (++m_ptr >= m_end)
+            return false;
+        switch (*m_ptr) {
+            case '"':
+            case '\\':
+            case '/':
+                buffer.append(*m_ptr++);
+                break;
+            case 'b':
+                buffer.append('\b');
+                ++m_ptr;
+                break;
+            case 'f':
+                buffer.append('\f');
+                ++m_ptr;
+                break;
+            case 'n':
+                buffer.append('\n');
+                ++m_ptr;
+                break;
+            case 'r':
+                buffer.append('\r');
+                ++m_ptr;
+                break;
+            case 't':
+                buffer.append('\t');
+                ++m_ptr;
+                break;
+            case 'u':
+                if ((m_end - m_ptr) < 5) // uNNNN == 5 characters
+                    return false;
+                for (int i = 1; i < 5; i++) {
+                    if (!isASCIIHexDigit(m_ptr[i]))
+                        return false;
+                }
+                buffer.append(JSC::Lexer::convertUnicode(m_ptr[1], m_ptr[2], m_ptr[3], m_ptr[4]));
+                m_ptr += 5;
+                break;
+            default:
+                return false;
+        }
+
+        const UChar* start = m_ptr;
+        m_ptr = scanStringRun(m_ptr, m_end);
+        buffer.append(start, m_ptr - start);
+    }
+
+    ++m_ptr;
+    result = UString::adopt(buffer);
+    return true;
+}
+
+JSValue JSONParser::parseNumber()
+{
+    // -?(0 | [1-9][0-9]*) ('.' [0-9]+)? ([eE][+-]? [0-9]+)?
+    const UChar* start = m_ptr;
+    bool negative = *m_ptr == '-';
+    if (negative)
+        ++m_ptr;
+
+    if (m_ptr < m_end && *m_ptr == '0')
+        ++m_ptr;
+    else if (m_ptr < m_end && *m_ptr >= '1' && *m_ptr <= '9') {
+        ++m_ptr;
+        while (m_ptr < m_end && isASCIIDigit(*m_ptr))
+            ++m_ptr;
+    } else
+        return JSValue();
+
+    // Most numbers in JSON data are integers short enough to be exact in an int,
+    // and need no conversion through strtod.
+    if (m_ptr - start <= 9 && (m_ptr >= m_end || (*m_ptr != '.' && *m_ptr != 'e' && *m_ptr != 'E'))) {
+        int result = 0;
+        for (const UChar* digit = negative ? start + 1 : start; digit < m_ptr; ++digit)
+            result = result * 10 + (*digit - '0');
+        if (!negative)
+            return jsNumber(m_exec, result);
+        if (!result)
+            return jsNumber(m_exec, -0.0);
+        return jsNumber(m_exec, -result);
+    }
+
+    if (m_ptr < m_end && *m_ptr == '.') {
+        const UChar* point = m_ptr++;
+        if (m_ptr >= m_end || !isASCIIDigit(*m_ptr))
+            return JSValue();
+        ++m_ptr;
+        while (m_ptr < m_end && isASCIIDigit(*m_ptr))
+            ++m_ptr;
+
+        // A decimal fraction of up to 15 digits is an exactly representable integer divided
+        // by an exactly representable power of ten, so one division gives the correctly
+        // rounded result.
+        if (m_ptr - start <= 16 && (m_ptr >= m_end || (*m_ptr != 'e' && *m_ptr != 'E'))) {
+            double mantissa = 0;
+            for (const UChar* digit = negative ? start + 1 : start; digit < m_ptr; ++digit) {
+                if (digit != point)
+                    mantissa = mantissa * 10 + (*digit - '0');
+            }
+            double result = mantissa / powersOfTen[m_ptr - point - 1];
+            return jsNumber(m_exec, negative ? -result : result);
+        }
+    }
+
+    if (m_ptr < m_end && (*m_ptr == 'e' || *m_ptr == 'E')) {
+        ++m_ptr;
+        if (m_ptr < m_end && (*m_ptr == '-' || *m_ptr == '+'))
+            ++m_ptr;
+        if (m_ptr >= m_end || !isASCIIDigit(*m_ptr))
+            return JSValue();
+        ++m_ptr;
+        while (m_ptr < m_end && isASCIIDigit(*m_ptr))
+            ++m_ptr;
+    }
+
+    int length = m_ptr - start;
+    Vector<char, 64> buffer(length + 1);
+    for (int i = 0; i < length; ++i)
+        buffer[i] = static_cast<char>(start[i]);
+    buffer[length] = 0;
+    return jsNumber(m_exec, WTF::strtod(buffer.data(), 0));
+}
+
+JSValue JSONParser::createArray(const Frame& frame)
+{
+    size_t length = m_values.size() - frame.valuesStart;
+    JSArray* array = constructArray(m_exec, ArgList(m_values.begin() + frame.valuesStart, length));
+    while (m_values.size() > frame.valuesStart)
+        m_values.removeLast();
+    return array;
+}
+
+JSValue JSONParser::createObject(Frame& frame)
+{
+    size_t count = m_keys.size() - frame.keysStart;
+    ASSERT(count == m_values.size() - frame.valuesStart);
+
+    StructureCacheEntry* shape = frame.shape;
+    if (!shape || !hasKeys(shape, frame.keysStart)) {
+        unsigned hash = 0;
+        for (size_t i = 0; i < count; ++i)
+            hash = hash * 31 + m_keys[frame.keysStart + i].ustring().rep()->existingHash();
+        shape = m_structureCache[hash % structureCacheSize].get();
+        if (shape && !hasKeys(shape, frame.keysStart))
+            shape = 0;
+
+        if (!shape) {
+            JSObject* object = constructEmptyObject(m_exec);
+            for (size_t i = 0; i < count; ++i)
+                object->putDirect(m_keys[frame.keysStart + i], m_values.at(frame.valuesStart + i));
+            frame.shape = addShape(frame.keysStart, hash, object->structure());
+            m_keys.shrink(frame.keysStart);
+            while (m_values.size() > frame.valuesStart)
+                m_values.removeLast();
+            return object;
+        }
+    }
+
+    // The keys have been seen before in this order, so the object can be given its final
+    // Structure at once and its values stored straight into place.
+    JSObject* object = constructEmptyObject(m_exec);
+    Structure* structure = shape->structure.get();
+    if (structure->propertyStorageCapacity() != JSObject::inlineStorageCapacity)
+        object->allocatePropertyStorage(JSObject::inlineStorageCapacity, structure->propertyStorageCapacity());
+    object->setStructure(structure);
+    for (size_t i = 0; i < count; ++i)
+        object->putDirectOffset(shape->offsets[i], m_values.at(frame.valuesStart + i));
+    frame.shape = shape;
+
+    m_keys.shrink(frame.keysStart);
+    while (m_values.size() > frame.valuesStart)
+        m_values.removeLast();
+    return object;
+}
+
+bool JSONParser::hasKeys(const StructureCacheEntry* shape, size_t keysStart) const
+{
+    size_t count = m_keys.size() - keysStart;
+    if (shape->keys.size() != count)
+        return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (shape->keys[i] != m_keys[keysStart + i])
+            return false;
+    }
+    return true;
+}
+
+JSONParser::StructureCacheEntry* JSONParser::addShape(size_t keysStart, unsigned hash, Structure* structure)
+{
+    // Dictionaries are changed in place, and a repeated key leaves the object with fewer
+    // properties than keys; neither can be reused.
+    size_t count = m_keys.size() - keysStart;
+    if (structure->isDictionary() || structure->propertyStorageSize() != count)
+        return 0;
+
+    // Entries are overwritten rather than freed, because open frames may still point at them.
+    OwnPtr<StructureCacheEntry>& slot = m_structureCache[hash % structureCacheSize];
+    if (!slot)
+        slot.set(new StructureCacheEntry);
+    StructureCacheEntry* shape = slot.get();
+
+    shape->keys.clear();
+    shape->offsets.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const Identifier& key = m_keys[keysStart + i];
+        shape->keys.append(key);
+        shape->offsets.append(structure->get(key));
+    }
+    shape->structure = structure;
+    return shape;
+}
+
+} // namespace JSC
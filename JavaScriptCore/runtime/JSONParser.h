@@ -0,0 +1,96 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JSONParser_h
+#define JSONParser_h
+
+#include "ArgList.h"
+#include "Identifier.h"
+#include "JSValue.h"
+#include "Structure.h"
+#include "UString.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    // The parser behind JSON.parse. It reads the source characters directly rather than
+    // going through tokens, and builds each object or array only once all of its members
+    // are known: arrays are created at their final length, and objects take a Structure
+    // straight from a cache keyed by their property names, so a list of records with the
+    // same fields goes through the transition chain once instead of once per record.
+    // Accepts the same language as LiteralParser in StrictJSON mode.
+    class JSONParser : public Noncopyable {
+    public:
+        JSONParser(ExecState*, const UString&);
+        ~JSONParser();
+
+        // Returns an empty JSValue if the source is not valid JSON.
+        JSValue parse();
+
+    private:
+        struct StructureCacheEntry {
+            Vector<Identifier, 8> keys;
+            Vector<size_t, 8> offsets;
+            RefPtr<Structure> structure;
+        };
+
+        struct Frame {
+            bool isObject;
+            size_t valuesStart;
+            size_t keysStart;
+            // For an object, the shape its keys are expected to follow; for an array, the
+            // shape of its most recent object element, which the next one is likely to share.
+            StructureCacheEntry* shape;
+        };
+
+        void skipWhitespace();
+        bool parseKey(Frame&);
+        JSValue parseStringValue();
+        bool parseEscapedString(const UChar* runStart, UString&);
+        JSValue parseNumber();
+
+        JSValue createArray(const Frame&);
+        JSValue createObject(Frame&);
+        bool hasKeys(const StructureCacheEntry*, size_t keysStart) const;
+        StructureCacheEntry* addShape(size_t keysStart, unsigned hash, Structure*);
+
+        static const unsigned structureCacheSize = 64;
+
+        ExecState* m_exec;
+        UString m_source;
+        const UChar* m_ptr;
+        const UChar* m_end;
+
+        Vector<Frame, 16> m_frames;
+        Vector<Identifier, 32> m_keys;
+        MarkedArgumentBuffer m_values;
+        OwnPtr<StructureCacheEntry> m_structureCache[structureCacheSize];
+    };
+
+} // namespace JSC
+
+#endif // JSONParser_h
@@ -181,7 +181,11 @@ namespace JSC {
 
         // Fast access to known property offsets.
         JSValue getDirectOffset(size_t offset) const { return JSValue::decode(propertyStorage()[offset]); }
-        void putDirectOffset(size_t offset, JSValue value) { propertyStorage()[offset] = JSValue::encode(value); }
+        void putDirectOffset(size_t offset, JSValue value)
+        {
+            propertyStorage()[offset] = JSValue::encode(value);
+            Heap::writeBarrier(this, value);
+        }
 
         void fillGetterPropertySlot(PropertySlot&, JSValue* location);
 
@@ -221,6 +225,7 @@ namespace JSC {
         {
             ASSERT(index < m_structure->anonymousSlotCount());
             *locationForOffset(index) = value;
+            Heap::writeBarrier(this, value);
         }
         JSValue getAnonymousValue(unsigned index) const
         {
@@ -311,6 +316,7 @@ inline void JSObject::setPrototype(JSValue prototype)
     ASSERT(prototype);
     RefPtr<Structure> newStructure = Structure::changePrototypeTransition(m_structure, prototype);
     setStructure(newStructure.release());
+    Heap::writeBarrier(this, prototype);
 }
 
 inline void JSObject::setStructure(NonNullPassRefPtr<Structure> structure)
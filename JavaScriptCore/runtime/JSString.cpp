@@ -31,6 +31,33 @@
 
 namespace JSC {
 
+// Fibers shorter than this are copied together when a rope is balanced.
+static const unsigned balancedRopeLeafLength = 512;
+
+#if DUMP_ROPE_STATISTICS
+
+static unsigned numRopesResolved;
+static unsigned long long numCharactersResolved;
+static unsigned numRopesBalanced;
+static unsigned numRopeReads;
+
+struct RopeStatisticsExitLogger {
+    ~RopeStatisticsExitLogger();
+};
+
+static RopeStatisticsExitLogger logger;
+
+RopeStatisticsExitLogger::~RopeStatisticsExitLogger()
+{
+    printf("\nJSC::JSString rope statistics\n\n");
+    printf("%u ropes resolved\n", numRopesResolved);
+    printf("%llu characters copied resolving ropes\n", numCharactersResolved);
+    printf("%u ropes balanced\n", numRopesBalanced);
+    printf("%u reads from unresolved ropes\n", numRopeReads);
+}
+
+#endif
+
 void JSString::Rope::destructNonRecursive()
 {
     Vector<Rope*, 32> workQueue;
@@ -80,6 +107,11 @@ void JSString::resolveRope(ExecState* exec) const
 {
     ASSERT(isRope());
 
+#if DUMP_ROPE_STATISTICS
+    ++numRopesResolved;
+    numCharactersResolved += m_stringLength;
+#endif
+
     // Allocate the buffer to hold the final string, position initially points to the end.
     UChar* buffer;
     if (PassRefPtr<UStringImpl> newImpl = UStringImpl::tryCreateUninitialized(m_stringLength, buffer))
@@ -139,6 +171,388 @@ void JSString::resolveRope(ExecState* exec) const
     }
 }
 
+JSString::RopeIterator::RopeIterator(JSString* string, unsigned offset)
+    : m_offset(offset)
+    , m_string(0)
+    , m_characters(0)
+    , m_length(0)
+{
+    if (!string->isRope()) {
+        if (offset < string->m_stringLength) {
+            m_string = string->m_value.rep();
+            m_characters = string->m_value.data() + offset;
+            m_length = string->m_stringLength - offset;
+        }
+        return;
+    }
+
+    for (unsigned i = string->m_ropeLength; i--; )
+        m_workQueue.append(string->m_fibers[i]);
+    advance();
+}
+
+void JSString::RopeIterator::advance()
+{
+    while (!m_workQueue.isEmpty()) {
+        Rope::Fiber fiber = m_workQueue.last();
+        m_workQueue.removeLast();
+
+        // Skip whole fibers that end before the starting offset, and empty strings.
+        unsigned length = fiber.length();
+        if (m_offset >= length) {
+            m_offset -= length;
+            continue;
+        }
+
+        if (fiber.isRope()) {
+            Rope* rope = fiber.rope();
+            for (unsigned i = rope->ropeLength(); i--; )
+                m_workQueue.append(rope->fibers(i));
+            continue;
+        }
+
+        m_string = fiber.string();
+        m_characters = m_string->data() + m_offset;
+        m_length = length - m_offset;
+        m_offset = 0;
+        return;
+    }
+
+    m_string = 0;
+    m_characters = 0;
+    m_length = 0;
+}
+
+static void copyCharacters(UChar* buffer, JSString::Rope::Fiber fiber)
+{
+    Vector<JSString::Rope::Fiber, 32> workQueue;
+    workQueue.append(fiber);
+    while (!workQueue.isEmpty()) {
+        fiber = workQueue.last();
+        workQueue.removeLast();
+        if (fiber.isRope()) {
+            JSString::Rope* rope = fiber.rope();
+            for (unsigned i = rope->ropeLength(); i--; )
+                workQueue.append(rope->fibers(i));
+            continue;
+        }
+        UString::Rep* string = fiber.string();
+        UStringImpl::copyChars(buffer, string->data(), string->size());
+        buffer += string->size();
+    }
+}
+
+// Rebuilds a rope with the algorithm from Boehm, Atkinson and Plass, "Ropes: an Alternative
+// to Strings". Subtrees are added from left to right to a forest of balanced ropes, one for
+// each range of lengths between successive Fibonacci numbers. Subtrees that are balanced
+// already are added whole, so the work done is in proportion to the part of the rope that
+// has been built since it was last balanced.
+class RopeBalancer : public Noncopyable {
+public:
+    typedef JSString::Rope Rope;
+
+    RopeBalancer()
+        : m_failed(false)
+    {
+    }
+
+    ~RopeBalancer()
+    {
+        for (unsigned i = 0; i < forestSize; ++i) {
+            if (m_forest[i].nonFiber())
+                m_forest[i].deref();
+        }
+    }
+
+    static bool isBalanced(Rope::Fiber fiber)
+    {
+        if (fiber.isString())
+            return true;
+        unsigned depth = fiber.rope()->depth();
+        return depth < forestSize && fiber.length() / lengthUnit >= minimumBalancedLength[depth];
+    }
+
+    void add(Rope::Fiber fiber)
+    {
+        unsigned length = fiber.length() / lengthUnit;
+        Rope::Fiber tooShort;
+        unsigned i = 0;
+        for (; i + 1 < forestSize && length >= minimumBalancedLength[i + 1]; ++i) {
+            if (m_forest[i].nonFiber()) {
+                tooShort = concatenate(m_forest[i], tooShort);
+                m_forest[i] = Rope::Fiber();
+            }
+        }
+
+        Rope::Fiber insertee = concatenate(tooShort, fiber.ref());
+        for (; ; ++i) {
+            if (m_forest[i].nonFiber()) {
+                insertee = concatenate(m_forest[i], insertee);
+                m_forest[i] = Rope::Fiber();
+            }
+            if (i + 1 == forestSize || insertee.length() / lengthUnit < minimumBalancedLength[i + 1]) {
+                m_forest[i] = insertee;
+                return;
+            }
+        }
+    }
+
+    // Adds the characters of several short fibers as one string.
+    void addCopy(const Vector<Rope::Fiber, 32>& fibers, unsigned length)
+    {
+        if (fibers.size() == 1 && fibers[0].isString()) {
+            add(fibers[0]);
+            return;
+        }
+
+        UChar* buffer;
+        RefPtr<UStringImpl> string = UStringImpl::tryCreateUninitialized(length, buffer);
+        if (!string) {
+            m_failed = true;
+            return;
+        }
+        for (size_t i = 0; i < fibers.size(); ++i) {
+            copyCharacters(buffer, fibers[i]);
+            buffer += fibers[i].length();
+        }
+        add(string.get());
+    }
+
+    // Returns a new reference to the balanced rope, or a null Fiber if memory ran out.
+    Rope::Fiber release()
+    {
+        Rope::Fiber result;
+        for (unsigned i = 0; i < forestSize; ++i) {
+            if (m_forest[i].nonFiber()) {
+                result = concatenate(m_forest[i], result);
+                m_forest[i] = Rope::Fiber();
+            }
+        }
+        if (m_failed && result.nonFiber()) {
+            result.deref();
+            return Rope::Fiber();
+        }
+        return result;
+    }
+
+private:
+    // Lengths are measured in half leaves, since leaves are rarely shorter than that.
+    static const unsigned lengthUnit = balancedRopeLeafLength / 2;
+    static const unsigned forestSize = 45;
+    static const unsigned minimumBalancedLength[forestSize];
+
+    // Takes ownership of both fibers, either of which may be null.
+    Rope::Fiber concatenate(Rope::Fiber left, Rope::Fiber right)
+    {
+        if (!left.nonFiber())
+            return right;
+        if (!right.nonFiber())
+            return left;
+
+        RefPtr<Rope> rope = Rope::createOrNull(2);
+        if (!rope) {
+            m_failed = true;
+            left.deref();
+            return right;
+        }
+        unsigned index = 0;
+        rope->append(index, left);
+        rope->append(index, right);
+        left.deref();
+        right.deref();
+        return Rope::Fiber(rope.release().releaseRef());
+    }
+
+    Rope::Fiber m_forest[forestSize];
+    bool m_failed;
+};
+
+// Fibonacci numbers from F(2); a rope of depth n is balanced if it is at least F(n + 2) units long.
+const unsigned RopeBalancer::minimumBalancedLength[RopeBalancer::forestSize] = {
+    1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144, 233, 377, 610, 987, 1597, 2584, 4181, 6765, 10946,
+    17711, 28657, 46368, 75025, 121393, 196418, 317811, 514229, 832040, 1346269, 2178309,
+    3524578, 5702887, 9227465, 14930352, 24157817, 39088169, 63245986, 102334155, 165580141,
+    267914296, 433494437, 701408733, 1134903170, 1836311903
+};
+
+// Appending to a string in a loop adds a level to its rope every few iterations, leaving a
+// long chain for anything that walks it. Runs of short fibers are copied into a single
+// string on the way, so the rope does not end up with a leaf for every append.
+void JSString::balanceRope()
+{
+    ASSERT(m_ropeLength == 1 && m_fibers[0].isRope());
+
+#if DUMP_ROPE_STATISTICS
+    ++numRopesBalanced;
+#endif
+
+    RopeBalancer balancer;
+    Vector<Rope::Fiber, 32> workQueue;
+    Vector<Rope::Fiber, 32> run;
+    unsigned runLength = 0;
+    workQueue.append(m_fibers[0]);
+    while (!workQueue.isEmpty()) {
+        Rope::Fiber fiber = workQueue.last();
+        workQueue.removeLast();
+
+        unsigned length = fiber.length();
+        if (!length)
+            continue;
+
+        if (length < balancedRopeLeafLength) {
+            if (runLength + length > balancedRopeLeafLength) {
+                balancer.addCopy(run, runLength);
+                run.shrink(0);
+                runLength = 0;
+            }
+            run.append(fiber);
+            runLength += length;
+            continue;
+        }
+
+        if (!RopeBalancer::isBalanced(fiber)) {
+            Rope* rope = fiber.rope();
+            for (unsigned i = rope->ropeLength(); i--; )
+                workQueue.append(rope->fibers(i));
+            continue;
+        }
+
+        if (runLength) {
+            balancer.addCopy(run, runLength);
+            run.shrink(0);
+            runLength = 0;
+        }
+        balancer.add(fiber);
+    }
+    if (runLength)
+        balancer.addCopy(run, runLength);
+
+    Rope::Fiber balanced = balancer.release();
+    if (!balanced.nonFiber())
+        return;
+    m_fibers[0].deref();
+    m_fibers[0] = balanced;
+}
+
+UChar JSString::ropeCharacterAt(unsigned index) const
+{
+    ASSERT(isRope());
+    ASSERT(index < m_stringLength);
+
+#if DUMP_ROPE_STATISTICS
+    ++numRopeReads;
+#endif
+
+    Rope::Fiber* fiber = m_fibers;
+    while (true) {
+        while (index >= fiber->length()) {
+            index -= fiber->length();
+            ++fiber;
+        }
+        if (fiber->isString())
+            return fiber->string()->data()[index];
+        fiber = &fiber->rope()->fibers(0);
+    }
+}
+
+JSValue JSString::substring(ExecState* exec, unsigned offset, unsigned length)
+{
+    ASSERT(offset <= m_stringLength);
+    ASSERT(length <= m_stringLength - offset);
+    if (!isRope())
+        return jsSubstring(exec, m_value, offset, length);
+    if (!length)
+        return jsEmptyString(exec);
+
+#if DUMP_ROPE_STATISTICS
+    ++numRopeReads;
+#endif
+
+    // A substring of a single fiber can share its buffer.
+    RopeIterator iterator(this, offset);
+    if (iterator.length() >= length)
+        return jsSubstring(exec, UString(iterator.string()), iterator.characters() - iterator.string()->data(), length);
+
+    UChar* buffer;
+    RefPtr<UStringImpl> string = UStringImpl::tryCreateUninitialized(length, buffer);
+    if (!string)
+        return throwOutOfMemoryError(exec);
+    for (unsigned remaining = length; remaining; iterator.advance()) {
+        ASSERT(!iterator.atEnd());
+        unsigned spanLength = std::min(iterator.length(), remaining);
+        UStringImpl::copyChars(buffer, iterator.characters(), spanLength);
+        buffer += spanLength;
+        remaining -= spanLength;
+    }
+    return jsNontrivialString(exec, UString(string.release()));
+}
+
+static inline int findInCharacters(const UChar* characters, unsigned length, const UChar* pattern, unsigned patternLength)
+{
+    if (length < patternLength)
+        return -1;
+    const UChar* end = characters + length - patternLength;
+    size_t restSize = (patternLength - 1) * sizeof(UChar);
+    for (const UChar* c = characters; c <= end; ++c) {
+        if (*c == pattern[0] && !memcmp(c + 1, pattern + 1, restSize))
+            return static_cast<int>(c - characters);
+    }
+    return -1;
+}
+
+int JSString::find(const UString& pattern, unsigned start)
+{
+    if (!isRope())
+        return m_value.find(pattern, start);
+
+    unsigned patternLength = pattern.size();
+    if (start > m_stringLength || patternLength > m_stringLength - start)
+        return -1;
+    if (!patternLength)
+        return start;
+
+#if DUMP_ROPE_STATISTICS
+    ++numRopeReads;
+#endif
+
+    // Matches within a span are found directly. Those that straddle spans are found by
+    // searching the tail of the text seen so far joined to the head of the next span.
+    const UChar* patternCharacters = pattern.data();
+    Vector<UChar, 32> tail;
+    Vector<UChar, 64> straddle;
+    unsigned position = start;
+    for (RopeIterator iterator(this, start); !iterator.atEnd(); iterator.advance()) {
+        const UChar* characters = iterator.characters();
+        unsigned length = iterator.length();
+
+        if (!tail.isEmpty()) {
+            straddle.shrink(0);
+            straddle.append(tail.data(), tail.size());
+            straddle.append(characters, std::min(length, patternLength - 1));
+            int match = findInCharacters(straddle.data(), straddle.size(), patternCharacters, patternLength);
+            if (match >= 0 && static_cast<unsigned>(match) < tail.size())
+                return position - tail.size() + match;
+        }
+
+        int match = findInCharacters(characters, length, patternCharacters, patternLength);
+        if (match >= 0)
+            return position + match;
+
+        // Keep the characters that a match continuing into the next span could start with.
+        if (length >= patternLength - 1) {
+            tail.shrink(0);
+            tail.append(characters + length - (patternLength - 1), patternLength - 1);
+        } else {
+            tail.append(characters, length);
+            if (tail.size() > patternLength - 1)
+                tail.remove(0, tail.size() - (patternLength - 1));
+        }
+        position += length;
+    }
+
+    return -1;
+}
+
 JSValue JSString::toPrimitive(ExecState*, PreferredPrimitiveType) const
 {
     return const_cast<JSString*>(this);
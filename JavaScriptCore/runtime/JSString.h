@@ -30,6 +30,12 @@
 #include "PropertyDescriptor.h"
 #include "PropertySlot.h"
 
+#ifndef NDEBUG
+#define DUMP_ROPE_STATISTICS 0
+#else
+#define DUMP_ROPE_STATISTICS 0
+#endif
+
 namespace JSC {
 
     class JSString;
@@ -114,6 +120,9 @@ namespace JSC {
                 bool isString() { return !isRope(); }
                 UString::Rep* string() { return reinterpret_cast<UString::Rep*>(m_value); }
 
+                unsigned length() { return isString() ? string()->size() : rope()->stringLength(); }
+                unsigned depth() { return isString() ? 0 : rope()->depth(); }
+
                 void* nonFiber() { return reinterpret_cast<void*>(m_value); }
             private:
                 intptr_t m_value;
@@ -136,6 +145,8 @@ namespace JSC {
             {
                 m_fibers[index++] = fiber;
                 m_stringLength += fiber.refAndGetLength();
+                if (fiber.depth() >= m_depth)
+                    m_depth = fiber.depth() + 1;
             }
             void append(unsigned &index, const UString& string)
             {
@@ -154,17 +165,42 @@ namespace JSC {
 
             unsigned ropeLength() { return m_ropeLength; }
             unsigned stringLength() { return m_stringLength; }
+            // The number of Ropes on the longest path from this one down to a string.
+            unsigned depth() { return m_depth; }
             Fiber& fibers(unsigned index) { return m_fibers[index]; }
 
         private:
-            Rope(unsigned ropeLength) : m_ropeLength(ropeLength), m_stringLength(0) {}
+            Rope(unsigned ropeLength) : m_ropeLength(ropeLength), m_stringLength(0), m_depth(1) {}
             void* operator new(size_t, void* inPlace) { return inPlace; }
             
             unsigned m_ropeLength;
             unsigned m_stringLength;
+            unsigned m_depth;
             Fiber m_fibers[1];
         };
 
+        // Visits the characters of a string as a sequence of contiguous spans, starting at
+        // a given offset. A rope is walked fiber by fiber rather than being resolved.
+        class RopeIterator {
+        public:
+            RopeIterator(JSString*, unsigned offset = 0);
+
+            bool atEnd() const { return !m_length; }
+            const UChar* characters() const { return m_characters; }
+            unsigned length() const { return m_length; }
+            // The string holding the current span.
+            UString::Rep* string() const { return m_string; }
+
+            void advance();
+
+        private:
+            Vector<Rope::Fiber, 32> m_workQueue;
+            unsigned m_offset;
+            UString::Rep* m_string;
+            const UChar* m_characters;
+            unsigned m_length;
+        };
+
         ALWAYS_INLINE JSString(JSGlobalData* globalData, const UString& value)
             : JSCell(globalData->stringStructure.get())
             , m_stringLength(value.size())
@@ -195,6 +231,8 @@ namespace JSC {
             , m_ropeLength(1)
         {
             m_fibers[0] = rope.releaseRef();
+            if (m_fibers[0].depth() > s_maxRopeDepth)
+                balanceRope();
         }
         // This constructor constructs a new string by concatenating s1 & s2.
         // This should only be called with ropeLength <= 3.
@@ -290,6 +328,18 @@ namespace JSC {
         }
         unsigned length() { return m_stringLength; }
 
+        // These read a rope in place, so that looking into a string built up by repeated
+        // concatenation does not force a copy of all of it.
+        UChar characterAt(unsigned index) const
+        {
+            ASSERT(index < m_stringLength);
+            if (!isRope())
+                return m_value.data()[index];
+            return ropeCharacterAt(index);
+        }
+        JSValue substring(ExecState*, unsigned offset, unsigned length);
+        int find(const UString& pattern, unsigned start);
+
         bool getStringPropertySlot(ExecState*, const Identifier& propertyName, PropertySlot&);
         bool getStringPropertySlot(ExecState*, unsigned propertyName, PropertySlot&);
         bool getStringPropertyDescriptor(ExecState*, const Identifier& propertyName, PropertyDescriptor&);
@@ -308,6 +358,8 @@ namespace JSC {
         }
 
         void resolveRope(ExecState*) const;
+        void balanceRope();
+        UChar ropeCharacterAt(unsigned index) const;
 
         void appendStringInConstruct(unsigned& index, const UString& string)
         {
@@ -355,6 +407,8 @@ namespace JSC {
         virtual bool getOwnPropertyDescriptor(ExecState*, const Identifier&, PropertyDescriptor&);
 
         static const unsigned s_maxInternalRopeLength = 3;
+        // Ropes deeper than this are rebuilt as a balanced tree.
+        static const unsigned s_maxRopeDepth = 40;
 
         // A string is represented either by a UString or a Rope.
         unsigned m_stringLength;
@@ -430,7 +484,9 @@ namespace JSC {
     inline JSString* JSString::getIndex(ExecState* exec, unsigned i)
     {
         ASSERT(canGetIndex(i));
-        return jsSingleCharacterSubstring(&exec->globalData(), value(exec), i);
+        if (isRope())
+            return jsSingleCharacterString(&exec->globalData(), ropeCharacterAt(i));
+        return jsSingleCharacterSubstring(&exec->globalData(), m_value, i);
     }
 
     inline JSString* jsString(JSGlobalData* globalData, const UString& s)
@@ -500,7 +556,7 @@ namespace JSC {
         bool isStrictUInt32;
         unsigned i = propertyName.toStrictUInt32(&isStrictUInt32);
         if (isStrictUInt32 && i < m_stringLength) {
-            slot.setValue(jsSingleCharacterSubstring(exec, value(exec), i));
+            slot.setValue(getIndex(exec, i));
             return true;
         }
 
@@ -510,7 +566,7 @@ namespace JSC {
     ALWAYS_INLINE bool JSString::getStringPropertySlot(ExecState* exec, unsigned propertyName, PropertySlot& slot)
     {
         if (propertyName < m_stringLength) {
-            slot.setValue(jsSingleCharacterSubstring(exec, value(exec), propertyName));
+            slot.setValue(getIndex(exec, propertyName));
             return true;
         }
 
@@ -34,6 +34,16 @@ namespace JSC {
 
 class JSStringBuilder : public StringBuilder {
 public:
+    using StringBuilder::append;
+
+    // Copies a rope fiber by fiber, rather than resolving it first.
+    void append(JSString* string)
+    {
+        reserveCapacity(size() + string->length());
+        for (JSString::RopeIterator iterator(string); !iterator.atEnd(); iterator.advance())
+            buffer.append(iterator.characters(), iterator.length());
+    }
+
     JSValue build(ExecState* exec)
     {
         buffer.shrinkToFit();
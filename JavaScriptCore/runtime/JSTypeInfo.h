@@ -43,6 +43,9 @@ namespace JSC {
     static const unsigned OverridesGetOwnPropertySlot = 1 << 5;
     static const unsigned OverridesMarkChildren = 1 << 6;
     static const unsigned OverridesGetPropertyNames = 1 << 7;
+    // Cells of this type have no children and an empty destructor, so the collector can
+    // reuse them without calling the destructor.
+    static const unsigned HasTrivialDestructor = 1 << 8;
 
     class TypeInfo {
         friend class JIT;
@@ -66,6 +69,7 @@ namespace JSC {
         bool overridesGetOwnPropertySlot() const { return m_flags & OverridesGetOwnPropertySlot; }
         bool overridesMarkChildren() const { return m_flags & OverridesMarkChildren; }
         bool overridesGetPropertyNames() const { return m_flags & OverridesGetPropertyNames; }
+        bool hasTrivialDestructor() const { return m_flags & HasTrivialDestructor; }
         unsigned flags() const { return m_flags; }
 
     private:
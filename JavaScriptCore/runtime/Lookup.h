@@ -139,6 +139,25 @@ namespace JSC {
             return entry(identifier);
         }
 
+        // Find an entry without making the name into an Identifier first.
+        const HashEntry* entry(JSGlobalData* globalData, const UChar* characters, int length) const
+        {
+            initializeIfNeeded(globalData);
+
+            const HashEntry* entry = &table[UString::Rep::computeHash(characters, length) & compactHashSizeMask];
+
+            if (!entry->key())
+                return 0;
+
+            do {
+                if (Identifier::equal(entry->key(), characters, length))
+                    return entry;
+                entry = entry->next();
+            } while (entry);
+
+            return 0;
+        }
+
     private:
         ALWAYS_INLINE const HashEntry* entry(const Identifier& identifier) const
         {
@@ -26,6 +26,11 @@
 #include "config.h"
 #include "MarkStack.h"
 
+#if ENABLE(PARALLEL_MARKING)
+#include "JSArray.h"
+#include "JSCell.h"
+#endif
+
 namespace JSC {
 
 size_t MarkStack::s_pageSize = 0;
@@ -37,4 +42,224 @@ void MarkStack::compact()
     m_markSets.shrinkAllocation(s_pageSize);
 }
 
+#if ENABLE(PARALLEL_MARKING)
+
+// Number of values or cells a marker visits between checks for idle threads.
+static const unsigned markingBatchSize = 128;
+// A marker keeps stacks smaller than this to itself; handing them off costs more than it saves.
+static const size_t minimumCellsToShare = 32;
+
+void MarkStack::drainInParallel(ParallelMarker& marker)
+{
+    ASSERT(!m_isDrainDeferred);
+    marker.markInParallel(*this);
+}
+
+void MarkStack::drainAndShare(ParallelMarker& marker)
+{
+    ASSERT(m_isMarkingInParallel);
+    while (!m_markSets.isEmpty() || !m_values.isEmpty()) {
+        for (unsigned i = 0; i < markingBatchSize && !m_markSets.isEmpty(); ++i) {
+            MarkSet& current = m_markSets.last();
+            JSValue value = *current.m_values++;
+            if (current.m_values == current.m_end)
+                m_markSets.removeLast();
+            if (value)
+                append(value);
+        }
+
+        for (unsigned i = 0; i < markingBatchSize && !m_values.isEmpty(); ++i) {
+            JSCell* cell = m_values.removeLast();
+            if (m_isHelperThreadStack && cell->structure()->typeInfo().overridesMarkChildren() && cell->vptr() != m_jsArrayVPtr)
+                m_cellsForCollectingThread.append(cell);
+            else
+                markChildren(cell);
+        }
+
+        if (!m_cellsForCollectingThread.isEmpty())
+            marker.handOffToCollectingThread(*this);
+
+        if (marker.m_idleMarkers && m_values.size() > minimumCellsToShare)
+            marker.shareWork(*this);
+    }
+}
+
+ParallelMarker::ParallelMarker(void* jsArrayVPtr)
+    : m_jsArrayVPtr(jsArrayVPtr)
+    , m_markingPass(0)
+    , m_activeMarkers(0)
+    , m_finishedHelpers(0)
+    , m_idleMarkers(0)
+    , m_shouldExit(false)
+{
+}
+
+ParallelMarker::~ParallelMarker()
+{
+    stopHelperThreads();
+}
+
+void ParallelMarker::setHelperThreadCount(unsigned count)
+{
+    if (count == m_helperThreads.size())
+        return;
+
+    stopHelperThreads();
+    for (unsigned i = 0; i < count; ++i) {
+        ThreadIdentifier thread = createThread(helperThreadEntryPoint, this, "JavaScriptCore::Marking");
+        if (!thread)
+            break;
+        m_helperThreads.append(thread);
+    }
+}
+
+void ParallelMarker::stopHelperThreads()
+{
+    {
+        MutexLocker locker(m_lock);
+        m_shouldExit = true;
+        m_markingCondition.broadcast();
+    }
+
+    for (size_t i = 0; i < m_helperThreads.size(); ++i)
+        waitForThreadCompletion(m_helperThreads[i], 0);
+    m_helperThreads.clear();
+
+    // New helpers start waiting for pass 1.
+    m_shouldExit = false;
+    m_markingPass = 0;
+}
+
+void* ParallelMarker::helperThreadEntryPoint(void* marker)
+{
+    static_cast<ParallelMarker*>(marker)->helperThreadMain();
+    return 0;
+}
+
+void MarkStack::saveRoots(Roots& roots)
+{
+    // Popping everything and pushing it back in the same order leaves the stack as it was.
+    while (!m_values.isEmpty())
+        roots.m_cells.append(m_values.removeLast());
+    while (!m_markSets.isEmpty())
+        roots.m_markSets.append(m_markSets.removeLast());
+    restoreRoots(roots);
+}
+
+void MarkStack::restoreRoots(const Roots& roots)
+{
+    for (size_t i = roots.m_cells.size(); i; --i)
+        m_values.append(roots.m_cells[i - 1]);
+    for (size_t i = roots.m_markSets.size(); i; --i)
+        m_markSets.append(roots.m_markSets[i - 1]);
+}
+
+void ParallelMarker::helperThreadMain()
+{
+    MarkStack markStack(m_jsArrayVPtr);
+    markStack.m_isHelperThreadStack = true;
+    unsigned markingPass = 0;
+    while (true) {
+        {
+            MutexLocker locker(m_lock);
+            while (!m_shouldExit && m_markingPass == markingPass)
+                m_markingCondition.wait(m_lock);
+            if (m_shouldExit)
+                break;
+            markingPass = m_markingPass;
+        }
+
+        participate(markStack);
+        markStack.compact();
+
+        MutexLocker locker(m_lock);
+        ++m_finishedHelpers;
+        m_doneCondition.signal();
+    }
+}
+
+void ParallelMarker::markInParallel(MarkStack& markStack)
+{
+    {
+        MutexLocker locker(m_lock);
+        ASSERT(m_sharedCells.isEmpty());
+        ASSERT(m_collectingThreadCells.isEmpty());
+        m_activeMarkers = m_helperThreads.size() + 1;
+        m_idleMarkers = 0;
+        m_finishedHelpers = 0;
+        ++m_markingPass;
+        m_markingCondition.broadcast();
+    }
+
+    participate(markStack);
+
+    // Helpers still hold references to their stacks until they report back, and must not
+    // see the next pass start early.
+    MutexLocker locker(m_lock);
+    while (m_finishedHelpers < m_helperThreads.size())
+        m_doneCondition.wait(m_lock);
+}
+
+void ParallelMarker::participate(MarkStack& markStack)
+{
+    markStack.m_isMarkingInParallel = true;
+    do {
+        markStack.drainAndShare(*this);
+    } while (takeWork(markStack));
+    markStack.m_isMarkingInParallel = false;
+}
+
+void ParallelMarker::shareWork(MarkStack& markStack)
+{
+    MutexLocker locker(m_lock);
+    // Cells on a mark stack are already marked, so any thread may visit their children.
+    for (size_t count = markStack.m_values.size() / 2; count; --count)
+        m_sharedCells.append(markStack.m_values.removeLast());
+    m_workCondition.broadcast();
+}
+
+bool ParallelMarker::takeWork(MarkStack& markStack)
+{
+    MutexLocker locker(m_lock);
+    --m_activeMarkers;
+    ++m_idleMarkers;
+
+    bool isCollectingThread = !markStack.m_isHelperThreadStack;
+    while (m_sharedCells.isEmpty() && (!isCollectingThread || m_collectingThreadCells.isEmpty())) {
+        // Marking is finished once nobody has work left and nobody can produce more.
+        if (!m_activeMarkers && m_collectingThreadCells.isEmpty()) {
+            m_workCondition.broadcast();
+            return false;
+        }
+        m_workCondition.wait(m_lock);
+    }
+
+    --m_idleMarkers;
+    ++m_activeMarkers;
+
+    if (isCollectingThread && !m_collectingThreadCells.isEmpty()) {
+        for (size_t i = 0; i < m_collectingThreadCells.size(); ++i)
+            markStack.m_values.append(m_collectingThreadCells[i]);
+        m_collectingThreadCells.clear();
+        return true;
+    }
+
+    size_t count = (m_sharedCells.size() + 1) / 2;
+    for (size_t i = m_sharedCells.size() - count; i < m_sharedCells.size(); ++i)
+        markStack.m_values.append(m_sharedCells[i]);
+    m_sharedCells.shrink(m_sharedCells.size() - count);
+    return true;
+}
+
+void ParallelMarker::handOffToCollectingThread(MarkStack& markStack)
+{
+    ASSERT(markStack.m_isHelperThreadStack);
+    MutexLocker locker(m_lock);
+    m_collectingThreadCells.append(markStack.m_cellsForCollectingThread);
+    markStack.m_cellsForCollectingThread.clear();
+    m_workCondition.broadcast();
+}
+
+#endif // ENABLE(PARALLEL_MARKING)
+
 }
@@ -29,10 +29,18 @@
 #include "JSValue.h"
 #include <wtf/Noncopyable.h>
 
+#if ENABLE(PARALLEL_MARKING)
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#endif
+
 namespace JSC {
 
     class JSGlobalData;
     class Register;
+#if ENABLE(PARALLEL_MARKING)
+    class ParallelMarker;
+#endif
     
     enum MarkSetProperties { MayContainNullValues, NoNullValues };
     
@@ -40,6 +48,11 @@ namespace JSC {
     public:
         MarkStack(void* jsArrayVPtr)
             : m_jsArrayVPtr(jsArrayVPtr)
+#if ENABLE(PARALLEL_MARKING)
+            , m_isMarkingInParallel(false)
+            , m_isDrainDeferred(false)
+            , m_isHelperThreadStack(false)
+#endif
 #ifndef NDEBUG
             , m_isCheckingForDefaultMarkViolation(false)
 #endif
@@ -48,6 +61,10 @@ namespace JSC {
 
         ALWAYS_INLINE void append(JSValue);
         void append(JSCell*);
+#if ENABLE(GENERATIONAL_COLLECTION)
+        // Revisits the children of a cell that was marked by an earlier collection.
+        ALWAYS_INLINE void appendOldCell(JSCell*);
+#endif
         
         ALWAYS_INLINE void appendValues(Register* values, size_t count, MarkSetProperties properties = NoNullValues)
         {
@@ -63,6 +80,22 @@ namespace JSC {
         inline void drain();
         void compact();
 
+#if ENABLE(PARALLEL_MARKING)
+        // While set, drain() leaves all work on the stack, so every root can be gathered
+        // before tracing is split between threads.
+        void setDrainDeferred(bool deferred) { m_isDrainDeferred = deferred; }
+
+        // Traces everything reachable from this stack using the calling thread together
+        // with the marker's helper threads.
+        void drainInParallel(ParallelMarker&);
+
+        // Copies the cells and value ranges waiting on the stack, and pushes the copy back,
+        // so that the same roots can be traced a second time when checking parallel marking.
+        class Roots;
+        void saveRoots(Roots&);
+        void restoreRoots(const Roots&);
+#endif
+
         ~MarkStack()
         {
             ASSERT(m_markSets.isEmpty());
@@ -70,7 +103,13 @@ namespace JSC {
         }
 
     private:
+#if ENABLE(PARALLEL_MARKING)
+        friend class ParallelMarker;
+        void drainAndShare(ParallelMarker&);
+#endif
+
         void markChildren(JSCell*);
+        ALWAYS_INLINE bool testAndSetMarked(JSCell*);
 
         struct MarkSet {
             MarkSet(JSValue* values, JSValue* end, MarkSetProperties properties)
@@ -177,11 +216,75 @@ namespace JSC {
         MarkStackArray<JSCell*> m_values;
         static size_t s_pageSize;
 
+#if ENABLE(PARALLEL_MARKING)
+        bool m_isMarkingInParallel;
+        bool m_isDrainDeferred;
+
+        // Helper threads only visit the children of cells that use the default marking or are
+        // arrays. Overrides of markChildren, such as those of the WebCore wrappers, may touch
+        // state that is not safe to read off the collecting thread, so helpers hand those
+        // cells back to the collecting thread.
+        bool m_isHelperThreadStack;
+        Vector<JSCell*> m_cellsForCollectingThread;
+#endif
+
 #ifndef NDEBUG
     public:
         bool m_isCheckingForDefaultMarkViolation;
 #endif
     };
+
+#if ENABLE(PARALLEL_MARKING)
+    class MarkStack::Roots : Noncopyable {
+    private:
+        friend class MarkStack;
+        Vector<JSCell*> m_cells;
+        Vector<MarkSet> m_markSets;
+    };
+
+    // Runs helper threads that trace the heap alongside the collecting thread. Each thread
+    // marks from its own MarkStack; threads with surplus cells move some of them to a shared
+    // list whenever another thread has run out of work.
+    class ParallelMarker : public Noncopyable {
+    public:
+        ParallelMarker(void* jsArrayVPtr);
+        ~ParallelMarker();
+
+        void setHelperThreadCount(unsigned);
+        unsigned helperThreadCount() const { return m_helperThreads.size(); }
+
+        // Called on the collecting thread once all roots have been appended to markStack.
+        void markInParallel(MarkStack&);
+
+    private:
+        friend class MarkStack;
+
+        static void* helperThreadEntryPoint(void*);
+        void helperThreadMain();
+        void stopHelperThreads();
+
+        void participate(MarkStack&);
+        void shareWork(MarkStack&);
+        bool takeWork(MarkStack&);
+        void handOffToCollectingThread(MarkStack&);
+
+        void* m_jsArrayVPtr;
+        Vector<ThreadIdentifier> m_helperThreads;
+
+        Mutex m_lock;
+        ThreadCondition m_markingCondition; // Signaled when a marking pass starts, or helpers should exit.
+        ThreadCondition m_workCondition; // Signaled when work is shared, or the last marker runs out.
+        ThreadCondition m_doneCondition; // Signaled when a helper finishes its part of a pass.
+
+        Vector<JSCell*> m_sharedCells;
+        Vector<JSCell*> m_collectingThreadCells; // Only the collecting thread visits these.
+        unsigned m_markingPass;
+        unsigned m_activeMarkers;
+        unsigned m_finishedHelpers;
+        volatile unsigned m_idleMarkers; // Read without the lock as a hint.
+        bool m_shouldExit;
+    };
+#endif
 }
 
 #endif
@@ -31,37 +31,34 @@ namespace JSC {
         unsigned offset;
         unsigned attributes;
         JSCell* specificValue;
-        unsigned index;
 
         PropertyMapEntry(UString::Rep* key, unsigned attributes, JSCell* specificValue)
             : key(key)
             , offset(0)
             , attributes(attributes)
             , specificValue(specificValue)
-            , index(0)
         {
         }
 
-        PropertyMapEntry(UString::Rep* key, unsigned offset, unsigned attributes, JSCell* specificValue, unsigned index)
+        PropertyMapEntry(UString::Rep* key, unsigned offset, unsigned attributes, JSCell* specificValue)
             : key(key)
             , offset(offset)
             , attributes(attributes)
             , specificValue(specificValue)
-            , index(index)
         {
         }
     };
 
-    // lastIndexUsed is an ever-increasing index used to identify the order items
-    // were inserted into the property map. It's required that getEnumerablePropertyNames
-    // return the properties in the order they were added for compatibility with other
-    // browsers' JavaScript implementations.
+    // Entries are only ever appended, and a removed entry leaves a hole that is not
+    // reused until the table is rehashed, which compacts the entries. So the entries
+    // are always in the order the properties were added, which getPropertyNames must
+    // return for compatibility with other browsers' JavaScript implementations, and
+    // there is exactly one hole for each deleted sentinel in the indices.
     struct PropertyMapHashTable {
         unsigned sizeMask;
         unsigned size;
         unsigned keyCount;
         unsigned deletedSentinelCount;
-        unsigned lastIndexUsed;
         Vector<unsigned>* deletedOffsets;
         unsigned entryIndices[1];
 
@@ -34,7 +34,8 @@
 #include "yarr/RegexCompiler.h"
 #if ENABLE(YARR_JIT)
 #include "yarr/RegexJIT.h"
-#else
+#endif
+#if !ENABLE(YARR_JIT) || ENABLE(YARR_JIT_CACHE)
 #include "yarr/RegexInterpreter.h"
 #endif
 
@@ -59,6 +60,9 @@ inline RegExp::RegExp(JSGlobalData* globalData, const UString& pattern)
     , m_flagBits(0)
     , m_constructionError(0)
     , m_numSubpatterns(0)
+#if ENABLE(YARR_JIT_CACHE)
+    , m_isUsingCachedRegex(false)
+#endif
 {
     compile(globalData);
 }
@@ -68,6 +72,9 @@ inline RegExp::RegExp(JSGlobalData* globalData, const UString& pattern, const US
     , m_flagBits(0)
     , m_constructionError(0)
     , m_numSubpatterns(0)
+#if ENABLE(YARR_JIT_CACHE)
+    , m_isUsingCachedRegex(false)
+#endif
 {
     // NOTE: The global flag is handled on a case-by-case basis by functions like
     // String::match and RegExpObject::match.
@@ -102,7 +109,17 @@ PassRefPtr<RegExp> RegExp::create(JSGlobalData* globalData, const UString& patte
 
 void RegExp::compile(JSGlobalData* globalData)
 {
-#if ENABLE(YARR_JIT)
+#if ENABLE(YARR_JIT_CACHE)
+    UNUSED_PARAM(globalData);
+    m_cachedRegex = Yarr::RegexCodeCache::shared().get(m_pattern, ignoreCase(), multiline());
+    if (m_cachedRegex->hasFinishedCompiling()) {
+        m_isUsingCachedRegex = true;
+        m_numSubpatterns = m_cachedRegex->numSubpatterns();
+        m_constructionError = m_cachedRegex->error();
+        return;
+    }
+    m_regExpBytecode.set(Yarr::byteCompileRegex(m_pattern, m_numSubpatterns, m_constructionError, ignoreCase(), multiline()));
+#elif ENABLE(YARR_JIT)
     Yarr::jitCompileRegex(globalData, m_regExpJITCode, m_pattern, m_numSubpatterns, m_constructionError, ignoreCase(), multiline());
 #else
     UNUSED_PARAM(globalData);
@@ -120,7 +137,14 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
     if (startOffset > s.size() || s.isNull())
         return -1;
 
-#if ENABLE(YARR_JIT)
+#if ENABLE(YARR_JIT_CACHE)
+    if (!m_isUsingCachedRegex && m_cachedRegex->hasFinishedCompiling()) {
+        m_isUsingCachedRegex = true;
+        m_regExpBytecode.clear();
+    }
+
+    if (m_isUsingCachedRegex ? !m_cachedRegex->error() : !!m_regExpBytecode) {
+#elif ENABLE(YARR_JIT)
     if (!!m_regExpJITCode) {
 #else
     if (m_regExpBytecode) {
@@ -141,7 +165,13 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
             offsetVector[j] = -1;
 
 
-#if ENABLE(YARR_JIT)
+#if ENABLE(YARR_JIT_CACHE)
+        int result;
+        if (m_isUsingCachedRegex)
+            result = Yarr::executeRegex(m_cachedRegex->code(), s.data(), startOffset, s.size(), offsetVector, offsetVectorSize);
+        else
+            result = Yarr::interpretRegex(m_regExpBytecode.get(), s.data(), startOffset, s.size(), offsetVector);
+#elif ENABLE(YARR_JIT)
         int result = Yarr::executeRegex(m_regExpJITCode, s.data(), startOffset, s.size(), offsetVector, offsetVectorSize);
 #else
         int result = Yarr::interpretRegex(m_regExpBytecode.get(), s.data(), startOffset, s.size(), offsetVector);
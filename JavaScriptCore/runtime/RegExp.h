@@ -69,7 +69,12 @@ namespace JSC {
         const char* m_constructionError;
         unsigned m_numSubpatterns;
 
-#if ENABLE(YARR_JIT)
+#if ENABLE(YARR_JIT_CACHE)
+        // Patterns are interpreted until the shared code cache has finished compiling them.
+        RefPtr<Yarr::CachedRegex> m_cachedRegex;
+        OwnPtr<Yarr::BytecodePattern> m_regExpBytecode;
+        bool m_isUsingCachedRegex;
+#elif ENABLE(YARR_JIT)
         Yarr::RegexCodeBlock m_regExpJITCode;
 #elif ENABLE(YARR)
         OwnPtr<Yarr::BytecodePattern> m_regExpBytecode;
@@ -475,35 +475,35 @@ JSValue JSC_HOST_CALL stringProtoFuncToString(ExecState* exec, JSObject*, JSValu
 
 JSValue JSC_HOST_CALL stringProtoFuncCharAt(ExecState* exec, JSObject*, JSValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    unsigned len = s.size();
+    JSString* s = thisValue.toThisJSString(exec);
+    unsigned len = s->length();
     JSValue a0 = args.at(0);
     if (a0.isUInt32()) {
         uint32_t i = a0.asUInt32();
         if (i < len)
-            return jsSingleCharacterSubstring(exec, s, i);
+            return s->getIndex(exec, i);
         return jsEmptyString(exec);
     }
     double dpos = a0.toInteger(exec);
     if (dpos >= 0 && dpos < len)
-        return jsSingleCharacterSubstring(exec, s, static_cast<unsigned>(dpos));
+        return s->getIndex(exec, static_cast<unsigned>(dpos));
     return jsEmptyString(exec);
 }
 
 JSValue JSC_HOST_CALL stringProtoFuncCharCodeAt(ExecState* exec, JSObject*, JSValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    unsigned len = s.size();
+    JSString* s = thisValue.toThisJSString(exec);
+    unsigned len = s->length();
     JSValue a0 = args.at(0);
     if (a0.isUInt32()) {
         uint32_t i = a0.asUInt32();
         if (i < len)
-            return jsNumber(exec, s.data()[i]);
+            return jsNumber(exec, s->characterAt(i));
         return jsNaN(exec);
     }
     double dpos = a0.toInteger(exec);
     if (dpos >= 0 && dpos < len)
-        return jsNumber(exec, s[static_cast<int>(dpos)]);
+        return jsNumber(exec, s->characterAt(static_cast<unsigned>(dpos)));
     return jsNaN(exec);
 }
 
@@ -521,8 +521,8 @@ JSValue JSC_HOST_CALL stringProtoFuncConcat(ExecState* exec, JSObject*, JSValue
 
 JSValue JSC_HOST_CALL stringProtoFuncIndexOf(ExecState* exec, JSObject*, JSValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    int len = s.size();
+    JSString* s = thisValue.toThisJSString(exec);
+    int len = s->length();
 
     JSValue a0 = args.at(0);
     JSValue a1 = args.at(1);
@@ -541,7 +541,7 @@ JSValue JSC_HOST_CALL stringProtoFuncIndexOf(ExecState* exec, JSObject*, JSValue
         pos = static_cast<int>(dpos);
     }
 
-    return jsNumber(exec, s.find(u2, pos));
+    return jsNumber(exec, s->find(u2, pos));
 }
 
 JSValue JSC_HOST_CALL stringProtoFuncLastIndexOf(ExecState* exec, JSObject*, JSValue thisValue, const ArgList& args)
@@ -644,8 +644,8 @@ JSValue JSC_HOST_CALL stringProtoFuncSearch(ExecState* exec, JSObject*, JSValue
 
 JSValue JSC_HOST_CALL stringProtoFuncSlice(ExecState* exec, JSObject*, JSValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    int len = s.size();
+    JSString* s = thisValue.toThisJSString(exec);
+    int len = s->length();
 
     JSValue a0 = args.at(0);
     JSValue a1 = args.at(1);
@@ -660,7 +660,7 @@ JSValue JSC_HOST_CALL stringProtoFuncSlice(ExecState* exec, JSObject*, JSValue t
             from = 0;
         if (to > len)
             to = len;
-        return jsSubstring(exec, s, static_cast<unsigned>(from), static_cast<unsigned>(to) - static_cast<unsigned>(from));
+        return s->substring(exec, static_cast<unsigned>(from), static_cast<unsigned>(to) - static_cast<unsigned>(from));
     }
 
     return jsEmptyString(exec);
@@ -730,8 +730,8 @@ JSValue JSC_HOST_CALL stringProtoFuncSplit(ExecState* exec, JSObject*, JSValue t
 
 JSValue JSC_HOST_CALL stringProtoFuncSubstr(ExecState* exec, JSObject*, JSValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    int len = s.size();
+    JSString* s = thisValue.toThisJSString(exec);
+    int len = s->length();
 
     JSValue a0 = args.at(0);
     JSValue a1 = args.at(1);
@@ -747,13 +747,13 @@ JSValue JSC_HOST_CALL stringProtoFuncSubstr(ExecState* exec, JSObject*, JSValue
     }
     if (start + length > len)
         length = len - start;
-    return jsSubstring(exec, s, static_cast<unsigned>(start), static_cast<unsigned>(length));
+    return s->substring(exec, static_cast<unsigned>(start), static_cast<unsigned>(length));
 }
 
 JSValue JSC_HOST_CALL stringProtoFuncSubstring(ExecState* exec, JSObject*, JSValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    int len = s.size();
+    JSString* s = thisValue.toThisJSString(exec);
+    int len = s->length();
 
     JSValue a0 = args.at(0);
     JSValue a1 = args.at(1);
@@ -779,7 +779,7 @@ JSValue JSC_HOST_CALL stringProtoFuncSubstring(ExecState* exec, JSObject*, JSVal
         end = start;
         start = temp;
     }
-    return jsSubstring(exec, s, static_cast<unsigned>(start), static_cast<unsigned>(end) - static_cast<unsigned>(start));
+    return s->substring(exec, static_cast<unsigned>(start), static_cast<unsigned>(end) - static_cast<unsigned>(start));
 }
 
 JSValue JSC_HOST_CALL stringProtoFuncToLowerCase(ExecState* exec, JSObject*, JSValue thisValue, const ArgList&)
@@ -52,14 +52,6 @@ using namespace WTF;
 
 namespace JSC {
 
-// Choose a number for the following so that most property maps are smaller,
-// but it's not going to blow out the stack to allocate this number of pointers.
-static const int smallMapThreshold = 1024;
-
-// The point at which the function call overhead of the qsort implementation
-// becomes small compared to the inefficiency of insertion sort.
-static const unsigned tinyMapThreshold = 20;
-
 static const unsigned newTableSize = 16;
 
 #ifndef NDEBUG
@@ -77,8 +69,6 @@ static HashSet<Structure*>& ignoreSet = *(new HashSet<Structure*>);
 static HashSet<Structure*>& liveStructureSet = *(new HashSet<Structure*>);
 #endif
 
-static int comparePropertyMapEntryIndices(const void* a, const void* b);
-
 void Structure::dumpStatistics()
 {
 #if DUMP_STRUCTURE_ID_STATISTICS
@@ -276,7 +266,7 @@ void Structure::materializePropertyMap()
     for (ptrdiff_t i = structures.size() - 2; i >= 0; --i) {
         structure = structures[i];
         structure->m_nameInPrevious->ref();
-        PropertyMapEntry entry(structure->m_nameInPrevious.get(), m_anonymousSlotCount + structure->m_offset, structure->m_attributesInPrevious, structure->m_specificValueInPrevious, ++m_propertyTable->lastIndexUsed);
+        PropertyMapEntry entry(structure->m_nameInPrevious.get(), m_anonymousSlotCount + structure->m_offset, structure->m_attributesInPrevious, structure->m_specificValueInPrevious);
         insertIntoPropertyMapHashTable(entry);
     }
 }
@@ -413,7 +403,21 @@ PassRefPtr<Structure> Structure::removePropertyTransition(Structure* structure,
 {
     ASSERT(!structure->isUncacheableDictionary());
 
-    RefPtr<Structure> transition = toUncacheableDictionaryTransition(structure);
+    RefPtr<Structure> transition;
+    if (structure->isDictionary()) {
+        // A dictionary Structure belongs to a single object, which is about to stop using it,
+        // so its table can be handed over rather than copied.
+        transition = create(structure->m_prototype, structure->typeInfo(), structure->anonymousSlotCount());
+        transition->m_dictionaryKind = UncachedDictionaryKind;
+        transition->m_propertyStorageCapacity = structure->m_propertyStorageCapacity;
+        transition->m_hasGetterSetterProperties = structure->m_hasGetterSetterProperties;
+        transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
+        transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount;
+        transition->m_propertyTable = structure->m_propertyTable;
+        transition->m_isPinnedPropertyTable = true;
+        structure->m_propertyTable = 0;
+    } else
+        transition = toUncacheableDictionaryTransition(structure);
 
     offset = transition->remove(propertyName);
     ASSERT(offset >= structure->m_anonymousSlotCount);
@@ -520,30 +524,25 @@ PassRefPtr<Structure> Structure::flattenDictionaryStructure(JSObject* object)
     ASSERT(isDictionary());
     if (isUncacheableDictionary()) {
         ASSERT(m_propertyTable);
-        Vector<PropertyMapEntry*> sortedPropertyEntries(m_propertyTable->keyCount);
-        PropertyMapEntry** p = sortedPropertyEntries.data();
+
+        // The entries are in the order the properties were added, which is the order
+        // their values should be in, but deleted properties have left gaps in the
+        // storage, so copy the current values out before moving them.
+        Vector<JSValue> values(m_propertyTable->keyCount);
+        unsigned anonymousSlotCount = m_anonymousSlotCount;
+        unsigned propertyCount = 0;
         unsigned entryCount = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount;
         for (unsigned i = 1; i <= entryCount; i++) {
-            if (m_propertyTable->entries()[i].key)
-                *p++ = &m_propertyTable->entries()[i];
-        }
-        size_t propertyCount = p - sortedPropertyEntries.data();
-        qsort(sortedPropertyEntries.data(), propertyCount, sizeof(PropertyMapEntry*), comparePropertyMapEntryIndices);
-        sortedPropertyEntries.resize(propertyCount);
-
-        // We now have the properties currently defined on this object
-        // in the order that they are expected to be in, but we need to
-        // reorder the storage, so we have to copy the current values out
-        Vector<JSValue> values(propertyCount);
-        unsigned anonymousSlotCount = m_anonymousSlotCount;
-        for (unsigned i = 0; i < propertyCount; i++) {
-            PropertyMapEntry* entry = sortedPropertyEntries[i];
-            values[i] = object->getDirectOffset(entry->offset);
+            PropertyMapEntry& entry = m_propertyTable->entries()[i];
+            if (!entry.key)
+                continue;
+            values[propertyCount] = object->getDirectOffset(entry.offset);
             // Update property table to have the new property offsets
-            entry->offset = anonymousSlotCount + i;
-            entry->index = i;
+            entry.offset = anonymousSlotCount + propertyCount;
+            ++propertyCount;
         }
-        
+        ASSERT(propertyCount == m_propertyTable->keyCount);
+
         // Copy the original property values into their final locations
         for (unsigned i = 0; i < propertyCount; i++)
             object->putDirectOffset(anonymousSlotCount + i, values[i]);
@@ -771,12 +770,10 @@ size_t Structure::put(const Identifier& propertyName, unsigned attributes, JSCel
     if (!m_propertyTable)
         createPropertyMapHashTable();
 
-    // FIXME: Consider a fast case for tables with no deleted sentinels.
-
+    // Deleted sentinels are passed over rather than reused, so that the new entry can
+    // go at the end of the entries; they are cleared out when the table is rehashed.
     unsigned i = rep->existingHash();
     unsigned k = 0;
-    bool foundDeletedElement = false;
-    unsigned deletedElementIndex = 0; // initialize to make the compiler happy
 
 #if DUMP_PROPERTYMAP_STATS
     ++numProbes;
@@ -787,14 +784,6 @@ size_t Structure::put(const Identifier& propertyName, unsigned attributes, JSCel
         if (entryIndex == emptyEntryIndex)
             break;
 
-        if (entryIndex == deletedSentinelIndex) {
-            // If we find a deleted-element sentinel, remember it for use later.
-            if (!foundDeletedElement) {
-                foundDeletedElement = true;
-                deletedElementIndex = i;
-            }
-        }
-
         if (k == 0) {
             k = 1 | doubleHash(rep->existingHash());
 #if DUMP_PROPERTYMAP_STATS
@@ -809,20 +798,7 @@ size_t Structure::put(const Identifier& propertyName, unsigned attributes, JSCel
 #endif
     }
 
-    // Figure out which entry to use.
     unsigned entryIndex = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount + 2;
-    if (foundDeletedElement) {
-        i = deletedElementIndex;
-        --m_propertyTable->deletedSentinelCount;
-
-        // Since we're not making the table bigger, we can't use the entry one past
-        // the end that we were planning on using, so search backwards for the empty
-        // slot that we can use. We know it will be there because we did at least one
-        // deletion in the past that left an entry empty.
-        while (m_propertyTable->entries()[--entryIndex - 1].key) { }
-    }
-
-    // Create a new hash table entry.
     m_propertyTable->entryIndices[i & m_propertyTable->sizeMask] = entryIndex;
 
     // Create a new hash table entry.
@@ -830,7 +806,6 @@ size_t Structure::put(const Identifier& propertyName, unsigned attributes, JSCel
     m_propertyTable->entries()[entryIndex - 1].key = rep;
     m_propertyTable->entries()[entryIndex - 1].attributes = attributes;
     m_propertyTable->entries()[entryIndex - 1].specificValue = specificValue;
-    m_propertyTable->entries()[entryIndex - 1].index = ++m_propertyTable->lastIndexUsed;
 
     unsigned newOffset;
     if (m_propertyTable->deletedOffsets && !m_propertyTable->deletedOffsets->isEmpty()) {
@@ -1010,15 +985,11 @@ void Structure::rehashPropertyMapHashTable(unsigned newTableSize)
     m_propertyTable->size = newTableSize;
     m_propertyTable->sizeMask = newTableSize - 1;
 
-    unsigned lastIndexUsed = 0;
     unsigned entryCount = oldTable->keyCount + oldTable->deletedSentinelCount;
     for (unsigned i = 1; i <= entryCount; ++i) {
-        if (oldTable->entries()[i].key) {
-            lastIndexUsed = max(oldTable->entries()[i].index, lastIndexUsed);
+        if (oldTable->entries()[i].key)
             insertIntoPropertyMapHashTable(oldTable->entries()[i]);
-        }
     }
-    m_propertyTable->lastIndexUsed = lastIndexUsed;
     m_propertyTable->deletedOffsets = oldTable->deletedOffsets;
 
     fastFree(oldTable);
@@ -1026,72 +997,24 @@ void Structure::rehashPropertyMapHashTable(unsigned newTableSize)
     checkConsistency();
 }
 
-int comparePropertyMapEntryIndices(const void* a, const void* b)
-{
-    unsigned ia = static_cast<PropertyMapEntry* const*>(a)[0]->index;
-    unsigned ib = static_cast<PropertyMapEntry* const*>(b)[0]->index;
-    if (ia < ib)
-        return -1;
-    if (ia > ib)
-        return +1;
-    return 0;
-}
-
 void Structure::getPropertyNames(PropertyNameArray& propertyNames, EnumerationMode mode)
 {
     materializePropertyMapIfNecessary();
     if (!m_propertyTable)
         return;
 
-    if (m_propertyTable->keyCount < tinyMapThreshold) {
-        PropertyMapEntry* a[tinyMapThreshold];
-        int i = 0;
-        unsigned entryCount = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount;
-        for (unsigned k = 1; k <= entryCount; k++) {
-            ASSERT(m_hasNonEnumerableProperties || !(m_propertyTable->entries()[k].attributes & DontEnum));
-            if (m_propertyTable->entries()[k].key && (!(m_propertyTable->entries()[k].attributes & DontEnum) || (mode == IncludeDontEnumProperties))) {
-                PropertyMapEntry* value = &m_propertyTable->entries()[k];
-                int j;
-                for (j = i - 1; j >= 0 && a[j]->index > value->index; --j)
-                    a[j + 1] = a[j];
-                a[j + 1] = value;
-                ++i;
-            }
-        }
-        if (!propertyNames.size()) {
-            for (int k = 0; k < i; ++k)
-                propertyNames.addKnownUnique(a[k]->key);
-        } else {
-            for (int k = 0; k < i; ++k)
-                propertyNames.add(a[k]->key);
-        }
-
-        return;
-    }
-
-    // Allocate a buffer to use to sort the keys.
-    Vector<PropertyMapEntry*, smallMapThreshold> sortedEnumerables(m_propertyTable->keyCount);
-
-    // Get pointers to the enumerable entries in the buffer.
-    PropertyMapEntry** p = sortedEnumerables.data();
+    // The entries are already in the order the properties were added.
+    bool knownUnique = !propertyNames.size();
     unsigned entryCount = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount;
     for (unsigned i = 1; i <= entryCount; i++) {
-        if (m_propertyTable->entries()[i].key && (!(m_propertyTable->entries()[i].attributes & DontEnum) || (mode == IncludeDontEnumProperties)))
-            *p++ = &m_propertyTable->entries()[i];
-    }
-
-    size_t enumerableCount = p - sortedEnumerables.data();
-    // Sort the entries by index.
-    qsort(sortedEnumerables.data(), enumerableCount, sizeof(PropertyMapEntry*), comparePropertyMapEntryIndices);
-    sortedEnumerables.resize(enumerableCount);
-
-    // Put the keys of the sorted entries into the list.
-    if (!propertyNames.size()) {
-        for (size_t i = 0; i < sortedEnumerables.size(); ++i)
-            propertyNames.addKnownUnique(sortedEnumerables[i]->key);
-    } else {
-        for (size_t i = 0; i < sortedEnumerables.size(); ++i)
-            propertyNames.add(sortedEnumerables[i]->key);
+        const PropertyMapEntry& entry = m_propertyTable->entries()[i];
+        ASSERT(m_hasNonEnumerableProperties || !(entry.attributes & DontEnum));
+        if (!entry.key || ((entry.attributes & DontEnum) && mode != IncludeDontEnumProperties))
+            continue;
+        if (knownUnique)
+            propertyNames.addKnownUnique(entry.key);
+        else
+            propertyNames.add(entry.key);
     }
 }
 
@@ -31,7 +31,9 @@
 #include "TimeoutChecker.h"
 
 #include "CallFrame.h"
+#include "Executable.h"
 #include "JSGlobalObject.h"
+#include "SamplingTool.h"
 
 #if OS(DARWIN)
 #include <mach/mach.h>
@@ -111,11 +113,17 @@ void TimeoutChecker::reset()
 
 bool TimeoutChecker::didTimeOut(ExecState* exec)
 {
+    unsigned ticksUntilNextSample = 0;
+    if (StackSampler* stackSampler = exec->globalData().stackSampler)
+        ticksUntilNextSample = stackSampler->sample(exec, m_ticksUntilNextCheck);
+
     unsigned currentTime = getCPUTime();
     
     if (!m_timeAtLastCheck) {
         // Suspicious amount of looping in a script -- start timing it
         m_timeAtLastCheck = currentTime;
+        if (ticksUntilNextSample)
+            m_ticksUntilNextCheck = ticksUntilNextSample;
         return false;
     }
     
@@ -134,6 +142,10 @@ bool TimeoutChecker::didTimeOut(ExecState* exec)
     // preferred script check time interval.
     if (m_ticksUntilNextCheck == 0)
         m_ticksUntilNextCheck = ticksUntilFirstCheck;
+
+    // The stack sampler usually wants to be called well before the next timeout check is due.
+    if (ticksUntilNextSample && ticksUntilNextSample < m_ticksUntilNextCheck)
+        m_ticksUntilNextCheck = ticksUntilNextSample;
     
     if (m_timeoutInterval && m_timeExecuting > m_timeoutInterval) {
         if (exec->dynamicGlobalObject()->shouldInterruptScript())
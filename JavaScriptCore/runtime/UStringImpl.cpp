@@ -72,6 +72,22 @@ PassRefPtr<UStringImpl> UStringImpl::create(const UChar* buffer, int length)
     return impl;
 }
 
+UStringImpl* UStringImpl::createStatic(const char* c, unsigned length)
+{
+    ASSERT(length);
+
+    if (length > ((std::numeric_limits<size_t>::max() - sizeof(UStringImpl)) / sizeof(UChar)))
+        CRASH();
+    UStringImpl* resultImpl = static_cast<UStringImpl*>(fastMalloc(sizeof(UChar) * length + sizeof(UStringImpl)));
+    UChar* d = reinterpret_cast<UChar*>(resultImpl + 1);
+    for (unsigned i = 0; i < length; i++)
+        d[i] = static_cast<unsigned char>(c[i]); // use unsigned char to zero-extend instead of sign-extend
+    new (resultImpl) UStringImpl(d, length, ConstructStaticString);
+    resultImpl->m_hash = computeHash(d, length);
+    resultImpl->m_dataBuffer |= s_reportedCostBit;
+    return resultImpl;
+}
+
 SharedUChar* UStringImpl::baseSharedBuffer()
 {
     ASSERT((bufferOwnership() == BufferShared)
@@ -85,9 +101,9 @@ SharedUChar* UStringImpl::baseSharedBuffer()
 
 SharedUChar* UStringImpl::sharedBuffer()
 {
-    if (m_length < s_minLengthToShare)
+    // Static strings are shared between threads as they are, and never hand out their buffer.
+    if (m_length < s_minLengthToShare || isStatic())
         return 0;
-    ASSERT(!isStatic());
 
     UStringImpl* owner = bufferOwnerString();
     if (owner->bufferOwnership() == BufferInternal)
@@ -102,6 +102,9 @@ public:
     {
         ASSERT(rep);
         rep->checkConsistency();
+        // Static strings cannot be the base of a substring, see below; copy the characters instead.
+        if (rep->isStatic())
+            return create(rep->m_data + offset, length);
         return adoptRef(new UStringImpl(rep->m_data + offset, length, rep->bufferOwnerString()));
     }
 
@@ -140,6 +143,10 @@ public:
         return adoptRef(new(resultImpl) UStringImpl(output, length, BufferInternal));
     }
 
+    // Creates a static string on the heap, for the shared identifier table. Its hash is computed
+    // and its cost is marked as reported up front, so that it is never written to once created.
+    static UStringImpl* createStatic(const char* c, unsigned length);
+
     SharedUChar* sharedBuffer();
     UChar* data() const { return m_data; }
     int size() const { return m_length; }
@@ -182,8 +189,8 @@ public:
     {
         // There is no recursion of substrings.
         ASSERT(bufferOwnerString()->bufferOwnership() != BufferSubstring);
-        // Static strings cannot be put in identifier tables, because they are globally shared.
-        ASSERT(!isStatic() || !isIdentifier());
+        // Static strings can only be identifiers in the shared identifier table, which outlives
+        // every per-thread IdentifierTable; see Identifier.cpp.
     }
 
 private:
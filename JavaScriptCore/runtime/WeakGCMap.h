@@ -97,6 +97,7 @@ template<typename KeyType, typename MappedType>
 pair<typename HashMap<KeyType, MappedType>::iterator, bool> WeakGCMap<KeyType, MappedType>::set(const KeyType& key, const MappedType& value)
 {
     Heap::markCell(value); // If value is newly allocated, it's not marked, so mark it now.
+    Heap::writeBarrier(value);
     pair<iterator, bool> result = m_map.add(key, value);
     if (!result.second) { // pre-existing entry
         result.second = !Heap::isCellMarked(result.first->second);
@@ -68,8 +68,11 @@ public:
 private:
     void assign(T* ptr)
     {
-        if (ptr)
+        if (ptr) {
             Heap::markCell(ptr);
+            // The cell is now considered old, so a nursery collection must still visit its children.
+            Heap::writeBarrier(ptr);
+        }
         m_ptr = ptr;
     }
 
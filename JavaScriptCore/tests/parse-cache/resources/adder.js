@@ -0,0 +1,6 @@
+// Loaded twice by same-source-twice.js, so that the second load reuses the cached tree.
+var loads = (typeof loads == "undefined" ? 0 : loads) + 1;
+function makeAdder(n)
+{
+    return function(x) { return x + n + loads; };
+}
@@ -0,0 +1,57 @@
+// Compiles the same source text more than once, so that later compiles reuse the syntax tree
+// that JSGlobalData's ParseCache kept from the first. Each compile must behave as if the source
+// had been parsed afresh, whatever an earlier compile of the same tree did with it.
+// Run with the jsc shell from the JavaScriptCore directory: jsc tests/parse-cache/same-source-twice.js
+
+var failures = 0;
+
+function shouldBe(description, actual, expected)
+{
+    if (actual === expected)
+        print("PASS " + description);
+    else {
+        print("FAIL " + description + ": got " + actual + ", expected " + expected);
+        ++failures;
+    }
+}
+
+// The same program twice.
+load("tests/parse-cache/resources/adder.js");
+var firstAdder = makeAdder(10);
+load("tests/parse-cache/resources/adder.js");
+var secondAdder = makeAdder(20);
+shouldBe("second load ran its own global code", loads, 2);
+shouldBe("adder from the first load", firstAdder(1), 13);
+shouldBe("adder from the second load", secondAdder(1), 23);
+
+// The same function body twice, with the same parameters.
+var body = "return a * b;";
+var multiply1 = new Function("a", "b", body);
+var multiply2 = new Function("a", "b", body);
+shouldBe("first compile of a body", multiply1(6, 7), 42);
+shouldBe("second compile of the same body", multiply2(6, 7), 42);
+
+// The same function body, at the same offset, compiled with different parameter names.
+body = "return typeof x + ',' + typeof y;";
+var usesX = new Function("x", body);
+var usesY = new Function("y", body);
+var usesXAgain = new Function("x", body);
+shouldBe("body compiled with parameter x", usesX(1), "number,undefined");
+shouldBe("same body compiled with parameter y", usesY(1), "undefined,number");
+shouldBe("same body compiled with parameter x again", usesXAgain(1), "number,undefined");
+shouldBe("first function after the others were compiled", usesX(1), "number,undefined");
+
+// The same function body compiled for functions with different names.
+var namedA = eval("(function a() { return typeof a + ',' + typeof b; })");
+var namedB = eval("(function b() { return typeof a + ',' + typeof b; })");
+shouldBe("body compiled for function a", namedA(), "function,undefined");
+shouldBe("same body compiled for function b", namedB(), "undefined,function");
+
+// The same function body that reads 'arguments', compiled twice.
+body = "var total = 0; for (var i = 0; i < arguments.length; ++i) total += arguments[i]; return total;";
+var sum1 = new Function(body);
+var sum2 = new Function(body);
+shouldBe("body that reads arguments", sum1(1, 2, 3), 6);
+shouldBe("same body that reads arguments, compiled again", sum2(4, 5), 9);
+
+print(failures ? failures + " FAILED" : "All tests passed");
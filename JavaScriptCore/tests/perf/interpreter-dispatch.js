@@ -0,0 +1,85 @@
+// Times the bytecode sequences that the interpreter fuses into superinstructions,
+// and property loads that see several object shapes. Build with ENABLE_OPCODE_STATS
+// to print per opcode pair dispatch counts on exit.
+// Run with the jsc shell: jsc tests/perf/interpreter-dispatch.js [-- test name]
+
+load("tests/perf/runner.js");
+
+function check(actual, expected, name)
+{
+    if (actual !== expected)
+        throw name + ": expected " + expected + " but got " + actual;
+}
+
+function countingLoops()
+{
+    // pre_inc followed by loop_if_less.
+    var sum = 0;
+    for (var n = 0; n < 200; ++n) {
+        for (var i = 0; i < 10000; ++i)
+            sum += i & 7;
+    }
+    check(sum, 7000000, "counting loops");
+}
+
+function Point(x, y)
+{
+    this.x = x;
+    this.y = y;
+}
+
+Point.prototype.getX = function() { return this.x; };
+Point.prototype.getY = function() { return this.y; };
+
+function methodCalls()
+{
+    // get_by_id followed by call, for methods on the prototype and on the object itself.
+    var p = new Point(1, 2);
+    p.own = function() { return 3; };
+    var sum = 0;
+    for (var i = 0; i < 500000; ++i)
+        sum += p.getX() + p.getY() + p.own();
+    check(sum, 3000000, "method calls");
+
+    // Replacing the method must not leave a stale cache behind.
+    var q = new Point(1, 2);
+    sum = 0;
+    for (var i = 0; i < 1000; ++i) {
+        if (i == 500)
+            Point.prototype.getX = function() { return 10; };
+        sum += q.getX();
+    }
+    Point.prototype.getX = function() { return this.x; };
+    check(sum, 5500, "replaced method");
+}
+
+function polymorphicLoads()
+{
+    // Own and prototype properties read from objects of four different shapes.
+    function A() { this.value = 1; }
+    function B() { this.other = 0; this.value = 2; }
+    function C() { this.a = 0; this.b = 0; this.value = 3; }
+    function D() { }
+    D.prototype.value = 4;
+
+    var objects = [ new A, new B, new C, new D ];
+    var sum = 0;
+    for (var n = 0; n < 250000; ++n) {
+        for (var i = 0; i < objects.length; ++i)
+            sum += objects[i].value;
+    }
+    check(sum, 2500000, "polymorphic loads");
+
+    var protos = [ new D, Object.create ? Object.create(D.prototype) : new D ];
+    sum = 0;
+    for (var n = 0; n < 1000; ++n) {
+        if (n == 500)
+            D.prototype.value = 5;
+        for (var i = 0; i < protos.length; ++i)
+            sum += protos[i].value;
+    }
+    check(sum, 9000, "prototype loads");
+}
+
+var tests = [ ["counting loops", countingLoops], ["method calls", methodCalls], ["polymorphic loads", polymorphicLoads] ];
+runTests(tests, arguments[0]);
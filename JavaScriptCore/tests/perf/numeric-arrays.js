@@ -0,0 +1,76 @@
+// Times code that fills and reads large arrays of numbers, as image filters and charts do.
+// Arrays that only ever hold int32s or numbers keep them unboxed; see ArrayStorageMode in JSArray.h.
+// Run with the jsc shell: jsc tests/perf/numeric-arrays.js [-- test name]
+
+load("tests/perf/runner.js");
+
+function pixels()
+{
+    var width = 320;
+    var height = 240;
+    var image = [];
+    for (var i = 0; i < width * height * 4; ++i)
+        image.push((i * 2654435761) & 0xff);
+
+    var sum = 0;
+    for (var n = 0; n < 10; ++n) {
+        var blurred = new Array(image.length);
+        for (var y = 1; y < height - 1; ++y) {
+            for (var x = 0; x < width * 4; ++x) {
+                var p = y * width * 4 + x;
+                blurred[p] = (image[p - width * 4] + 2 * image[p] + image[p + width * 4]) >> 2;
+            }
+        }
+        sum += blurred[width * 4 * 100 + 7];
+    }
+    return sum;
+}
+
+function samples()
+{
+    var values = [];
+    for (var i = 0; i < 200000; ++i)
+        values[i] = Math.sin(i / 100) * 50 + 50;
+
+    var total = 0;
+    for (var n = 0; n < 10; ++n) {
+        var min = Infinity;
+        var max = -Infinity;
+        for (var i = 0; i < values.length; ++i) {
+            var v = values[i];
+            if (v < min)
+                min = v;
+            if (v > max)
+                max = v;
+            values[i] = v * 0.999;
+        }
+        total += max - min;
+    }
+    return total;
+}
+
+function histogram()
+{
+    var buckets = [];
+    for (var i = 0; i < 256; ++i)
+        buckets[i] = 0;
+    for (var i = 0; i < 2000000; ++i)
+        buckets[(i * 2654435761) & 0xff]++;
+    return buckets[17];
+}
+
+function sorting()
+{
+    var total = 0;
+    for (var n = 0; n < 10; ++n) {
+        var values = [];
+        for (var i = 0; i < 50000; ++i)
+            values.push((i * 2654435761) % 100003 + 0.5);
+        values.sort(function(a, b) { return a - b; });
+        total += values[25000];
+    }
+    return total;
+}
+
+var tests = [ ["pixels", pixels], ["samples", samples], ["histogram", histogram], ["sorting", sorting] ];
+runTests(tests, arguments[0]);
@@ -0,0 +1,92 @@
+// Times common ways of using a plain object as a hash map. Objects with many
+// properties, or that have had properties deleted, are kept in dictionary mode.
+// Run with the jsc shell: jsc tests/perf/object-as-map.js [-- test name]
+
+load("tests/perf/runner.js");
+
+function makeKeys(count, prefix)
+{
+    var keys = new Array(count);
+    for (var i = 0; i < count; ++i)
+        keys[i] = prefix + i;
+    return keys;
+}
+
+var keys = makeKeys(2000, "key");
+var otherKeys = makeKeys(2000, "other");
+
+function insert()
+{
+    for (var n = 0; n < 50; ++n) {
+        var map = {};
+        for (var i = 0; i < keys.length; ++i)
+            map[keys[i]] = i;
+    }
+}
+
+function lookup()
+{
+    var map = {};
+    for (var i = 0; i < keys.length; ++i)
+        map[keys[i]] = i;
+
+    var sum = 0;
+    for (var n = 0; n < 100; ++n) {
+        for (var i = 0; i < keys.length; ++i)
+            sum += map[keys[i]];
+        for (var i = 0; i < otherKeys.length; ++i) {
+            if (otherKeys[i] in map)
+                ++sum;
+        }
+    }
+    return sum;
+}
+
+function churn()
+{
+    // A cache that evicts its oldest entry for each new one.
+    var map = {};
+    var size = 1000;
+    for (var i = 0; i < size; ++i)
+        map[keys[i]] = i;
+
+    for (var n = 0; n < 200000; ++n) {
+        delete map[keys[n % keys.length]];
+        map[keys[(n + size) % keys.length]] = n;
+    }
+}
+
+function enumerate()
+{
+    var map = {};
+    for (var i = 0; i < keys.length; ++i)
+        map[keys[i]] = i;
+    for (var i = 0; i < keys.length; i += 3)
+        delete map[keys[i]];
+
+    var count = 0;
+    for (var n = 0; n < 100; ++n) {
+        for (var key in map)
+            ++count;
+    }
+    return count;
+}
+
+function smallMaps()
+{
+    // Many small maps, each losing a property, as decoded JSON records often do.
+    var records = [];
+    for (var n = 0; n < 20000; ++n) {
+        var record = { id: n, name: "item", value: n * 2, tag: "t", flags: 0 };
+        delete record.flags;
+        record["extra" + (n % 10)] = true;
+        records.push(record);
+    }
+    var sum = 0;
+    for (var n = 0; n < records.length; ++n)
+        sum += records[n].value;
+    return sum;
+}
+
+var tests = [ ["insert", insert], ["lookup", lookup], ["churn", churn], ["enumerate", enumerate], ["small maps", smallMaps] ];
+runTests(tests, arguments[0]);
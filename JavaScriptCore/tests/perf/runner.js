@@ -0,0 +1,20 @@
+// Shared by the scripts in this directory, which load it from the JavaScriptCore directory:
+// load("tests/perf/runner.js");
+// runTests(tests, arguments[0]);
+// Each test is a [name, function] pair. Naming a test on the command line, after "--",
+// runs only that one, which makes its peak memory use visible to /usr/bin/time -v.
+
+function runTests(tests, only)
+{
+    var total = 0;
+    for (var i = 0; i < tests.length; ++i) {
+        if (only !== undefined && only != tests[i][0])
+            continue;
+        var start = new Date;
+        tests[i][1]();
+        var time = new Date - start;
+        total += time;
+        print(tests[i][0] + ": " + time + "ms");
+    }
+    print("total: " + total + "ms");
+}
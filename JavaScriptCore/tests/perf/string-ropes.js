@@ -0,0 +1,87 @@
+// Times looking into large strings built by concatenation, as templating code does.
+// Such strings are held as ropes; each test reads one without needing a flat copy.
+// Run with the jsc shell: jsc tests/perf/string-ropes.js [-- test name]
+// Building with DUMP_ROPE_STATISTICS set in JSString.h prints how many ropes were
+// resolved, and how many characters that copied, on exit.
+
+load("tests/perf/runner.js");
+
+function buildPage(rows)
+{
+    var html = "<table>";
+    for (var i = 0; i < rows; ++i)
+        html += "<tr><td class=\"c" + (i % 7) + "\">" + i + "</td><td>row " + i + "</td></tr>\n";
+    return html + "</table>";
+}
+
+function index()
+{
+    var found = 0;
+    for (var n = 0; n < 20; ++n) {
+        var page = buildPage(5000);
+        found += page.indexOf("row 4999");
+        found += page.indexOf("<tr>", page.length >> 1);
+    }
+    return found;
+}
+
+function characters()
+{
+    var sum = 0;
+    for (var n = 0; n < 20; ++n) {
+        var page = buildPage(5000);
+        for (var i = 0; i < page.length; i += 97)
+            sum += page.charCodeAt(i) + page.charAt(i).length + page[i].length;
+    }
+    return sum;
+}
+
+function substrings()
+{
+    var total = 0;
+    for (var n = 0; n < 20; ++n) {
+        var page = buildPage(5000);
+        for (var i = 0; i < page.length; i += 1000)
+            total += page.substring(i, i + 40).length + page.slice(i, i + 5).length;
+    }
+    return total;
+}
+
+function prepend()
+{
+    var total = 0;
+    for (var n = 0; n < 10; ++n) {
+        var s = "";
+        for (var i = 0; i < 20000; ++i)
+            s = "<li>" + i + "</li>" + s;
+        total += s.charCodeAt(s.length - 1) + s.indexOf("<li>19999");
+    }
+    return total;
+}
+
+function join()
+{
+    var length = 0;
+    for (var n = 0; n < 20; ++n) {
+        var parts = [];
+        for (var i = 0; i < 20; ++i)
+            parts.push(buildPage(250));
+        length += parts.join("\n").length;
+    }
+    return length;
+}
+
+function stringify()
+{
+    var length = 0;
+    for (var n = 0; n < 20; ++n) {
+        var records = [];
+        for (var i = 0; i < 20; ++i)
+            records.push({ id: i, body: buildPage(250) });
+        length += JSON.stringify(records).length;
+    }
+    return length;
+}
+
+var tests = [ ["index", index], ["characters", characters], ["substrings", substrings], ["prepend", prepend], ["join", join], ["stringify", stringify] ];
+runTests(tests, arguments[0]);
@@ -83,12 +83,6 @@
 #include <pthread.h>
 #endif
 
-#ifndef NO_TCMALLOC_SAMPLES
-#ifdef WTF_CHANGES
-#define NO_TCMALLOC_SAMPLES
-#endif
-#endif
-
 #if !(defined(USE_SYSTEM_MALLOC) && USE_SYSTEM_MALLOC) && defined(NDEBUG)
 #define FORCE_SYSTEM_MALLOC 0
 #else
@@ -362,13 +356,28 @@ void* fastRealloc(void* p, size_t n)
 }
 
 void releaseFastMallocFreeMemory() { }
+
+void setFastMallocScavengerWatermarks(size_t, size_t) { }
     
 FastMallocStatistics fastMallocStatistics()
 {
-    FastMallocStatistics statistics = { 0, 0, 0, 0 };
+    FastMallocStatistics statistics = { 0, 0, 0, 0, 0, 0 };
     return statistics;
 }
 
+size_t fastMallocSizeClassStatistics(FastMallocSizeClassStatistics*, size_t)
+{
+    return 0;
+}
+
+void setFastMallocHeapProfilingInterval(size_t)
+{
+}
+
+void dumpFastMallocHeapProfile(FastMallocHeapProfileFunction, void*)
+{
+}
+
 } // namespace WTF
 
 #if OS(DARWIN)
@@ -401,6 +410,7 @@ extern "C" const int jscore_fastmalloc_introspection = 0;
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #if OS(UNIX)
 #include <unistd.h>
 #endif
@@ -421,6 +431,9 @@ extern "C" const int jscore_fastmalloc_introspection = 0;
 #if HAVE(DISPATCH_H)
 #include <dispatch/dispatch.h>
 #endif
+#if COMPILER(GCC)
+#include <unwind.h>
+#endif
 
 
 #ifndef PRIuS
@@ -510,6 +523,35 @@ private:
 #else
 # include <google/stacktrace.h>
 #endif
+#elif COMPILER(GCC)
+struct StackTraceState {
+  void** stack;
+  int depth;
+  int max_depth;
+  int skip_count;
+};
+
+static _Unwind_Reason_Code StackTraceCallback(struct _Unwind_Context* context, void* argument) {
+  StackTraceState* state = static_cast<StackTraceState*>(argument);
+  void* pc = reinterpret_cast<void*>(_Unwind_GetIP(context));
+  if (!pc)
+    return _URC_END_OF_STACK;
+  if (state->skip_count > 0)
+    --state->skip_count;
+  else
+    state->stack[state->depth++] = pc;
+  return state->depth < state->max_depth ? _URC_NO_REASON : _URC_END_OF_STACK;
+}
+
+// Fills in the return addresses of up to max_depth callers, skipping the
+// innermost skip_count, and returns how many it found.
+static int GetStackTrace(void** stack, int max_depth, int skip_count) {
+  StackTraceState state = { stack, 0, max_depth, skip_count + 1 };
+  _Unwind_Backtrace(StackTraceCallback, &state);
+  return state.depth;
+}
+#else
+# define GetStackTrace(stack, depth, skip)  (0)
 #endif
 
 // Even if we have support for thread-local storage in the compiler
@@ -625,6 +667,12 @@ static int primes_list[] = {
 DEFINE_int64(tcmalloc_sample_parameter, 0,
              "Unused: code is compiled with NO_TCMALLOC_SAMPLES");
 static size_t sample_period = 0;
+#elif defined(WTF_CHANGES)
+// Sampling is off until setFastMallocHeapProfilingInterval() turns it on.
+DEFINE_int64(tcmalloc_sample_parameter, 0,
+             "Twice the approximate gap between sampling actions, or zero"
+             " for no sampling");
+static size_t sample_period = 0;
 #else
 DEFINE_int64(tcmalloc_sample_parameter, 262147,
          "Twice the approximate gap between sampling actions."
@@ -1178,6 +1226,9 @@ struct StackTrace {
   uintptr_t size;          // Size of object
   uintptr_t depth;         // Number of PC values stored in array below
   void*     stack[kMaxStackDepth];
+#ifdef WTF_CHANGES
+  uintptr_t weight;        // Estimated bytes of allocation this sample stands for
+#endif
 };
 static PageHeapAllocator<StackTrace> stacktrace_allocator;
 static Span sampled_objects;
@@ -1239,14 +1290,24 @@ template <> class MapSelector<32> {
 // of free committed pages and so we should not release them back to the system yet.
 // - Otherwise, go through the list of free spans (from largest to smallest) and release up to a fraction of the free committed pages
 // back to the system.
-// - If the number of free committed pages reaches kMinimumFreeCommittedPageCount, we can stop the scavenging and block the
-// scavenging thread until the number of free committed pages goes above kMinimumFreeCommittedPageCount.
+// - If the number of free committed pages reaches the low watermark, we can stop the scavenging and block the
+// scavenging thread until the number of free committed pages goes above the low watermark.
+// - If the number of free committed pages is above the high watermark, a burst of allocation has ended (a page was
+// closed, say) rather than paused.  Then everything above the low watermark is released at once, without waiting for
+// the heap to stop growing.
 
 // Background thread wakes up every 5 seconds to scavenge as long as there is memory available to return to the system.
 static const int kScavengeTimerDelayInSeconds = 5;
 
+// Above the high watermark the thread does not wait for the next period, but still pauses this long between
+// scavenges, so it cannot spin on the page heap lock if a scavenge fails to get below the watermark.
+static const int kScavengeMinimumDelayInMilliseconds = 100;
+
 // Number of free committed pages that we want to keep around.
-static const size_t kMinimumFreeCommittedPageCount = 512;
+static size_t scavenger_low_watermark = 512;
+
+// Number of free committed pages above which we release down to the low watermark in one go.
+static size_t scavenger_high_watermark = 4096;
 
 // During a scavenge, we'll release up to a fraction of the free committed pages.
 #if OS(WINDOWS)
@@ -1407,6 +1468,7 @@ class TCMalloc_PageHeap {
   ALWAYS_INLINE void signalScavenger();
   void scavenge();
   ALWAYS_INLINE bool shouldContinueScavenging() const;
+  ALWAYS_INLINE bool isAboveHighWatermark() const;
 
 #if !HAVE(DISPATCH_H)
   static NO_RETURN void* runScavengerThread(void*);
@@ -1509,21 +1571,25 @@ ALWAYS_INLINE void TCMalloc_PageHeap::signalScavenger()
 
 void TCMalloc_PageHeap::scavenge() 
 {
+    const bool releaseAll = isAboveHighWatermark();
+
     // If we have to commit memory in the last 5 seconds, it means we don't have enough free committed pages
     // for the amount of allocations that we do.  So hold off on releasing memory back to the system.
-    if (pages_committed_since_last_scavenge_ > 0) {
-        pages_committed_since_last_scavenge_ = 0;
+    // The count starts over with each scavenge, whether or not this one releases everything.
+    const bool committedSinceLastScavenge = pages_committed_since_last_scavenge_ > 0;
+    pages_committed_since_last_scavenge_ = 0;
+    if (committedSinceLastScavenge && !releaseAll)
         return;
-    }
     Length pagesDecommitted = 0;
-    for (int i = kMaxPages; i >= 0; i--) {
+    bool reachedLowWatermark = false;
+    for (int i = kMaxPages; i >= 0 && !reachedLowWatermark; i--) {
         SpanList* slist = (static_cast<size_t>(i) == kMaxPages) ? &large_ : &free_[i];
-        if (!DLL_IsEmpty(&slist->normal)) {
+        while (!DLL_IsEmpty(&slist->normal)) {
             // Release the last span on the normal portion of this list
             Span* s = slist->normal.prev; 
             // Only decommit up to a fraction of the free committed pages if pages_allocated_since_last_scavenge_ > 0.
-            if ((pagesDecommitted + s->length) * kMaxScavengeAmountFactor > free_committed_pages_)
-                continue;
+            if (!releaseAll && (pagesDecommitted + s->length) * kMaxScavengeAmountFactor > free_committed_pages_)
+                break;
             DLL_Remove(s);
             TCMalloc_SystemRelease(reinterpret_cast<void*>(s->start << kPageShift),
                                    static_cast<size_t>(s->length << kPageShift));
@@ -1533,18 +1599,27 @@ void TCMalloc_PageHeap::scavenge()
             }
             DLL_Prepend(&slist->returned, s);
             // We can stop scavenging if the number of free committed pages left is less than or equal to the minimum number we want to keep around.
-            if (free_committed_pages_ <= kMinimumFreeCommittedPageCount + pagesDecommitted)
+            if (free_committed_pages_ <= scavenger_low_watermark + pagesDecommitted) {
+                reachedLowWatermark = true;
+                break;
+            }
+            // Otherwise, take one span from each list per scavenge, unless we are releasing everything we can.
+            if (!releaseAll)
                 break;
         }
     }
-    pages_committed_since_last_scavenge_ = 0;
     ASSERT(free_committed_pages_ >= pagesDecommitted);
     free_committed_pages_ -= pagesDecommitted;
 }
 
 ALWAYS_INLINE bool TCMalloc_PageHeap::shouldContinueScavenging() const 
 {
-    return free_committed_pages_ > kMinimumFreeCommittedPageCount; 
+    return free_committed_pages_ > scavenger_low_watermark; 
+}
+
+ALWAYS_INLINE bool TCMalloc_PageHeap::isAboveHighWatermark() const 
+{
+    return free_committed_pages_ > scavenger_high_watermark; 
 }
 
 #endif  // USE_BACKGROUND_THREAD_TO_SCAVENGE_MEMORY
@@ -2038,6 +2113,9 @@ static void ReleaseFreeList(Span* list, Span* returned) {
     DLL_Prepend(returned, s);
     TCMalloc_SystemRelease(reinterpret_cast<void*>(s->start << kPageShift),
                            static_cast<size_t>(s->length << kPageShift));
+#ifdef WTF_CHANGES
+    s->decommitted = true;
+#endif
   }
 }
 
@@ -2046,6 +2124,10 @@ void TCMalloc_PageHeap::ReleaseFreePages() {
     ReleaseFreeList(&free_[s].normal, &free_[s].returned);
   }
   ReleaseFreeList(&large_.normal, &large_.returned);
+#if USE_BACKGROUND_THREAD_TO_SCAVENGE_MEMORY
+  // Every free page is on a returned list now.
+  free_committed_pages_ = 0;
+#endif
   ASSERT(Check());
 }
 
@@ -2219,6 +2301,23 @@ class TCMalloc_Central_FreeList {
     return used_slots_ * num_objects_to_move[size_class_];
   }
 
+#ifdef WTF_CHANGES
+  // Gives the objects held in the transfer cache back to their spans, so
+  // that spans left with no objects in use return to the page heap.
+  void ReleaseTransferCache();
+
+  // Returns the number of pages in spans of this size class.
+  size_t span_pages() {
+    SpinLockHolder h(&lock_);
+    size_t result = 0;
+    for (Span* span = empty_.next; span != &empty_; span = span->next)
+      result += span->length;
+    for (Span* span = nonempty_.next; span != &nonempty_; span = span->next)
+      result += span->length;
+    return result;
+  }
+#endif
+
 #ifdef WTF_CHANGES
   template <class Finder, class Reader>
   void enumerateFreeObjects(Finder& finder, const Reader& reader, TCMalloc_Central_FreeList* remoteCentralFreeList)
@@ -2354,6 +2453,11 @@ static void sleep(unsigned seconds)
 {
     ::Sleep(seconds * 1000);
 }
+
+static void usleep(unsigned microseconds)
+{
+    ::Sleep(microseconds / 1000);
+}
 #endif
 
 void TCMalloc_PageHeap::scavengerThread()
@@ -2371,7 +2475,11 @@ void TCMalloc_PageHeap::scavengerThread()
           m_scavengeThreadActive = true;
           pthread_mutex_unlock(&m_scavengeMutex);
       }
-      sleep(kScavengeTimerDelayInSeconds);
+      // Memory freed in bulk is released without waiting for the next period.
+      if (isAboveHighWatermark())
+          usleep(kScavengeMinimumDelayInMilliseconds * 1000);
+      else
+          sleep(kScavengeTimerDelayInSeconds);
       {
           SpinLockHolder h(&pageheap_lock);
           pageheap->scavenge();
@@ -2556,6 +2664,18 @@ class LockInverter {
 };
 }
 
+#ifdef WTF_CHANGES
+void TCMalloc_Central_FreeList::ReleaseTransferCache() {
+  SpinLockHolder h(&lock_);
+  while (used_slots_ > 0) {
+    // ReleaseListToSpans releases the lock, so we have to make all the
+    // updates to the central list before calling it.
+    used_slots_--;
+    ReleaseListToSpans(tc_slots_[used_slots_].head);
+  }
+}
+#endif
+
 bool TCMalloc_Central_FreeList::ShrinkCache(int locked_size_class, bool force) {
   // Start with a quick check without taking a lock.
   if (cache_size_ == 0) return false;
@@ -3412,7 +3532,7 @@ static TCMallocGuard module_enter_exit_hook;
 // Helpers for the exported routines below
 //-------------------------------------------------------------------
 
-#ifndef WTF_CHANGES
+#ifndef NO_TCMALLOC_SAMPLES
 
 static Span* DoSampledAllocation(size_t size) {
 
@@ -3420,6 +3540,11 @@ static Span* DoSampledAllocation(size_t size) {
   StackTrace tmp;
   tmp.depth = GetStackTrace(tmp.stack, kMaxStackDepth, 1);
   tmp.size = size;
+#ifdef WTF_CHANGES
+  // An allocation smaller than the average gap between samples is sampled with a
+  // probability of about size / gap, so it stands for gap bytes.
+  tmp.weight = std::max(size, sample_period / 2);
+#endif
 
   SpinLockHolder h(&pageheap_lock);
   // Allocate span
@@ -3476,8 +3601,8 @@ static ALWAYS_INLINE void* do_malloc(size_t size) {
 
   // The following call forces module initialization
   TCMalloc_ThreadCache* heap = TCMalloc_ThreadCache::GetCache();
-#ifndef WTF_CHANGES
-  if ((FLAGS_tcmalloc_sample_parameter > 0) && heap->SampleAllocation(size)) {
+#ifndef NO_TCMALLOC_SAMPLES
+  if (UNLIKELY(FLAGS_tcmalloc_sample_parameter > 0) && heap->SampleAllocation(size)) {
     Span* span = DoSampledAllocation(size);
     if (span != NULL) {
       ret = SpanToMallocResult(span);
@@ -4432,9 +4557,27 @@ void releaseFastMallocFreeMemory()
         threadCache->Scavenge();
     }
 
+    // Objects parked in the central transfer caches keep their spans from being freed.
+    // Other threads' caches are left alone; only their owners may touch them.
+    for (unsigned cl = 0; cl < kNumClasses; ++cl)
+        central_cache[cl].ReleaseTransferCache();
+
     SpinLockHolder h(&pageheap_lock);
     pageheap->ReleaseFreePages();
 }
+
+#if USE_BACKGROUND_THREAD_TO_SCAVENGE_MEMORY
+void setFastMallocScavengerWatermarks(size_t lowWatermark, size_t highWatermark)
+{
+    SpinLockHolder h(&pageheap_lock);
+    scavenger_low_watermark = lowWatermark >> kPageShift;
+    scavenger_high_watermark = std::max(highWatermark >> kPageShift, scavenger_low_watermark);
+}
+#else
+void setFastMallocScavengerWatermarks(size_t, size_t)
+{
+}
+#endif
     
 FastMallocStatistics fastMallocStatistics()
 {
@@ -4444,9 +4587,13 @@ FastMallocStatistics fastMallocStatistics()
         statistics.heapSize = static_cast<size_t>(pageheap->SystemBytes());
         statistics.freeSizeInHeap = static_cast<size_t>(pageheap->FreeBytes());
         statistics.returnedSize = pageheap->ReturnedBytes();
-        statistics.freeSizeInCaches = 0;
-        for (TCMalloc_ThreadCache* threadCache = thread_heaps; threadCache ; threadCache = threadCache->next_)
-            statistics.freeSizeInCaches += threadCache->Size();
+        statistics.freeSizeInThreadCaches = 0;
+        statistics.threadCacheCount = 0;
+        for (TCMalloc_ThreadCache* threadCache = thread_heaps; threadCache ; threadCache = threadCache->next_) {
+            statistics.freeSizeInThreadCaches += threadCache->Size();
+            ++statistics.threadCacheCount;
+        }
+        statistics.freeSizeInCaches = statistics.freeSizeInThreadCaches;
     }
     for (unsigned cl = 0; cl < kNumClasses; ++cl) {
         const int length = central_cache[cl].length();
@@ -4456,6 +4603,93 @@ FastMallocStatistics fastMallocStatistics()
     return statistics;
 }
 
+size_t fastMallocSizeClassStatistics(FastMallocSizeClassStatistics* statistics, size_t count)
+{
+    count = std::min(count, kNumClasses);
+    for (size_t cl = 0; cl < count; ++cl) {
+        const size_t objectSize = ByteSizeForClass(cl);
+        statistics[cl].objectSize = objectSize;
+        statistics[cl].spanSize = central_cache[cl].span_pages() << kPageShift;
+        statistics[cl].freeSizeInCentralCache = objectSize * (central_cache[cl].length() + central_cache[cl].tc_length());
+        statistics[cl].freeSizeInThreadCaches = 0;
+    }
+
+    SpinLockHolder lockHolder(&pageheap_lock);
+    for (TCMalloc_ThreadCache* threadCache = thread_heaps; threadCache ; threadCache = threadCache->next_) {
+        for (size_t cl = 0; cl < count; ++cl)
+            statistics[cl].freeSizeInThreadCaches += ByteSizeForClass(cl) * threadCache->freelist_length(cl);
+    }
+    return kNumClasses;
+}
+
+void setFastMallocHeapProfilingInterval(size_t interval)
+{
+    // The parameter is twice the average gap, and is rounded up to a prime no larger
+    // than the last in primes_list.
+    const size_t maxInterval = primes_list[sizeof(primes_list) / sizeof(primes_list[0]) - 1] / 2;
+    FLAGS_tcmalloc_sample_parameter = static_cast<int64_t>(std::min(interval, maxInterval) * 2);
+}
+
+static int compareStackTraces(const void* a, const void* b)
+{
+    const StackTrace* first = static_cast<const StackTrace*>(a);
+    const StackTrace* second = static_cast<const StackTrace*>(b);
+    if (first->depth != second->depth)
+        return first->depth < second->depth ? -1 : 1;
+    return memcmp(first->stack, second->stack, first->depth * sizeof(void*));
+}
+
+static int compareHeapProfileEntries(const void* a, const void* b)
+{
+    const FastMallocHeapProfileEntry* first = static_cast<const FastMallocHeapProfileEntry*>(a);
+    const FastMallocHeapProfileEntry* second = static_cast<const FastMallocHeapProfileEntry*>(b);
+    if (first->estimatedSize != second->estimatedSize)
+        return first->estimatedSize > second->estimatedSize ? -1 : 1;
+    return 0;
+}
+
+void dumpFastMallocHeapProfile(FastMallocHeapProfileFunction function, void* context)
+{
+    if (!phinited)
+        return;
+
+    // The samples are copied out under the lock and grouped once it is released, since
+    // grouping them allocates. Leave room for a few samples taken in between.
+    size_t capacity;
+    {
+        SpinLockHolder lockHolder(&pageheap_lock);
+        capacity = DLL_Length(&sampled_objects) + 16;
+    }
+    StackTrace* traces = static_cast<StackTrace*>(fastMalloc(capacity * sizeof(StackTrace)));
+    size_t traceCount = 0;
+    {
+        SpinLockHolder lockHolder(&pageheap_lock);
+        for (Span* span = sampled_objects.next; span != &sampled_objects && traceCount < capacity; span = span->next)
+            traces[traceCount++] = *reinterpret_cast<StackTrace*>(span->objects);
+    }
+
+    qsort(traces, traceCount, sizeof(StackTrace), compareStackTraces);
+
+    FastMallocHeapProfileEntry* entries = static_cast<FastMallocHeapProfileEntry*>(fastMalloc(std::max<size_t>(traceCount, 1) * sizeof(FastMallocHeapProfileEntry)));
+    size_t entryCount = 0;
+    for (size_t i = 0; i < traceCount; ++i) {
+        if (entryCount && !compareStackTraces(&traces[i - 1], &traces[i])) {
+            entries[entryCount - 1].estimatedSize += traces[i].weight;
+            ++entries[entryCount - 1].sampleCount;
+            continue;
+        }
+        FastMallocHeapProfileEntry entry = { traces[i].weight, 1, traces[i].stack, traces[i].depth };
+        entries[entryCount++] = entry;
+    }
+
+    qsort(entries, entryCount, sizeof(FastMallocHeapProfileEntry), compareHeapProfileEntries);
+    for (size_t i = 0; i < entryCount; ++i)
+        function(entries[i], context);
+
+    fastFree(entries);
+    fastFree(traces);
+}
+
 } // namespace WTF
 #endif
 
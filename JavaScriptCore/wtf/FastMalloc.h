@@ -79,16 +79,55 @@ namespace WTF {
     void fastMallocAllow();
 #endif
 
+    // Returns free memory to the system: the calling thread's cache, the central caches
+    // and every free page in the heap. For memory pressure handlers; other threads'
+    // caches are not touched.
     void releaseFastMallocFreeMemory();
+
+    // Where the scavenger thread supports it, it keeps 'lowWatermark' bytes of free pages
+    // committed for reuse and gradually releases the rest. Once more than 'highWatermark'
+    // bytes are free, everything above the low watermark is released at once.
+    void setFastMallocScavengerWatermarks(size_t lowWatermark, size_t highWatermark);
     
     struct FastMallocStatistics {
         size_t heapSize;
         size_t freeSizeInHeap;
         size_t freeSizeInCaches;
         size_t returnedSize;
+        size_t freeSizeInThreadCaches; // The part of freeSizeInCaches held by per-thread caches.
+        size_t threadCacheCount;
     };
     FastMallocStatistics fastMallocStatistics();
 
+    // How the memory of one size class is used. Requests too large for any size class
+    // are given whole pages straight from the page heap, and are not included.
+    struct FastMallocSizeClassStatistics {
+        size_t objectSize;
+        size_t spanSize; // Pages held by the size class, whether or not their objects are in use.
+        size_t freeSizeInCentralCache;
+        size_t freeSizeInThreadCaches;
+    };
+    // Fills in up to 'count' entries, smallest size class first, and returns the number of size classes.
+    size_t fastMallocSizeClassStatistics(FastMallocSizeClassStatistics*, size_t count);
+
+    // The sampling heap profiler. While it is on, about one allocation in every 'interval'
+    // bytes allocated is sampled, and the stack that made it is kept until it is freed.
+    // A sampled allocation is given pages of its own, so the interval should be large
+    // compared to the page size. Zero turns sampling off; allocations sampled before
+    // then are still reported until they are freed.
+    void setFastMallocHeapProfilingInterval(size_t interval);
+
+    struct FastMallocHeapProfileEntry {
+        size_t estimatedSize; // Scaled up to account for the allocations sampling missed.
+        size_t sampleCount;
+        void* const* stack; // Return addresses, innermost first.
+        size_t stackDepth;
+    };
+    typedef void (*FastMallocHeapProfileFunction)(const FastMallocHeapProfileEntry&, void* context);
+    // Calls 'function' once for each stack that made sampled allocations which are still
+    // live, in decreasing order of estimated size.
+    void dumpFastMallocHeapProfile(FastMallocHeapProfileFunction function, void* context);
+
     // This defines a type which holds an unsigned integer and is the same
     // size as the minimally aligned memory allocation.
     typedef unsigned long long AllocAlignmentInteger;
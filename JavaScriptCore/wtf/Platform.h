@@ -719,6 +719,7 @@
 
 #define HAVE_ERRNO_H 1
 #define HAVE_LANGINFO_H 0
+#define HAVE_MADV_DONTNEED 1
 #define HAVE_MMAP 1
 #define HAVE_SBRK 1
 #define HAVE_STRINGS_H 1
@@ -734,6 +735,9 @@
 #if !OS(HAIKU)
 #define HAVE_LANGINFO_H 1
 #endif
+#if OS(LINUX)
+#define HAVE_MADV_DONTNEED 1
+#endif
 #define HAVE_MMAP 1
 #define HAVE_SBRK 1
 #define HAVE_STRINGS_H 1
@@ -926,6 +930,31 @@ on MinGW. See https://bugs.webkit.org/show_bug.cgi?id=29268 */
 #endif
 #endif
 
+/* Counts how often each get_by_id and put_by_id site in JIT code runs and how often it misses
+   its inline caches, and prints the busiest sites when the program exits. */
+#if !defined(ENABLE_JIT_PROPERTY_ACCESS_STATISTICS)
+#define ENABLE_JIT_PROPERTY_ACCESS_STATISTICS 0
+#endif
+#if ENABLE(JIT_PROPERTY_ACCESS_STATISTICS) && !ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS)
+#error "JIT_PROPERTY_ACCESS_STATISTICS requires JIT_OPTIMIZE_PROPERTY_ACCESS"
+#endif
+
+/* Nursery collections depend on write barriers in the runtime and the interpreter. Stores
+   emitted by the JIT do not record themselves in the collector's card table yet. */
+#if !defined(ENABLE_GENERATIONAL_COLLECTION) && !ENABLE(JIT)
+#define ENABLE_GENERATIONAL_COLLECTION 1
+#endif
+
+#if ENABLE(GENERATIONAL_COLLECTION) && ENABLE(JIT)
+#error "GENERATIONAL_COLLECTION requires the interpreter"
+#endif
+
+/* Parallel marking sets mark bits with GCC's atomic builtins. It is off at runtime
+   unless a marking thread count greater than one is configured. */
+#if !defined(ENABLE_PARALLEL_MARKING) && USE(PTHREADS) && COMPILER(GCC) && !ENABLE(SINGLE_THREADED)
+#define ENABLE_PARALLEL_MARKING 1
+#endif
+
 #if CPU(X86) && COMPILER(MSVC)
 #define JSC_HOST_CALL __fastcall
 #elif CPU(X86) && COMPILER(GCC)
@@ -944,6 +973,16 @@ on MinGW. See https://bugs.webkit.org/show_bug.cgi?id=29268 */
     #define WTF_USE_INTERPRETER 1
 #endif
 
+/* Replaces common pairs of adjacent instructions, such as a get_by_id whose result is called
+   straight away, with superinstructions that skip the dispatch between them. */
+#if !defined(ENABLE_INTERPRETER_SUPERINSTRUCTIONS) && USE(INTERPRETER) && !ENABLE(JIT)
+#define ENABLE_INTERPRETER_SUPERINSTRUCTIONS 1
+#endif
+
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS) && ENABLE(JIT)
+#error "INTERPRETER_SUPERINSTRUCTIONS cannot be enabled together with the JIT"
+#endif
+
 /* Yet Another Regex Runtime. */
 #if !defined(ENABLE_YARR_JIT)
 
@@ -987,6 +1026,12 @@ on MinGW. See https://bugs.webkit.org/show_bug.cgi?id=29268 */
 #define ENABLE_ASSEMBLER_WX_EXCLUSIVE 0
 #endif
 
+/* Compiled regular expressions are shared across the process and compiled on a background
+   thread, which writes to executable memory while other threads run code from it. */
+#if !defined(ENABLE_YARR_JIT_CACHE) && ENABLE(YARR_JIT) && !ENABLE(ASSEMBLER_WX_EXCLUSIVE) && !ENABLE(SINGLE_THREADED)
+#define ENABLE_YARR_JIT_CACHE 1
+#endif
+
 #if !defined(ENABLE_PAN_SCROLLING) && OS(WINDOWS)
 #define ENABLE_PAN_SCROLLING 1
 #endif
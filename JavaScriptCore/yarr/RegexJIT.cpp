@@ -1355,11 +1355,11 @@ public:
         generateDisjunction(m_pattern.m_body);
     }
 
-    void compile(JSGlobalData* globalData, RegexCodeBlock& jitObject)
+    void compile(ExecutableAllocator& executableAllocator, RegexCodeBlock& jitObject)
     {
         generate();
 
-        LinkBuffer patchBuffer(this, globalData->executableAllocator.poolForSize(size()));
+        LinkBuffer patchBuffer(this, executableAllocator.poolForSize(size()));
 
         for (unsigned i = 0; i < m_backtrackRecords.size(); ++i)
             patchBuffer.patch(m_backtrackRecords[i].dataLabel, patchBuffer.locationOf(m_backtrackRecords[i].backtrackLocation));
@@ -1378,7 +1378,7 @@ private:
     bool m_generationFailed;
 };
 
-void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const UString& patternString, unsigned& numSubpatterns, const char*& error, bool ignoreCase, bool multiline)
+static void jitCompileRegex(ExecutableAllocator& executableAllocator, RegexCodeBlock& jitObject, const UString& patternString, unsigned& numSubpatterns, const char*& error, bool ignoreCase, bool multiline)
 {
     RegexPattern pattern(ignoreCase, multiline);
 
@@ -1388,7 +1388,7 @@ void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const
     numSubpatterns = pattern.m_numSubpatterns;
 
     RegexGenerator generator(pattern);
-    generator.compile(globalData, jitObject);
+    generator.compile(executableAllocator, jitObject);
 
     if (generator.generationFailed()) {
         JSRegExpIgnoreCaseOption ignoreCaseOption = ignoreCase ? JSRegExpIgnoreCase : JSRegExpDoNotIgnoreCase;
@@ -1397,6 +1397,185 @@ void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const
     }
 }
 
+void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const UString& patternString, unsigned& numSubpatterns, const char*& error, bool ignoreCase, bool multiline)
+{
+    jitCompileRegex(globalData->executableAllocator, jitObject, patternString, numSubpatterns, error, ignoreCase, multiline);
+}
+
+#if ENABLE(YARR_JIT_CACHE)
+
+// Cached entries are evicted, least recently used first, once they cost more than this many
+// bytes. Code still referenced by a RegExp is never evicted.
+static const size_t defaultRegexCodeCacheCapacity = 512 * 1024;
+
+// Charged for every entry on top of its code, for the entry itself, its hash table slot and
+// the interpreter's compiled form when the JIT cannot handle the pattern.
+static const size_t cachedRegexOverhead = 128;
+
+static size_t cachedRegexCost(const UString& pattern)
+{
+    // The key and the entry each hold a copy of the pattern.
+    return sizeof(CachedRegex) + cachedRegexOverhead + 2 * pattern.size() * sizeof(UChar);
+}
+
+CachedRegex::CachedRegex(const UString& pattern, bool ignoreCase, bool multiline)
+    : m_pattern(pattern.data(), pattern.size()) // A private copy, since UString is not thread-safe.
+    , m_ignoreCase(ignoreCase)
+    , m_multiline(multiline)
+    , m_numSubpatterns(0)
+    , m_error(0)
+    , m_hasFinishedCompiling(false)
+    , m_cost(cachedRegexCost(pattern))
+    , m_previous(0)
+    , m_next(0)
+{
+}
+
+bool CachedRegex::hasFinishedCompiling()
+{
+    if (!m_hasFinishedCompiling)
+        return false;
+
+    // Taking the lock the compiler thread released makes its writes to the code visible here.
+    MutexLocker locker(RegexCodeCache::shared().m_lock);
+    return true;
+}
+
+RegexCodeCache& RegexCodeCache::shared()
+{
+    // Created by initializeThreading(), before any other thread can use it.
+    static RegexCodeCache* cache = new RegexCodeCache;
+    return *cache;
+}
+
+RegexCodeCache::RegexCodeCache()
+    : m_mostRecentlyUsed(0)
+    , m_leastRecentlyUsed(0)
+    , m_capacity(defaultRegexCodeCacheCapacity)
+    , m_size(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_compilerThread(0)
+{
+}
+
+static UString cacheKey(const UString& pattern, bool ignoreCase, bool multiline)
+{
+    Vector<UChar, 64> key;
+    key.append(static_cast<UChar>('0' + (ignoreCase ? 1 : 0) + (multiline ? 2 : 0)));
+    key.append(pattern.data(), pattern.size());
+    return UString(key.data(), key.size());
+}
+
+PassRefPtr<CachedRegex> RegexCodeCache::get(const UString& pattern, bool ignoreCase, bool multiline)
+{
+    MutexLocker locker(m_lock);
+
+    // The key is created and destroyed under the lock, since keys in the table are
+    // reference counted by whichever thread is updating the table.
+    UString key = cacheKey(pattern, ignoreCase, multiline);
+    pair<HashMap<RefPtr<UString::Rep>, RefPtr<CachedRegex> >::iterator, bool> result = m_cache.add(key.rep(), 0);
+    if (!result.second) {
+        ++m_hits;
+        CachedRegex* regex = result.first->second.get();
+        removeFromRecencyList(regex);
+        addToRecencyList(regex);
+        return regex;
+    }
+
+    ++m_misses;
+    RefPtr<CachedRegex> regex = adoptRef(new CachedRegex(pattern, ignoreCase, multiline));
+    result.first->second = regex;
+    addToRecencyList(regex.get());
+    m_size += regex->m_cost;
+
+    if (!m_compilerThread)
+        m_compilerThread = createThread(compilerThreadEntryPoint, this, "JavaScriptCore::RegexCompiler");
+    m_queue.append(regex);
+    m_queueCondition.signal();
+    return regex.release();
+}
+
+void RegexCodeCache::setCapacity(size_t capacity)
+{
+    MutexLocker locker(m_lock);
+    m_capacity = capacity;
+}
+
+void* RegexCodeCache::compilerThreadEntryPoint(void* cache)
+{
+    static_cast<RegexCodeCache*>(cache)->compilerThreadMain();
+    return 0;
+}
+
+void RegexCodeCache::compilerThreadMain()
+{
+    while (true) {
+        RefPtr<CachedRegex> regex;
+        {
+            MutexLocker locker(m_lock);
+            while (m_queue.isEmpty())
+                m_queueCondition.wait(m_lock);
+            regex = m_queue.first();
+            m_queue.removeFirst();
+        }
+
+        // Only this thread touches m_executableAllocator, and only this thread frees
+        // cached code, so the pools' reference counts are never updated concurrently.
+        jitCompileRegex(m_executableAllocator, regex->m_code, regex->m_pattern, regex->m_numSubpatterns, regex->m_error, regex->m_ignoreCase, regex->m_multiline);
+
+        MutexLocker locker(m_lock);
+        regex->m_cost += regex->m_code.size();
+        m_size += regex->m_code.size();
+        regex->m_hasFinishedCompiling = true;
+        regex = 0;
+        prune();
+    }
+}
+
+void RegexCodeCache::prune()
+{
+    CachedRegex* regex = m_leastRecentlyUsed;
+    while (regex && m_size > m_capacity) {
+        CachedRegex* next = regex->m_previous;
+        // Skip code in use by a RegExp, or queued for compilation.
+        if (regex->m_hasFinishedCompiling && regex->hasOneRef()) {
+            removeFromRecencyList(regex);
+            m_size -= regex->m_cost;
+            UString key = cacheKey(regex->m_pattern, regex->m_ignoreCase, regex->m_multiline);
+            m_cache.remove(key.rep());
+        }
+        regex = next;
+    }
+}
+
+void RegexCodeCache::addToRecencyList(CachedRegex* regex)
+{
+    ASSERT(!regex->m_previous && !regex->m_next);
+    regex->m_next = m_mostRecentlyUsed;
+    if (m_mostRecentlyUsed)
+        m_mostRecentlyUsed->m_previous = regex;
+    else
+        m_leastRecentlyUsed = regex;
+    m_mostRecentlyUsed = regex;
+}
+
+void RegexCodeCache::removeFromRecencyList(CachedRegex* regex)
+{
+    if (regex->m_previous)
+        regex->m_previous->m_next = regex->m_next;
+    else
+        m_mostRecentlyUsed = regex->m_next;
+    if (regex->m_next)
+        regex->m_next->m_previous = regex->m_previous;
+    else
+        m_leastRecentlyUsed = regex->m_previous;
+    regex->m_previous = 0;
+    regex->m_next = 0;
+}
+
+#endif // ENABLE(YARR_JIT_CACHE)
+
 }}
 
 #endif
@@ -34,6 +34,13 @@
 #include "RegexPattern.h"
 #include <UString.h>
 
+#if ENABLE(YARR_JIT_CACHE)
+#include "ExecutableAllocator.h"
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
+#include <wtf/Threading.h>
+#endif
+
 #include <pcre.h>
 struct JSRegExp; // temporary, remove when fallback is removed.
 
@@ -70,6 +77,7 @@ public:
 
     bool operator!() { return !m_ref.m_code.executableAddress(); }
     void set(MacroAssembler::CodeRef ref) { m_ref = ref; }
+    size_t size() const { return m_ref.m_size; }
 
     int execute(const UChar* input, unsigned start, unsigned length, int* output)
     {
@@ -91,6 +99,86 @@ inline int executeRegex(RegexCodeBlock& jitObject, const UChar* input, unsigned
     return jitObject.execute(input, start, length, output);
 }
 
+#if ENABLE(YARR_JIT_CACHE)
+
+// Compiled code for one (pattern, flags) pair, shared by every RegExp in the process that
+// uses them. The code is compiled on a background thread; until hasFinishedCompiling()
+// returns true, only the pattern may be used.
+class CachedRegex : public ThreadSafeShared<CachedRegex> {
+public:
+    bool hasFinishedCompiling();
+
+    RegexCodeBlock& code() { ASSERT(m_hasFinishedCompiling); return m_code; }
+    unsigned numSubpatterns() const { ASSERT(m_hasFinishedCompiling); return m_numSubpatterns; }
+    const char* error() const { ASSERT(m_hasFinishedCompiling); return m_error; }
+
+private:
+    friend class RegexCodeCache;
+
+    CachedRegex(const UString& pattern, bool ignoreCase, bool multiline);
+
+    UString m_pattern;
+    bool m_ignoreCase;
+    bool m_multiline;
+
+    RegexCodeBlock m_code;
+    unsigned m_numSubpatterns;
+    const char* m_error;
+    volatile bool m_hasFinishedCompiling;
+
+    // What this entry counts against the cache's capacity.
+    size_t m_cost;
+
+    // The cache's recency list, most recently used first.
+    CachedRegex* m_previous;
+    CachedRegex* m_next;
+};
+
+class RegexCodeCache : public Noncopyable {
+public:
+    static RegexCodeCache& shared();
+
+    // Returns the cached code for a pattern, queueing it for compilation on a miss.
+    PassRefPtr<CachedRegex> get(const UString& pattern, bool ignoreCase, bool multiline);
+
+    // Bytes the cache may keep alive for entries no RegExp is using. Each entry is charged
+    // for its executable code, its copies of the pattern and a fixed overhead, so patterns
+    // that fall back to the interpreter or fail to compile count against it too.
+    void setCapacity(size_t);
+
+    unsigned hits() const { return m_hits; }
+    unsigned misses() const { return m_misses; }
+
+private:
+    friend class CachedRegex;
+
+    RegexCodeCache();
+
+    static void* compilerThreadEntryPoint(void*);
+    void compilerThreadMain();
+    void prune();
+
+    void addToRecencyList(CachedRegex*);
+    void removeFromRecencyList(CachedRegex*);
+
+    Mutex m_lock;
+    ThreadCondition m_queueCondition;
+    Deque<RefPtr<CachedRegex> > m_queue;
+    HashMap<RefPtr<UString::Rep>, RefPtr<CachedRegex> > m_cache;
+    ExecutableAllocator m_executableAllocator;
+
+    CachedRegex* m_mostRecentlyUsed;
+    CachedRegex* m_leastRecentlyUsed;
+
+    size_t m_capacity;
+    size_t m_size;
+    unsigned m_hits;
+    unsigned m_misses;
+    ThreadIdentifier m_compilerThread;
+};
+
+#endif // ENABLE(YARR_JIT_CACHE)
+
 } } // namespace JSC::Yarr
 
 #endif
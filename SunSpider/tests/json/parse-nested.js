@@ -0,0 +1,18 @@
+// Deeply nested, irregular objects, such as configuration data or a document tree.
+
+function makeTree(depth, breadth, seed)
+{
+    if (!depth)
+        return seed % 2 ? "leaf" + seed : seed;
+    var node = { name: "node" + seed, children: [] };
+    if (seed % 3 == 0)
+        node.attributes = { visible: true, order: seed };
+    for (var i = 0; i < breadth; ++i)
+        node.children.push(makeTree(depth - 1, breadth, seed * breadth + i));
+    return node;
+}
+
+var text = JSON.stringify(makeTree(7, 4, 1));
+var total = 0;
+for (var n = 0; n < 8; ++n)
+    total += JSON.parse(text).children.length;
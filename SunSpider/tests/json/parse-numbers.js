@@ -0,0 +1,14 @@
+// Arrays of numbers, such as coordinates or time series.
+
+var values = [];
+for (var i = 0; i < 20000; ++i) {
+    values.push(i);
+    values.push(-i * 7);
+    values.push(i / 8);
+    values.push(i * 1.0e-3 + 0.5);
+}
+var source = JSON.stringify({ series: values, scale: 1.5e10 });
+
+var sum = 0;
+for (var n = 0; n < 8; ++n)
+    sum += JSON.parse(source).series.length;
@@ -0,0 +1,18 @@
+// Long strings, some with escapes and non-ASCII characters.
+
+var paragraphs = [];
+for (var i = 0; i < 400; ++i) {
+    var text = "";
+    for (var k = 0; k < 20; ++k)
+        text += "Lorem ipsum dolor sit amet, consectetur adipiscing elit " + k + ". ";
+    if (i % 4 == 0)
+        text += "She said \"hello\" \\ and left.\n";
+    if (i % 5 == 0)
+        text += "café 日本語 ☃";
+    paragraphs.push(text);
+}
+var source = JSON.stringify({ paragraphs: paragraphs });
+
+var length = 0;
+for (var n = 0; n < 10; ++n)
+    length += JSON.parse(source).paragraphs.length;
@@ -0,0 +1,19 @@
+// Serializing a list of records with the same fields, as a client sends them back.
+
+var records = [];
+for (var i = 0; i < 2000; ++i) {
+    records.push({
+        id: 100000 + i,
+        user: "user" + (i % 97),
+        title: "Item number " + i,
+        score: (i * 37 % 1000) / 10,
+        published: i % 3 != 0,
+        tags: ["tag" + (i % 5), "tag" + (i % 11)],
+        location: { lat: 37 + (i % 100) / 1000, lng: -122 - (i % 50) / 1000 },
+        parent: i % 4 ? null : i - 1
+    });
+}
+
+var length = 0;
+for (var n = 0; n < 10; ++n)
+    length += JSON.stringify({ status: "ok", results: records }).length;
@@ -0,0 +1,17 @@
+// Serializing long strings, some of which need escaping.
+
+var paragraphs = [];
+for (var i = 0; i < 400; ++i) {
+    var text = "";
+    for (var k = 0; k < 20; ++k)
+        text += "Lorem ipsum dolor sit amet, consectetur adipiscing elit " + k + ". ";
+    if (i % 4 == 0)
+        text += "She said \"hello\" \\ and left.\n\t";
+    if (i % 5 == 0)
+        text += "café 日本語 \u0001";
+    paragraphs.push(text);
+}
+
+var length = 0;
+for (var n = 0; n < 10; ++n)
+    length += JSON.stringify(paragraphs).length;
@@ -40,6 +40,11 @@ using namespace JSC;
 
 namespace WebCore {
 
+// Collections started by the GC timer leave dead objects to be destroyed in short
+// slices, so that a large heap doesn't block the main thread for the whole sweep.
+static const double sweepSliceTime = 0.005;
+static const double sweepSliceInterval = 0.01;
+
 static void* collect(void*)
 {
     JSLock lock(SilenceAssertionsOnly);
@@ -55,6 +60,7 @@ GCController& gcController()
 
 GCController::GCController()
     : m_GCTimer(this, &GCController::gcTimerFired)
+    , m_sweepTimer(this, &GCController::sweepTimerFired)
 {
 }
 
@@ -66,7 +72,17 @@ void GCController::garbageCollectSoon()
 
 void GCController::gcTimerFired(Timer<GCController>*)
 {
-    collect(0);
+    JSLock lock(SilenceAssertionsOnly);
+    JSDOMWindow::commonJSGlobalData()->heap.collectAllGarbage(IncrementalSweep);
+    if (!m_sweepTimer.isActive())
+        m_sweepTimer.startRepeating(sweepSliceInterval);
+}
+
+void GCController::sweepTimerFired(Timer<GCController>*)
+{
+    JSLock lock(SilenceAssertionsOnly);
+    if (!JSDOMWindow::commonJSGlobalData()->heap.sweepIncrementally(sweepSliceTime))
+        m_sweepTimer.stop();
 }
 
 void GCController::garbageCollectNow()
@@ -29,7 +29,15 @@
 #include "GCController.h"
 #include "HTMLPlugInElement.h"
 #include "InspectorTimelineAgent.h"
+#include "JSDOMWindow.h"
 #include "JSDocument.h"
+#include "JSElement.h"
+#include "JSEvent.h"
+#include "JSHTMLDocument.h"
+#include "JSHTMLElement.h"
+#include "JSLocation.h"
+#include "JSNavigator.h"
+#include "JSNode.h"
 #include "NP_jsobject.h"
 #include "Page.h"
 #include "PageGroup.h"
@@ -52,6 +60,22 @@ namespace WebCore {
 void ScriptController::initializeThreading()
 {
     JSC::initializeThreading();
+
+    // Share the property names that nearly every page looks up between all JSGlobalData
+    // instances. This has to happen before the first JSGlobalData is created.
+    static bool addedSharedIdentifiers = false;
+    if (!addedSharedIdentifiers) {
+        addJSDOMWindowSharedIdentifiers();
+        addJSDocumentSharedIdentifiers();
+        addJSHTMLDocumentSharedIdentifiers();
+        addJSNodeSharedIdentifiers();
+        addJSElementSharedIdentifiers();
+        addJSHTMLElementSharedIdentifiers();
+        addJSEventSharedIdentifiers();
+        addJSLocationSharedIdentifiers();
+        addJSNavigatorSharedIdentifiers();
+        addedSharedIdentifiers = true;
+    }
 }
 
 ScriptController::ScriptController(Frame* frame)
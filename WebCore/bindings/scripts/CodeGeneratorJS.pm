@@ -36,6 +36,7 @@ my %headerIncludes = ();
 my @implContentHeader = ();
 my @implContent = ();
 my %implIncludes = ();
+my @implHashTableNames = ();
 my @depsContent = ();
 my $numCachedAttributes = 0;
 my $currentCachedAttribute = 0;
@@ -804,6 +805,7 @@ sub GenerateHeader
     if ($usesToJSNewlyCreated{$interfaceName}) {
         push(@headerContent, "JSC::JSValue toJSNewlyCreated(JSC::ExecState*, JSDOMGlobalObject*, $interfaceName*);\n");
     }
+    push(@headerContent, "void add${className}SharedIdentifiers();\n");
     
     push(@headerContent, "\n");
 
@@ -936,6 +938,7 @@ sub GenerateImplementation
     AddIncludesForType($interfaceName);
 
     @implContent = ();
+    @implHashTableNames = ();
 
     push(@implContent, "\nusing namespace JSC;\n\n");
     push(@implContent, "namespace WebCore {\n\n");
@@ -1781,6 +1784,14 @@ sub GenerateImplementation
         }
     }
 
+    # Lets the embedder make the property names of this class shared identifiers at startup.
+    push(@implContent, "\nvoid add${className}SharedIdentifiers()\n");
+    push(@implContent, "{\n");
+    foreach my $hashTableName (@implHashTableNames) {
+        push(@implContent, "    addSharedIdentifiers($hashTableName);\n");
+    }
+    push(@implContent, "}\n");
+
     push(@implContent, "\n}\n");
 
     push(@implContent, "\n#endif // ${conditionalString}\n") if $conditional;
@@ -2150,6 +2161,7 @@ tableSizeLoop:
     push(@implContent, "};\n\n");
     my $perfectSizeMask = $perfectSize - 1;
     my $compactSizeMask = $numEntries - 1;
+    push(@implHashTableNames, $name);
     push(@implContent, "static JSC_CONST_HASHTABLE HashTable $name =\n");
     push(@implContent, "#if ENABLE(PERFECT_HASH_SIZE)\n");
     push(@implContent, "    { $perfectSizeMask, $nameEntries, 0 };\n");
@@ -121,6 +121,7 @@ namespace WebCore {
 using namespace HTMLNames;
 
 // #define STYLE_SHARING_STATS 1
+// #define ANCESTOR_FILTER_STATS 1
 
 #define HANDLE_INHERIT(prop, Prop) \
 if (isInherit) { \
@@ -349,12 +350,15 @@ if (id == propID) { \
     return; \
 }
 
+enum SelectorFeatureKind { IdFeature, ClassFeature, AttributeFeature };
+
 class CSSRuleSet : public Noncopyable {
 public:
     CSSRuleSet();
     ~CSSRuleSet();
     
     typedef HashMap<AtomicStringImpl*, CSSRuleDataList*> AtomRuleMap;
+    typedef HashMap<AtomicStringImpl*, unsigned> FeatureMap;
     
     void addRulesFromSheet(CSSStyleSheet*, const MediaQueryEvaluator&, CSSStyleSelector* = 0);
     
@@ -362,6 +366,10 @@ public:
     void addToRuleSet(AtomicStringImpl* key, AtomRuleMap& map,
                       CSSStyleRule* rule, CSSSelector* sel);
     
+    void collectFeatures(CSSSelector*);
+    void collectSimpleSelectorFeatures(CSSSelector*, unsigned use);
+    unsigned featureUse(SelectorFeatureKind, AtomicStringImpl*) const;
+    
     CSSRuleDataList* getIDRules(AtomicStringImpl* key) { m_idRules.checkConsistency(); return m_idRules.get(key); }
     CSSRuleDataList* getClassRules(AtomicStringImpl* key) { m_classRules.checkConsistency(); return m_classRules.get(key); }
     CSSRuleDataList* getTagRules(AtomicStringImpl* key) { m_tagRules.checkConsistency(); return m_tagRules.get(key); }
@@ -373,8 +381,139 @@ public:
     AtomRuleMap m_tagRules;
     CSSRuleDataList* m_universalRules;
     unsigned m_ruleCount;
+    
+    // The ids, classes and attribute names in the selectors, mapped to SelectorFeatureUse flags.
+    FeatureMap m_idFeatures;
+    FeatureMap m_classFeatures;
+    FeatureMap m_attributeFeatures;
+};
+
+// A counting Bloom filter of the ids, classes and tag names of the ancestors of the elements being
+// resolved. Each identifier sets two counters, taken from the low and high bits of its hash.
+class AncestorIdentifierFilter : public Noncopyable {
+public:
+    AncestorIdentifierFilter() { clear(); }
+
+    void add(unsigned hash)
+    {
+        increment(firstSlot(hash));
+        increment(secondSlot(hash));
+    }
+
+    void remove(unsigned hash)
+    {
+        decrement(firstSlot(hash));
+        decrement(secondSlot(hash));
+    }
+
+    bool mayContain(unsigned hash) const { return m_counts[firstSlot(hash)] && m_counts[secondSlot(hash)]; }
+
+    void clear() { memset(m_counts, 0, sizeof(m_counts)); }
+
+private:
+    static const unsigned keyBits = 12;
+    static const unsigned tableSize = 1 << keyBits;
+    static const unsigned keyMask = tableSize - 1;
+    // A counter that overflowed no longer knows how many identifiers it stands for, so it stays set.
+    static const unsigned char maximumCount = 0xff;
+
+    static unsigned firstSlot(unsigned hash) { return hash & keyMask; }
+    static unsigned secondSlot(unsigned hash) { return (hash >> keyBits) & keyMask; }
+
+    void increment(unsigned slot)
+    {
+        if (m_counts[slot] != maximumCount)
+            ++m_counts[slot];
+    }
+
+    void decrement(unsigned slot)
+    {
+        ASSERT(m_counts[slot]);
+        if (m_counts[slot] != maximumCount)
+            --m_counts[slot];
+    }
+
+    unsigned char m_counts[tableSize];
 };
 
+// Ids, classes and tag names share the filter, so "div" the tag and "div" the class hash differently.
+static const unsigned cTagNameSalt = 13;
+static const unsigned cIdSalt = 17;
+static const unsigned cClassSalt = 19;
+
+#ifdef ANCESTOR_FILTER_STATS
+static unsigned selectorsRejectedByAncestorFilter = 0;
+static unsigned selectorsCheckedInFull = 0;
+#endif
+
+#ifdef STYLE_SHARING_STATS
+static unsigned sharingLookups = 0;
+static unsigned sharedWithSiblingOrCousin = 0;
+static unsigned sharedFromCache = 0;
+#endif
+
+static inline void collectSelectorIdentifierHashes(CSSSelector* selector, unsigned*& hash, const unsigned* end)
+{
+    unsigned salted = 0;
+    if (selector->m_match == CSSSelector::Id && !selector->m_value.isEmpty())
+        salted = selector->m_value.impl()->hash() * cIdSalt;
+    else if (selector->m_match == CSSSelector::Class && !selector->m_value.isEmpty())
+        salted = selector->m_value.impl()->hash() * cClassSalt;
+    if (salted && hash != end)
+        *hash++ = salted;
+
+    const AtomicString& localName = selector->m_tag.localName();
+    if (localName != starAtom && hash != end) {
+        salted = localName.impl()->hash() * cTagNameSalt;
+        if (salted)
+            *hash++ = salted;
+    }
+}
+
+void CSSRuleData::collectDescendantSelectorIdentifierHashes()
+{
+    unsigned* hash = m_descendantSelectorIdentifierHashes;
+    const unsigned* end = hash + maximumIdentifierCount;
+
+    // Skip the compound selector that matches the element itself, and those that match siblings;
+    // everything to the left of a descendant or child combinator has to match an ancestor.
+    CSSSelector* selector = m_selector;
+    CSSSelector::Relation relation = selector->relation();
+    bool matchesAncestor = false;
+    for (selector = selector->tagHistory(); selector && hash != end; selector = selector->tagHistory()) {
+        switch (relation) {
+        case CSSSelector::Descendant:
+        case CSSSelector::Child:
+            matchesAncestor = true;
+            break;
+        case CSSSelector::DirectAdjacent:
+        case CSSSelector::IndirectAdjacent:
+            matchesAncestor = false;
+            break;
+        case CSSSelector::SubSelector:
+            break;
+        }
+        if (matchesAncestor)
+            collectSelectorIdentifierHashes(selector, hash, end);
+        relation = selector->relation();
+    }
+    if (hash != end)
+        *hash = 0;
+}
+
+static inline void collectElementIdentifierHashes(Element* element, Vector<unsigned, 4>& identifierHashes)
+{
+    identifierHashes.append(element->localName().impl()->hash() * cTagNameSalt);
+    if (element->hasID() && element->getIDAttribute().impl())
+        identifierHashes.append(element->getIDAttribute().impl()->hash() * cIdSalt);
+    if (element->hasClass() && element->isStyledElement()) {
+        const SpaceSplitString& classNames = static_cast<StyledElement*>(element)->classNames();
+        size_t size = classNames.size();
+        for (size_t i = 0; i < size; ++i)
+            identifierHashes.append(classNames[i].impl()->hash() * cClassSalt);
+    }
+}
+
 static CSSRuleSet* defaultStyle;
 static CSSRuleSet* defaultQuirksStyle;
 static CSSRuleSet* defaultPrintStyle;
@@ -692,16 +831,117 @@ void CSSStyleSelector::matchRules(CSSRuleSet* rules, int& firstRuleIndex, int& l
     }
 }
 
+void CSSStyleSelector::pushParent(Element* parent)
+{
+    if (!m_ancestorIdentifierFilter)
+        m_ancestorIdentifierFilter.set(new AncestorIdentifierFilter);
+
+    Node* grandparent = parent->parentNode();
+    if (m_parentStack.isEmpty() || m_parentStack.last().element != grandparent) {
+        // The recalc started below the root of the document, or has moved to a part of the tree
+        // the stack does not describe. Start over from the ancestors of this parent.
+        clearParentStack();
+        Vector<Element*, 32> ancestors;
+        for (Node* n = grandparent; n && n->isElementNode(); n = n->parentNode())
+            ancestors.append(static_cast<Element*>(n));
+        for (size_t i = ancestors.size(); i; --i)
+            pushParentFrame(ancestors[i - 1], true);
+    }
+    pushParentFrame(parent, false);
+}
+
+void CSSStyleSelector::popParent(Element* parent)
+{
+    if (m_parentStack.isEmpty() || m_parentStack.last().element != parent)
+        return;
+
+    const Vector<unsigned, 4>& identifierHashes = m_parentStack.last().identifierHashes;
+    size_t size = identifierHashes.size();
+    for (size_t i = 0; i < size; ++i)
+        m_ancestorIdentifierFilter->remove(identifierHashes[i]);
+    m_parentStack.removeLast();
+
+    // The elements in seeded frames are not guaranteed to outlive this recalc, so drop them with it.
+    if (m_parentStack.isEmpty() || m_parentStack.last().seeded)
+        clearParentStack();
+}
+
+void CSSStyleSelector::pushParentFrame(Element* parent, bool seeded)
+{
+    m_parentStack.append(ParentStackFrame());
+    ParentStackFrame& frame = m_parentStack.last();
+    frame.element = parent;
+    frame.seeded = seeded;
+    collectElementIdentifierHashes(parent, frame.identifierHashes);
+    size_t size = frame.identifierHashes.size();
+    for (size_t i = 0; i < size; ++i)
+        m_ancestorIdentifierFilter->add(frame.identifierHashes[i]);
+}
+
+void CSSStyleSelector::clearParentStack()
+{
+#ifdef ANCESTOR_FILTER_STATS
+    if (selectorsRejectedByAncestorFilter || selectorsCheckedInFull) {
+        printf("Ancestor filter rejected %u selectors, %u checked in full\n", selectorsRejectedByAncestorFilter, selectorsCheckedInFull);
+        selectorsRejectedByAncestorFilter = 0;
+        selectorsCheckedInFull = 0;
+    }
+#endif
+#ifdef STYLE_SHARING_STATS
+    if (sharingLookups) {
+        unsigned shared = sharedWithSiblingOrCousin + sharedFromCache;
+        printf("Shared %u of %u styles (%u%%): %u with a sibling or cousin, %u from the cache\n",
+            shared, sharingLookups, shared * 100 / sharingLookups, sharedWithSiblingOrCousin, sharedFromCache);
+        sharingLookups = 0;
+        sharedWithSiblingOrCousin = 0;
+        sharedFromCache = 0;
+    }
+#endif
+    m_parentStack.clear();
+    m_sharedStyleCache.clear();
+    if (m_ancestorIdentifierFilter)
+        m_ancestorIdentifierFilter->clear();
+}
+
+inline bool CSSStyleSelector::canUseAncestorFilter() const
+{
+    // The filter describes the ancestors of the element on top of the stack, so it only
+    // applies to that element's children.
+    return !m_parentStack.isEmpty() && m_parentStack.last().element == m_parentNode;
+}
+
+inline bool CSSStyleSelector::fastRejectSelector(CSSRuleData* ruleData) const
+{
+    const unsigned* identifierHashes = ruleData->descendantSelectorIdentifierHashes();
+    for (unsigned i = 0; i < CSSRuleData::maximumIdentifierCount && identifierHashes[i]; ++i) {
+        if (!m_ancestorIdentifierFilter->mayContain(identifierHashes[i]))
+            return true;
+    }
+    return false;
+}
+
 void CSSStyleSelector::matchRulesForList(CSSRuleDataList* rules, int& firstRuleIndex, int& lastRuleIndex)
 {
     if (!rules)
         return;
 
+    bool useAncestorFilter = canUseAncestorFilter();
     for (CSSRuleData* d = rules->first(); d; d = d->next()) {
         CSSStyleRule* rule = d->rule();
         const AtomicString& localName = m_element->localName();
         const AtomicString& selectorLocalName = d->selector()->m_tag.localName();
-        if ((localName == selectorLocalName || selectorLocalName == starAtom) && checkSelector(d->selector())) {
+        if (localName != selectorLocalName && selectorLocalName != starAtom)
+            continue;
+        if (useAncestorFilter && fastRejectSelector(d)) {
+#ifdef ANCESTOR_FILTER_STATS
+            selectorsRejectedByAncestorFilter++;
+#endif
+            continue;
+        }
+#ifdef ANCESTOR_FILTER_STATS
+        selectorsCheckedInFull++;
+#endif
+        if (checkSelector(d->selector())) {
             // If the rule has no properties to apply, then ignore it.
             CSSMutableStyleDeclaration* decl = rule->declaration();
             if (!decl || !decl->length())
@@ -930,13 +1170,9 @@ bool CSSStyleSelector::SelectorChecker::checkSelector(CSSSelector* sel, Element*
     return checkSelector(sel, element, 0, dynamicPseudo, true, false) == SelectorMatches;
 }
 
-#ifdef STYLE_SHARING_STATS
-static int fraction = 0;
-static int total = 0;
-#endif
-
 static const unsigned cStyleSearchThreshold = 10;
 static const unsigned cStyleSearchLevelThreshold = 10;
+static const unsigned cSharedStyleCacheSize = 16;
 
 Node* CSSStyleSelector::locateCousinList(Element* parent, unsigned& visitedNodesCount)
 {
@@ -1072,6 +1308,10 @@ RenderStyle* CSSStyleSelector::locateSharedStyle()
     if (m_styledElement->inlineStyleDecl() || m_styledElement->hasID() || m_styledElement->document()->usesSiblingRules())
         return 0;
 
+#ifdef STYLE_SHARING_STATS
+    sharingLookups++;
+#endif
+
     // Check previous siblings and their cousins.
     unsigned count = 0;
     unsigned visitedNodesCount = 0;
@@ -1081,18 +1321,63 @@ RenderStyle* CSSStyleSelector::locateSharedStyle()
     for (n = thisElement->previousSibling(); n && !n->isElementNode(); n = n->previousSibling()) { }
     while (thisElement) {
         while (n) {
-            if (canShareStyleWithElement(n))
+            if (canShareStyleWithElement(n)) {
+#ifdef STYLE_SHARING_STATS
+                sharedWithSiblingOrCousin++;
+#endif
                 return n->renderStyle();
+            }
             if (count++ == cStyleSearchThreshold)
-                return 0;
+                return locateSharedStyleInCache();
             for (n = n->previousSibling(); n && !n->isElementNode(); n = n->previousSibling()) { }
         }
         n = locateCousinList(thisElement->parentElement(), visitedNodesCount);
         thisElement = n;
     }
+    return locateSharedStyleInCache();
+}
+
+RenderStyle* CSSStyleSelector::locateSharedStyleInCache()
+{
+    // A cached element whose parent has our parent's style is as good a candidate as a cousin
+    // found by locateCousinList, however far away in the tree it is.
+    Node* parent = m_element->parentNode();
+    RenderStyle* parentStyle = parent ? parent->renderStyle() : 0;
+    if (!parentStyle)
+        return 0;
+
+    size_t size = m_sharedStyleCache.size();
+    for (size_t i = 0; i < size; ++i) {
+        StyledElement* candidate = m_sharedStyleCache[i];
+        if (candidate == m_element || candidate->tagQName() != m_element->tagQName())
+            continue;
+        Node* candidateParent = candidate->parentNode();
+        if (!candidateParent || candidateParent->renderStyle() != parentStyle || !canShareStyleWithElement(candidate))
+            continue;
+        // Keep the elements that are shared with most at the front.
+        if (i) {
+            m_sharedStyleCache.remove(i);
+            m_sharedStyleCache.insert(0, candidate);
+        }
+#ifdef STYLE_SHARING_STATS
+        sharedFromCache++;
+#endif
+        return candidate->renderStyle();
+    }
     return 0;
 }
 
+void CSSStyleSelector::addToSharedStyleCache(StyledElement* element)
+{
+    // Only elements seen during a recalc are cached; nothing can remove them from the tree
+    // before the recalc is over.
+    if (m_parentStack.isEmpty() || element->inlineStyleDecl() || element->hasID())
+        return;
+    if (m_sharedStyleCache.size() == cSharedStyleCacheSize)
+        m_sharedStyleCache.removeLast();
+    m_sharedStyleCache.insert(0, element);
+}
+
 void CSSStyleSelector::matchUARules(int& firstUARule, int& lastUARule)
 {
     // First we match rules from the user agent sheet.
@@ -1339,6 +1624,9 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
     if (m_style->hasPseudoStyle(FIRST_LETTER))
         m_style->setUnique();
 
+    if (allowSharing && m_styledElement && !m_style->unique())
+        addToSharedStyleCache(m_styledElement);
+
     // Now return the style.
     return m_style.release();
 }
@@ -2790,6 +3078,8 @@ void CSSRuleSet::addToRuleSet(AtomicStringImpl* key, AtomRuleMap& map,
 
 void CSSRuleSet::addRule(CSSStyleRule* rule, CSSSelector* sel)
 {
+    collectFeatures(sel);
+
     if (sel->m_match == CSSSelector::Id) {
         addToRuleSet(sel->m_value.impl(), m_idRules, rule, sel);
         return;
@@ -2812,6 +3102,55 @@ void CSSRuleSet::addRule(CSSStyleRule* rule, CSSSelector* sel)
         m_universalRules->append(m_ruleCount++, rule, sel);
 }
 
+static inline void addFeature(CSSRuleSet::FeatureMap& features, AtomicStringImpl* name, unsigned use)
+{
+    if (!name)
+        return;
+    pair<CSSRuleSet::FeatureMap::iterator, bool> result = features.add(name, use);
+    if (!result.second)
+        result.first->second |= use;
+}
+
+void CSSRuleSet::collectFeatures(CSSSelector* sel)
+{
+    // Everything up to the first combinator tests the element the rule applies to; everything
+    // after it tests one of its ancestors or siblings.
+    unsigned use = CSSStyleSelector::SelectorFeatureMatchesElement;
+    for (; sel; sel = sel->tagHistory()) {
+        collectSimpleSelectorFeatures(sel, use);
+        if (sel->relation() != CSSSelector::SubSelector)
+            use = CSSStyleSelector::SelectorFeatureMatchesRelatives;
+    }
+}
+
+void CSSRuleSet::collectSimpleSelectorFeatures(CSSSelector* sel, unsigned use)
+{
+    if (sel->m_match == CSSSelector::Id)
+        addFeature(m_idFeatures, sel->m_value.impl(), use);
+    else if (sel->m_match == CSSSelector::Class)
+        addFeature(m_classFeatures, sel->m_value.impl(), use);
+    else if (sel->hasAttribute())
+        addFeature(m_attributeFeatures, sel->attribute().localName().impl(), use);
+
+    // The argument of :not() tests the same element.
+    for (CSSSelector* simpleSelector = sel->simpleSelector(); simpleSelector; simpleSelector = simpleSelector->tagHistory())
+        collectSimpleSelectorFeatures(simpleSelector, use);
+}
+
+unsigned CSSRuleSet::featureUse(SelectorFeatureKind kind, AtomicStringImpl* name) const
+{
+    switch (kind) {
+    case IdFeature:
+        return m_idFeatures.get(name);
+    case ClassFeature:
+        return m_classFeatures.get(name);
+    case AttributeFeature:
+        return m_attributeFeatures.get(name);
+    }
+    ASSERT_NOT_REACHED();
+    return 0;
+}
+
 void CSSRuleSet::addRulesFromSheet(CSSStyleSheet* sheet, const MediaQueryEvaluator& medium, CSSStyleSelector* styleSelector)
 {
     if (!sheet)
@@ -6073,6 +6412,35 @@ bool CSSStyleSelector::hasSelectorForAttribute(const AtomicString &attrname)
     return m_selectorAttrs.contains(attrname.impl());
 }
 
+static unsigned selectorFeatureUse(CSSRuleSet* authorStyle, CSSRuleSet* userStyle, SelectorFeatureKind kind, AtomicStringImpl* name)
+{
+    if (!name)
+        return CSSStyleSelector::SelectorFeatureUnused;
+
+    CSSRuleSet* ruleSets[] = { defaultStyle, defaultQuirksStyle, defaultPrintStyle, defaultViewSourceStyle, authorStyle, userStyle };
+    unsigned use = CSSStyleSelector::SelectorFeatureUnused;
+    for (size_t i = 0; i < sizeof(ruleSets) / sizeof(ruleSets[0]); ++i) {
+        if (ruleSets[i])
+            use |= ruleSets[i]->featureUse(kind, name);
+    }
+    return use;
+}
+
+unsigned CSSStyleSelector::idFeatureUse(const AtomicString& id) const
+{
+    return selectorFeatureUse(m_authorStyle, m_userStyle, IdFeature, id.impl());
+}
+
+unsigned CSSStyleSelector::classFeatureUse(const AtomicString& className) const
+{
+    return selectorFeatureUse(m_authorStyle, m_userStyle, ClassFeature, className.impl());
+}
+
+unsigned CSSStyleSelector::attributeFeatureUse(const AtomicString& attributeName) const
+{
+    return selectorFeatureUse(m_authorStyle, m_userStyle, AttributeFeature, attributeName.impl());
+}
+
 void CSSStyleSelector::addViewportDependentMediaQueryResult(const MediaQueryExp* expr, bool result)
 {
     m_viewportDependentMediaQueryResults.append(new MediaQueryResult(*expr, result));
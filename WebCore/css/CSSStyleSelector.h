@@ -29,11 +29,13 @@
 #include "StringHash.h"
 #include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
+#include <wtf/OwnPtr.h>
 #include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
 
+class AncestorIdentifierFilter;
 class CSSMutableStyleDeclaration;
 class CSSPrimitiveValue;
 class CSSProperty;
@@ -94,6 +96,11 @@ public:
 
         static PassRefPtr<RenderStyle> styleForDocument(Document*);
 
+        // Called around the recursion into the children of an element during style recalc, so that
+        // descendant selectors can be rejected without walking up the tree of each element.
+        void pushParent(Element* parent);
+        void popParent(Element* parent);
+
 #if ENABLE(DATAGRID)
         // Datagrid style computation (uses unique pseudo elements and structures)
         PassRefPtr<RenderStyle> pseudoStyleForDataGridColumn(DataGridColumn*, RenderStyle* parentStyle);
@@ -104,6 +111,8 @@ public:
         RenderStyle* locateSharedStyle();
         Node* locateCousinList(Element* parent, unsigned& visitedNodes);
         bool canShareStyleWithElement(Node*);
+        RenderStyle* locateSharedStyleInCache();
+        void addToSharedStyleCache(StyledElement*);
 
         RenderStyle* style() const { return m_style.get(); }
 
@@ -137,6 +146,18 @@ public:
         Color getColorFromPrimitiveValue(CSSPrimitiveValue*);
 
         bool hasSelectorForAttribute(const AtomicString&);
+
+        // Where an id, class or attribute name appears in the selectors of the rules in use, as a
+        // combination of SelectorFeatureUse flags. Lets a change to one restyle no more of the
+        // tree than the rules require.
+        enum SelectorFeatureUse {
+            SelectorFeatureUnused = 0,
+            SelectorFeatureMatchesElement = 1 << 0, // Tested on the element the rule applies to.
+            SelectorFeatureMatchesRelatives = 1 << 1 // Tested on an ancestor or a sibling.
+        };
+        unsigned idFeatureUse(const AtomicString&) const;
+        unsigned classFeatureUse(const AtomicString&) const;
+        unsigned attributeFeatureUse(const AtomicString&) const;
  
         CSSFontSelector* fontSelector() { return m_fontSelector.get(); }
 
@@ -173,6 +194,10 @@ public:
 
         void matchRules(CSSRuleSet*, int& firstRuleIndex, int& lastRuleIndex);
         void matchRulesForList(CSSRuleDataList*, int& firstRuleIndex, int& lastRuleIndex);
+        bool canUseAncestorFilter() const;
+        bool fastRejectSelector(CSSRuleData*) const;
+        void pushParentFrame(Element*, bool seeded);
+        void clearParentStack();
         void sortMatchedRules(unsigned start, unsigned end);
 
         void applyDeclarations(bool firstPass, bool important, int startIndex, int endIndex);
@@ -286,6 +311,20 @@ public:
         
         HashMap<String, CSSVariablesRule*> m_variablesMap;
         HashMap<CSSMutableStyleDeclaration*, RefPtr<CSSMutableStyleDeclaration> > m_resolvedVariablesDeclarations;
+
+        // The elements whose children are being recalculated, outermost first. Seeded frames hold
+        // the ancestors of the element the recalc started from.
+        struct ParentStackFrame {
+            Element* element;
+            bool seeded;
+            Vector<unsigned, 4> identifierHashes;
+        };
+        Vector<ParentStackFrame> m_parentStack;
+        OwnPtr<AncestorIdentifierFilter> m_ancestorIdentifierFilter;
+
+        // Elements styled during the current recalc, most recent first. Styles are shared with
+        // them when no sibling or cousin will do. Emptied together with the parent stack.
+        Vector<StyledElement*, 16> m_sharedStyleCache;
     };
 
     class CSSRuleData : public Noncopyable {
@@ -298,6 +337,7 @@ public:
         {
             if (prev)
                 prev->m_next = this;
+            collectDescendantSelectorIdentifierHashes();
         }
 
         ~CSSRuleData() 
@@ -309,11 +349,19 @@ public:
         CSSSelector* selector() { return m_selector; }
         CSSRuleData* next() { return m_next; }
 
+        // Hashes of the ids, classes and tag names that some ancestor must have for the selector
+        // to match. The list ends at the first zero.
+        static const unsigned maximumIdentifierCount = 4;
+        const unsigned* descendantSelectorIdentifierHashes() const { return m_descendantSelectorIdentifierHashes; }
+
     private:
+        void collectDescendantSelectorIdentifierHashes();
+
         unsigned m_position;
         CSSStyleRule* m_rule;
         CSSSelector* m_selector;
         CSSRuleData* m_next;
+        unsigned m_descendantSelectorIdentifierHashes[maximumIdentifierCount];
     };
 
     class CSSRuleDataList : public Noncopyable {
@@ -611,8 +611,22 @@ void Element::updateAfterAttributeChanged(Attribute* attr)
     
 void Element::recalcStyleIfNeededAfterAttributeChanged(Attribute* attr)
 {
-    if (document()->attached() && document()->styleSelector()->hasSelectorForAttribute(attr->name().localName()))
+    if (!document()->attached())
+        return;
+    CSSStyleSelector* styleSelector = document()->styleSelector();
+    const AtomicString& localName = attr->name().localName();
+    if (styleSelector->hasSelectorForAttribute(localName))
+        setNeedsStyleRecalcForSelectorFeatureUse(styleSelector->attributeFeatureUse(localName) | CSSStyleSelector::SelectorFeatureMatchesElement);
+}
+
+void Element::setNeedsStyleRecalcForSelectorFeatureUse(unsigned featureUse)
+{
+    // A rule that tests an ancestor or sibling can change the style of the whole subtree or of
+    // the following siblings, which only a full style change accounts for.
+    if (featureUse & CSSStyleSelector::SelectorFeatureMatchesRelatives)
         setNeedsStyleRecalc();
+    else if (featureUse & CSSStyleSelector::SelectorFeatureMatchesElement)
+        setNeedsStyleRecalc(InlineStyleChange);
 }
 
 // Returns true is the given attribute is an event handler.
@@ -921,6 +935,9 @@ void Element::recalcStyle(StyleChange change)
     // For now we will just worry about the common case, since it's a lot trickier to get the second case right
     // without doing way too much re-resolution.
     bool forceCheckOfNextElementSibling = false;
+    bool hasChildren = firstChild();
+    if (hasChildren)
+        document()->styleSelector()->pushParent(this);
     for (Node *n = firstChild(); n; n = n->nextSibling()) {
         bool childRulesChanged = n->needsStyleRecalc() && n->styleChangeType() == FullStyleChange;
         if (forceCheckOfNextElementSibling && n->isElementNode())
@@ -930,6 +947,8 @@ void Element::recalcStyle(StyleChange change)
         if (n->isElementNode())
             forceCheckOfNextElementSibling = childRulesChanged && hasDirectAdjacentRules;
     }
+    if (hasChildren)
+        document()->styleSelector()->popParent(this);
 
     setNeedsStyleRecalc(NoStyleChange);
     setChildNeedsStyleRecalc(false);
@@ -280,6 +280,10 @@ protected:
     void recalcStyleIfNeededAfterAttributeChanged(Attribute*);
     void updateAfterAttributeChanged(Attribute*);
 
+    // Takes a combination of CSSStyleSelector::SelectorFeatureUse flags for the ids, classes or
+    // attributes that changed, and asks for no more style recalc than they call for.
+    void setNeedsStyleRecalcForSelectorFeatureUse(unsigned featureUse);
+
 private:
     void scrollByUnits(int units, ScrollGranularity);
 
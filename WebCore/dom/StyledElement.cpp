@@ -221,6 +221,17 @@ void StyledElement::classAttributeChanged(const AtomicString& newClassString)
         if (!isClassWhitespace(characters[i]))
             break;
     }
+
+    // Only the classes that were added or removed need to be looked up in the style rules.
+    bool restyleForChangedClasses = attached() && document()->attached();
+    Vector<AtomicString, 8> oldClasses;
+    if (restyleForChangedClasses && hasClass() && namedAttrMap) {
+        const SpaceSplitString& classes = classNames();
+        size_t size = classes.size();
+        for (size_t j = 0; j < size; ++j)
+            oldClasses.append(classes[j]);
+    }
+
     setHasClass(i < length);
     if (namedAttrMap) {
         if (i < length)
@@ -228,7 +239,27 @@ void StyledElement::classAttributeChanged(const AtomicString& newClassString)
         else
             mappedAttributes()->clearClass();
     }
-    setNeedsStyleRecalc();
+
+    if (restyleForChangedClasses) {
+        CSSStyleSelector* styleSelector = document()->styleSelector();
+        unsigned featureUse = styleSelector->attributeFeatureUse(classAttr.localName());
+        size_t oldSize = oldClasses.size();
+        size_t newSize = hasClass() ? classNames().size() : 0;
+        for (size_t j = 0; j < oldSize; ++j) {
+            if (!newSize || !classNames().contains(oldClasses[j]))
+                featureUse |= styleSelector->classFeatureUse(oldClasses[j]);
+        }
+        for (size_t j = 0; j < newSize; ++j) {
+            const AtomicString& newClass = classNames()[j];
+            bool wasPresent = false;
+            for (size_t k = 0; k < oldSize && !wasPresent; ++k)
+                wasPresent = oldClasses[k] == newClass;
+            if (!wasPresent)
+                featureUse |= styleSelector->classFeatureUse(newClass);
+        }
+        setNeedsStyleRecalcForSelectorFeatureUse(featureUse);
+    } else
+        setNeedsStyleRecalc();
     dispatchSubtreeModifiedEvent();
 }
 
@@ -236,6 +267,7 @@ void StyledElement::parseMappedAttribute(MappedAttribute *attr)
 {
     if (attr->name() == idAttributeName()) {
         // unique id
+        AtomicString oldID = namedAttrMap ? namedAttrMap->id() : nullAtom;
         setHasID(!attr->isNull());
         if (namedAttrMap) {
             if (attr->isNull())
@@ -245,7 +277,15 @@ void StyledElement::parseMappedAttribute(MappedAttribute *attr)
             else
                 namedAttrMap->setID(attr->value());
         }
-        setNeedsStyleRecalc();
+        if (attached() && document()->attached() && namedAttrMap) {
+            CSSStyleSelector* styleSelector = document()->styleSelector();
+            const AtomicString& newID = namedAttrMap->id();
+            unsigned featureUse = styleSelector->attributeFeatureUse(idAttributeName().localName());
+            if (oldID != newID)
+                featureUse |= styleSelector->idFeatureUse(oldID) | styleSelector->idFeatureUse(newID);
+            setNeedsStyleRecalcForSelectorFeatureUse(featureUse);
+        } else
+            setNeedsStyleRecalc();
     } else if (attr->name() == classAttr)
         classAttributeChanged(attr->value());
     else if (attr->name() == styleAttr) {
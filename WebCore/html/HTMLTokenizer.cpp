@@ -91,6 +91,10 @@ static const double defaultTokenizerTimeDelay = 0.300;
 static const double defaultTokenizerTimeDelay = 0.500;
 #endif
 
+// The most source the preload scanner looks at each time the tokenizer yields, so that scanning
+// ahead does not itself hold up the event loop.
+static const unsigned preloadScanChunkSize = 16 * 1024;
+
 static const char commentStart [] = "<!--";
 static const char doctypeStart [] = "<!doctype";
 static const char publicStart [] = "public";
@@ -565,6 +569,9 @@ HTMLTokenizer::State HTMLTokenizer::scriptHandler(State state)
         if (!m_preloadScanner->inProgress()) {
             m_preloadScanner->begin();
             m_preloadScanner->write(m_pendingSrc);
+        } else {
+            // Nothing else can run while the script loads, so catch up with the source.
+            feedPreloadScanner(UINT_MAX);
         }
     }
 #endif
@@ -1613,6 +1620,59 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
     return state;
 }
 
+// The layout timer cannot fire while we hold the event loop, so a document that has been parsing
+// since it was created would otherwise show nothing until the end of a whole time slice.
+inline bool HTMLTokenizer::shouldYieldForFirstLayout()
+{
+    FrameView* view = m_doc->view();
+    return view && !view->didFirstLayout() && view->layoutPending() && !m_doc->minimumLayoutDelay();
+}
+
+// Resources in the data we have not tokenized yet would otherwise only be requested when the
+// tokenizer gets to them, several time slices later. Scan ahead while we give way to layout.
+void HTMLTokenizer::scanAheadForPreloads(const State& state)
+{
+#if PRELOAD_SCANNER_ENABLED
+    // The scanner starts in the data state, so only run it if we stopped between tokens.
+    if (m_fragment || m_src.isEmpty() || state.needsSpecialWriteHandling() || !m_pendingScripts.isEmpty())
+        return;
+    if (!m_preloadScanner)
+        m_preloadScanner.set(new PreloadScanner(m_doc));
+    // Once started, the scanner stays ahead of the tokenizer until the end of the document, and
+    // sees each part of the source once.
+    if (!m_preloadScanner->inProgress()) {
+        m_preloadScanner->begin();
+        m_preloadScannerBacklog = m_src;
+    }
+    feedPreloadScanner(preloadScanChunkSize);
+#else
+    UNUSED_PARAM(state);
+#endif
+}
+
+void HTMLTokenizer::feedPreloadScanner(unsigned maximumLength)
+{
+#if PRELOAD_SCANNER_ENABLED
+    ASSERT(m_preloadScanner && m_preloadScanner->inProgress());
+    if (m_preloadScannerBacklog.isEmpty())
+        return;
+    if (m_preloadScannerBacklog.length() <= maximumLength) {
+        m_preloadScanner->write(m_preloadScannerBacklog);
+        m_preloadScannerBacklog.clear();
+        return;
+    }
+    Vector<UChar> chunk;
+    chunk.reserveInitialCapacity(maximumLength);
+    for (unsigned i = 0; i < maximumLength; ++i) {
+        chunk.append(*m_preloadScannerBacklog);
+        m_preloadScannerBacklog.advance();
+    }
+    m_preloadScanner->write(SegmentedString(chunk.data(), chunk.size()));
+#else
+    UNUSED_PARAM(maximumLength);
+#endif
+}
+
 inline bool HTMLTokenizer::continueProcessing(int& processedCount, double startTime, State &state)
 {
     // We don't want to be checking elapsed time with every character, so we only check after we've
@@ -1621,7 +1681,8 @@ inline bool HTMLTokenizer::continueProcessing(int& processedCount, double startT
     state.setAllowYield(false);
     if (!state.loadingExtScript() && !state.forceSynchronous() && !m_executingScript && (processedCount > m_tokenizerChunkSize || allowedYield)) {
         processedCount = 0;
-        if (currentTime() - startTime > m_tokenizerTimeDelay) {
+        // Also yield as soon as the first layout is due, rather than at the end of the time slice.
+        if (currentTime() - startTime > m_tokenizerTimeDelay || shouldYieldForFirstLayout()) {
             /* FIXME: We'd like to yield aggressively to give stylesheets the opportunity to
                load, but this hurts overall performance on slower machines.  For now turn this
                off.
@@ -1629,9 +1690,12 @@ inline bool HTMLTokenizer::continueProcessing(int& processedCount, double startT
                 (m_doc->documentElement()->id() != ID_HTML || m_doc->body()))) {*/
             // Schedule the timer to keep processing as soon as possible.
             m_timer.startOneShot(0);
+            scanAheadForPreloads(state);
 #ifdef INSTRUMENT_LAYOUT_SCHEDULING
             if (currentTime() - startTime > m_tokenizerTimeDelay)
                 printf("Deferring processing of data because 500ms elapsed away from event loop.\n");
+            else
+                printf("Deferring processing of data for the first layout at time %d.\n", m_doc->elapsedTime());
 #endif
             return false;
         }
@@ -1660,16 +1724,19 @@ void HTMLTokenizer::write(const SegmentedString& str, bool appendData)
         else {
             m_pendingSrc.append(source);
 #if PRELOAD_SCANNER_ENABLED
-            if (m_preloadScanner && m_preloadScanner->inProgress() && appendData)
-                m_preloadScanner->write(source);
+            if (m_preloadScanner && m_preloadScanner->inProgress() && appendData) {
+                m_preloadScannerBacklog.append(source);
+                feedPreloadScanner(UINT_MAX);
+            }
 #endif
         }
         return;
     }
     
 #if PRELOAD_SCANNER_ENABLED
+    // The scanner looks at data that arrives while the tokenizer is running the next time it yields.
     if (m_preloadScanner && m_preloadScanner->inProgress() && appendData)
-        m_preloadScanner->end();
+        m_preloadScannerBacklog.append(source);
 #endif
 
     if (!m_src.isEmpty())
@@ -1880,6 +1947,13 @@ void HTMLTokenizer::end()
     ASSERT(!m_timer.isActive());
     m_timer.stop(); // Only helps if assertion above fires, but do it anyway.
 
+#if PRELOAD_SCANNER_ENABLED
+    if (m_preloadScanner && m_preloadScanner->inProgress()) {
+        m_preloadScannerBacklog.clear();
+        m_preloadScanner->end();
+    }
+#endif
+
     if (m_buffer) {
         // parseTag is using the buffer for different matters
         if (!m_state.hasTagState())
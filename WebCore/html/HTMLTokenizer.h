@@ -200,6 +200,9 @@ private:
     void enlargeScriptBuffer(int len);
 
     bool continueProcessing(int& processedCount, double startTime, State&);
+    bool shouldYieldForFirstLayout();
+    void scanAheadForPreloads(const State&);
+    void feedPreloadScanner(unsigned maximumLength);
     void timerFired(Timer<HTMLTokenizer>*);
     void allDataProcessed();
 
@@ -424,6 +427,8 @@ private:
     FragmentScriptingPermission m_scriptingPermission;
 
     OwnPtr<PreloadScanner> m_preloadScanner;
+    // Source the preload scanner has not seen yet, while it runs ahead of the tokenizer.
+    SegmentedString m_preloadScannerBacklog;
 };
 
 void parseHTMLDocumentFragment(const String&, DocumentFragment*, FragmentScriptingPermission = FragmentScriptingAllowed);
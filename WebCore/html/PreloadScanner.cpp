@@ -33,14 +33,18 @@
 #include "CachedResource.h"
 #include "CachedResourceClient.h"
 #include "CachedScript.h"
+#include "CSSFontFaceSrcValue.h"
 #include "CSSHelper.h"
 #include "CString.h"
+#include "DNS.h"
 #include "DocLoader.h"
 #include "Document.h"
 #include "Frame.h"
 #include "FrameLoader.h"
 #include "HTMLLinkElement.h"
 #include "HTMLNames.h"
+#include "MediaList.h"
+#include "MediaQueryEvaluator.h"
 #include <wtf/CurrentTime.h>
 #include <wtf/unicode/Unicode.h>
 
@@ -67,6 +71,8 @@ using namespace HTMLNames;
     
 PreloadScanner::PreloadScanner(Document* doc)
     : m_inProgress(false)
+    , m_preloadCount(0)
+    , m_duplicatePreloadCount(0)
     , m_timeUsed(0)
     , m_bodySeen(false)
     , m_document(doc)
@@ -81,6 +87,7 @@ PreloadScanner::~PreloadScanner()
 #if PRELOAD_DEBUG
     printf("DELETING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
     printf("TOTAL TIME USED %.4fs\n", m_timeUsed);
+    printf("PRELOADS ISSUED %u, DUPLICATES SKIPPED %u\n", m_preloadCount, m_duplicatePreloadCount);
 #endif
 }
     
@@ -115,12 +122,14 @@ void PreloadScanner::reset()
     m_urlToLoad = String();
     m_charset = String();
     m_linkIsStyleSheet = false;
+    m_inputIsImage = false;
     m_lastCharacterIndex = 0;
     clearLastCharacters();
     
     m_cssState = CSSInitial;
     m_cssRule.clear();
     m_cssRuleValue.clear();
+    m_cssRuleMedia.clear();
 }
     
 bool PreloadScanner::scanningBody() const
@@ -699,6 +708,14 @@ void PreloadScanner::processAttribute()
             m_urlToLoad = deprecatedParseURL(value);
         else if (attribute == charsetAttr)
             m_charset = value;
+    } else if (tag == inputTag) {
+        if (attribute == srcAttr && m_urlToLoad.isEmpty())
+            m_urlToLoad = deprecatedParseURL(value);
+        else if (attribute == typeAttr)
+            m_inputIsImage = equalIgnoringCase(value, "image");
+    } else if (tag == iframeTag) {
+        if (attribute == srcAttr && m_urlToLoad.isEmpty())
+            m_urlToLoad = deprecatedParseURL(value);
     } else if (tag == linkTag) {
         if (attribute == hrefAttr && m_urlToLoad.isEmpty())
             m_urlToLoad = deprecatedParseURL(value);
@@ -729,7 +746,7 @@ inline void PreloadScanner::emitCharacter(UChar c)
     
 inline void PreloadScanner::tokenizeCSS(UChar c)
 {    
-    // We are just interested in @import rules, no need for real tokenization here
+    // We are just interested in @import and @font-face rules, no need for real tokenization here
     // Searching for other types of resources is probably low payoff
     switch (m_cssState) {
     case CSSInitial:
@@ -770,6 +787,8 @@ inline void PreloadScanner::tokenizeCSS(UChar c)
             m_cssState = CSSAfterRule;
         else if (c == ';')
             m_cssState = CSSInitial;
+        else if (c == '{')
+            beginCSSBlock();
         else
             m_cssRule.append(c);
         break;
@@ -778,6 +797,8 @@ inline void PreloadScanner::tokenizeCSS(UChar c)
             ;
         else if (c == ';')
             m_cssState = CSSInitial;
+        else if (c == '{')
+            beginCSSBlock();
         else {
             m_cssState = CSSRuleValue;
             m_cssRuleValue.append(c);
@@ -789,7 +810,9 @@ inline void PreloadScanner::tokenizeCSS(UChar c)
         else if (c == ';') {
             emitCSSRule();
             m_cssState = CSSInitial;
-        } else 
+        } else if (c == '{')
+            beginCSSBlock();
+        else
             m_cssRuleValue.append(c);
         break;
     case CSSAfterRuleValue:
@@ -798,11 +821,29 @@ inline void PreloadScanner::tokenizeCSS(UChar c)
         else if (c == ';') {
             emitCSSRule();
             m_cssState = CSSInitial;
-        } else {
-            // FIXME media rules
-             m_cssState = CSSInitial;
+        } else if (c == '{')
+            beginCSSBlock();
+        else {
+            m_cssState = CSSRuleMedia;
+            m_cssRuleMedia.append(c);
         }
         break;
+    case CSSRuleMedia:
+        if (c == ';') {
+            emitCSSRule();
+            m_cssState = CSSInitial;
+        } else if (c == '{')
+            beginCSSBlock();
+        else
+            m_cssRuleMedia.append(c);
+        break;
+    case CSSFontFaceBlock:
+        if (c == '}') {
+            emitCSSFontFace();
+            m_cssState = CSSInitial;
+        } else
+            m_cssRuleValue.append(c);
+        break;
     }
 }
     
@@ -835,19 +876,52 @@ void PreloadScanner::emitTag()
     
     if (m_urlToLoad.isEmpty()) {
         m_linkIsStyleSheet = false;
+        m_inputIsImage = false;
         return;
     }
     
     if (tag == scriptTag)
-        m_document->docLoader()->preload(CachedResource::Script, m_urlToLoad, m_charset, scanningBody());
-    else if (tag == imgTag) 
-        m_document->docLoader()->preload(CachedResource::ImageResource, m_urlToLoad, String(), scanningBody());
+        preload(CachedResource::Script, m_urlToLoad, m_charset);
+    else if (tag == imgTag || (tag == inputTag && m_inputIsImage))
+        preload(CachedResource::ImageResource, m_urlToLoad, String());
     else if (tag == linkTag && m_linkIsStyleSheet) 
-        m_document->docLoader()->preload(CachedResource::CSSStyleSheet, m_urlToLoad, m_charset, scanningBody());
+        preload(CachedResource::CSSStyleSheet, m_urlToLoad, m_charset);
+    else if (tag == iframeTag && m_document->isDNSPrefetchEnabled()) {
+        // There is no cached resource type for a subframe document, but we can at least
+        // have its host resolved by the time the frame is created.
+        if (protocolIs(m_urlToLoad, "http") || protocolIs(m_urlToLoad, "https") || m_urlToLoad.startsWith("//"))
+            prefetchDNS(m_document->completeURL(m_urlToLoad).host(), m_document->frame(), DnsPrefetchResource);
+    }
 
     m_urlToLoad = String();
     m_charset = String();
     m_linkIsStyleSheet = false;
+    m_inputIsImage = false;
+}
+
+void PreloadScanner::preload(CachedResource::Type type, const String& url, const String& charset)
+{
+    if (!m_preloadedURLs.add(url).second) {
+        m_duplicatePreloadCount++;
+        return;
+    }
+    m_preloadCount++;
+    m_document->docLoader()->preload(type, url, charset, scanningBody());
+}
+    
+void PreloadScanner::beginCSSBlock()
+{
+    String rule(m_cssRule.data(), m_cssRule.size());
+    if (equalIgnoringCase(rule, "font-face")) {
+        m_cssRuleValue.clear();
+        m_cssState = CSSFontFaceBlock;
+        return;
+    }
+    // Nothing else with a block can reference a resource we preload.
+    m_cssRule.clear();
+    m_cssRuleValue.clear();
+    m_cssRuleMedia.clear();
+    m_cssState = CSSInitial;
 }
     
 void PreloadScanner::emitCSSRule()
@@ -856,11 +930,64 @@ void PreloadScanner::emitCSSRule()
     if (equalIgnoringCase(rule, "import") && !m_cssRuleValue.isEmpty()) {
         String value(m_cssRuleValue.data(), m_cssRuleValue.size());
         String url = deprecatedParseURL(value);
-        if (!url.isEmpty())
-            m_document->docLoader()->preload(CachedResource::CSSStyleSheet, url, String(), scanningBody());
+        String media = String(m_cssRuleMedia.data(), m_cssRuleMedia.size()).stripWhiteSpace();
+        bool mediaMatches = true;
+        if (!media.isEmpty()) {
+            // Stricter than StyleElement, which also loads sheets for print: a preload is only a
+            // guess, and an import that only applies when printing is not worth the bandwidth now.
+            RefPtr<MediaList> mediaList = MediaList::create(media, true);
+            MediaQueryEvaluator screenEval("screen", true);
+            mediaMatches = screenEval.eval(mediaList.get());
+        }
+        if (!url.isEmpty() && mediaMatches)
+            preload(CachedResource::CSSStyleSheet, url, String());
     }
     m_cssRule.clear();
     m_cssRuleValue.clear();
+    m_cssRuleMedia.clear();
+}
+
+void PreloadScanner::emitCSSFontFace()
+{
+    // Preload the first source the font selector will actually try to load.
+    String block(m_cssRuleValue.data(), m_cssRuleValue.size());
+    m_cssRule.clear();
+    m_cssRuleValue.clear();
+    
+    // A locally installed font is used without any download.
+    int localPosition = block.find("local(", 0, false);
+    int position = 0;
+    while ((position = block.find("url(", position, false)) != -1) {
+        if (localPosition != -1 && localPosition < position)
+            return;
+        int end = block.find(')', position);
+        if (end == -1)
+            return;
+        String url = deprecatedParseURL(block.substring(position, end - position + 1));
+        position = end + 1;
+        
+        String format;
+        unsigned next = position;
+        while (next < block.length() && isWhitespace(block[next]))
+            next++;
+        if (equalIgnoringCase(block.substring(next, 7), "format(")) {
+            int formatEnd = block.find(')', next);
+            if (formatEnd == -1)
+                return;
+            // Strips the quotes around the format string just as it does for a URL.
+            format = deprecatedParseURL(block.substring(next + 7, formatEnd - next - 7));
+            position = formatEnd + 1;
+        }
+        
+        if (url.isEmpty())
+            continue;
+        RefPtr<CSSFontFaceSrcValue> source = CSSFontFaceSrcValue::create(url);
+        source->setFormat(format);
+        if (source->isSupportedFormat()) {
+            preload(CachedResource::FontResource, url, String());
+            return;
+        }
+    }
 }
                 
 }
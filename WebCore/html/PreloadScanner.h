@@ -27,13 +27,15 @@
 #define PreloadScanner_h
 
 #include "AtomicString.h"
+#include "CachedResource.h"
 #include "SegmentedString.h"
+#include "StringHash.h"
+#include <wtf/HashSet.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
     
-    class CachedResource;
     class CachedResourceClient;
     class Document;
     
@@ -59,8 +61,11 @@ namespace WebCore {
         
         void tokenizeCSS(UChar);
         void emitCSSRule();
+        void emitCSSFontFace();
+        void beginCSSBlock();
         
         void processAttribute();
+        void preload(CachedResource::Type, const String& url, const String& charset);
 
         
         void clearLastCharacters();
@@ -117,6 +122,7 @@ namespace WebCore {
         String m_urlToLoad;
         String m_charset;
         bool m_linkIsStyleSheet;
+        bool m_inputIsImage;
         
         enum CSSState {
             CSSInitial,
@@ -127,11 +133,20 @@ namespace WebCore {
             CSSRule,
             CSSAfterRule,
             CSSRuleValue,
-            CSSAfterRuleValue
+            CSSAfterRuleValue,
+            CSSRuleMedia,
+            CSSFontFaceBlock
         };
         CSSState m_cssState;
         Vector<UChar, 16> m_cssRule;
         Vector<UChar> m_cssRuleValue;
+        Vector<UChar> m_cssRuleMedia;
+        
+        // URLs already handed to the DocLoader. Kept across begin() so that data
+        // scanned ahead of the tokenizer is not preloaded again by a later scan.
+        HashSet<String> m_preloadedURLs;
+        unsigned m_preloadCount;
+        unsigned m_duplicatePreloadCount;
         
         double m_timeUsed;
         
@@ -41,6 +41,7 @@
 #include "Frame.h"
 #include "FrameLoader.h"
 #include "FrameLoaderClient.h"
+#include "Logging.h"
 #include "loader.h"
 #include "SecurityOrigin.h"
 #include "Settings.h"
@@ -271,6 +272,11 @@ CachedResource* DocLoader::requestResource(CachedResource::Type type, const Stri
 
         m_documentResources.set(resource->url(), resource);
         checkCacheObjectStatus(resource);
+
+        // The parser blocks on scripts and style sheets. If one of them was preloaded but is still
+        // waiting for a connection, let it go ahead of the other pending requests.
+        if (!isPreload && resource->isPreloaded() && (type == CachedResource::Script || type == CachedResource::CSSStyleSheet))
+            cache()->loader()->promotePendingRequest(resource);
     }
     return resource;
 }
@@ -456,6 +462,9 @@ void DocLoader::requestPreload(CachedResource::Type type, const String& url, con
     CachedResource* resource = requestResource(type, url, encoding, true);
     if (!resource || m_preloads.contains(resource))
         return;
+    // Fonts are not loaded until something uses them, which is exactly what a preload should avoid.
+    if (type == CachedResource::FontResource)
+        static_cast<CachedFont*>(resource)->beginLoadIfNeeded(this);
     resource->increasePreloadCount();
     m_preloads.add(resource);
 #if PRELOAD_DEBUG
@@ -465,6 +474,21 @@ void DocLoader::requestPreload(CachedResource::Type type, const String& url, con
 
 void DocLoader::clearPreloads()
 {
+#if !LOG_DISABLED
+    // A critical-path resource that the parser referenced after its preload had started was
+    // fetched earlier than the parser alone would have fetched it.
+    unsigned criticalPathFetchesMovedEarlier = 0;
+    ListHashSet<CachedResource*>::iterator preloadsEnd = m_preloads.end();
+    for (ListHashSet<CachedResource*>::iterator it = m_preloads.begin(); it != preloadsEnd; ++it) {
+        CachedResource* res = *it;
+        if (res->type() == CachedResource::ImageResource)
+            continue;
+        if (res->preloadResult() >= CachedResource::PreloadReferencedWhileLoading)
+            ++criticalPathFetchesMovedEarlier;
+    }
+    if (!m_preloads.isEmpty())
+        LOG(Network, "DocLoader %p: %d preloads, %u critical-path fetches moved earlier", this, m_preloads.size(), criticalPathFetchesMovedEarlier);
+#endif
 #if PRELOAD_DEBUG
     printPreloadStats();
 #endif
@@ -494,6 +518,8 @@ void DocLoader::printPreloadStats()
     unsigned stylesheetMisses = 0;
     unsigned images = 0;
     unsigned imageMisses = 0;
+    unsigned fonts = 0;
+    unsigned fontMisses = 0;
     ListHashSet<CachedResource*>::iterator end = m_preloads.end();
     for (ListHashSet<CachedResource*>::iterator it = m_preloads.begin(); it != end; ++it) {
         CachedResource* res = *it;
@@ -512,6 +538,10 @@ void DocLoader::printPreloadStats()
             stylesheets++;
             if (res->preloadResult() < CachedResource::PreloadReferencedWhileLoading)
                 stylesheetMisses++;
+        } else if (res->type() == CachedResource::FontResource) {
+            fonts++;
+            if (res->preloadResult() < CachedResource::PreloadReferencedWhileLoading)
+                fontMisses++;
         } else {
             images++;
             if (res->preloadResult() < CachedResource::PreloadReferencedWhileLoading)
@@ -531,6 +561,8 @@ void DocLoader::printPreloadStats()
         printf("STYLESHEETS: %d (%d hits, hit rate %d%%)\n", stylesheets, stylesheets - stylesheetMisses, (stylesheets - stylesheetMisses) * 100 / stylesheets);
     if (images)
         printf("IMAGES:  %d (%d hits, hit rate %d%%)\n", images, images - imageMisses, (images - imageMisses) * 100 / images);
+    if (fonts)
+        printf("FONTS:  %d (%d hits, hit rate %d%%)\n", fonts, fonts - fontMisses, (fonts - fontMisses) * 100 / fonts);
 }
 #endif
     
@@ -274,6 +274,25 @@ void Loader::load(DocLoader* docLoader, CachedResource* resource, bool increment
 }
 
 
+
+void Loader::promotePendingRequest(CachedResource* resource)
+{
+    Request* request = requestForUrl(resource->url());
+    if (!request || request->cachedResource() != resource)
+        return;
+
+    RefPtr<Host> host;
+    KURL url(ParsedURLString, resource->url());
+    if (url.protocolInHTTPFamily()) {
+        m_hosts.checkConsistency();
+        AtomicString hostName = url.host();
+        host = m_hosts.get(hostName.impl());
+    } else
+        host = m_nonHTTPProtocolHost;
+
+    if (host && host->promotePendingRequest(request))
+        host->servePendingRequests(High);
+}
     
 void Loader::scheduleServePendingRequests()
 {
@@ -495,6 +514,23 @@ bool Loader::Host::hasRequests() const
     return false;
 }
 
+bool Loader::Host::promotePendingRequest(Request* request)
+{
+    for (unsigned p = 0; p < High; p++) {
+        RequestQueue& requestsPending = m_requestsPending[p];
+        RequestQueue::iterator end = requestsPending.end();
+        for (RequestQueue::iterator it = requestsPending.begin(); it != end; ++it) {
+            if (*it != request)
+                continue;
+            requestsPending.remove(it);
+            request->setPriority(0);
+            m_requestsPending[High].prepend(request);
+            return true;
+        }
+    }
+    return false;
+}
+
 void Loader::Host::servePendingRequests(Loader::Priority minimumPriority)
 {
     if (cache()->loader()->isSuspendingPendingRequests())
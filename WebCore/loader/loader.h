@@ -52,6 +52,7 @@ namespace WebCore {
         
         enum Priority { Low, Medium, High };
         void servePendingRequests(Priority minimumPriority = Low);
+        void promotePendingRequest(CachedResource*);
 
         bool isSuspendingPendingRequests() { return m_isSuspendingPendingRequests; }
         void suspendPendingRequests();
@@ -92,6 +93,7 @@ namespace WebCore {
             void servePendingRequests(Priority minimumPriority = Low);
             void cancelRequests(DocLoader*);
             bool hasRequests() const;
+            bool promotePendingRequest(Request*);
 
             bool processingResource() const { return m_numResourcesProcessing != 0 || m_nonCachedRequestsInFlight !=0; }
 
@@ -42,6 +42,8 @@
 
 #if USE(JSC)
 #include "JSDOMWindow.h"
+#include <jit/MegamorphicAccessCache.h>
+#include <parser/ParseCache.h>
 #include <runtime/JSGlobalObject.h>
 #include <runtime/JSLock.h>
 #endif
@@ -120,6 +122,22 @@ void TimeCounter::recordNoCounter(enum Type type, const char* functionName)
         LOGW("***** %s() used %d ms\n", functionName, elapsed);
 }
 
+static void logHeapProfileEntry(const WTF::FastMallocHeapProfileEntry& entry, void* context)
+{
+    // Only the largest few call sites are worth the log space.
+    int* remaining = static_cast<int*>(context);
+    if (!*remaining)
+        return;
+    --*remaining;
+    char scratch[256];
+    int index = 0;
+    for (size_t i = 0; i < entry.stackDepth && index < 240; ++i)
+        index += snprintf(&scratch[index], sizeof(scratch) - index, " %p", entry.stack[i]);
+    scratch[index] = 0;
+    LOGD("FastMalloc heap profile: %d bytes in %d samples from%s",
+            entry.estimatedSize, entry.sampleCount, scratch);
+}
+
 void TimeCounter::report(const KURL& url, int live, int dead, size_t arenaSize)
 {
     String urlString = url;
@@ -143,9 +161,58 @@ void TimeCounter::report(const KURL& url, int live, int dead, size_t arenaSize)
     Heap::Statistics jsHeapStatistics = JSDOMWindow::commonJSGlobalData()->heap.statistics();
     LOGD("Current JavaScript heap size is %d and has %d bytes free",
             jsHeapStatistics.size, jsHeapStatistics.free);
+    LOGD("JavaScript heap swept %d cells during collections, %d while allocating "
+            "and %d incrementally, and skipped %d destructors",
+            jsHeapStatistics.cellsSweptDuringCollection, jsHeapStatistics.cellsSweptByAllocation,
+            jsHeapStatistics.cellsSweptIncrementally, jsHeapStatistics.skippedDestructors);
+#if ENABLE(GENERATIONAL_COLLECTION)
+    LOGD("JavaScript heap did %d nursery and %d full collections, "
+            "%d nursery cells, %d old cells, %d cells promoted",
+            jsHeapStatistics.nurseryCollections, jsHeapStatistics.fullCollections,
+            jsHeapStatistics.nurseryCells, jsHeapStatistics.oldCells,
+            jsHeapStatistics.promotedCells);
+#endif
+    Vector<HeapGrowthEvent> jsHeapGrowth = JSDOMWindow::commonJSGlobalData()->heap.growthTrace();
+    for (size_t i = 0; i < jsHeapGrowth.size(); ++i) {
+        LOGD("JavaScript heap resized from %d to %d bytes with %d bytes live%s",
+                jsHeapGrowth[i].sizeBeforeResize, jsHeapGrowth[i].sizeAfterResize,
+                jsHeapGrowth[i].liveBytes, jsHeapGrowth[i].reachedLimit ? " (at limit)" : "");
+    }
+    ParseCache* jsParseCache = JSDOMWindow::commonJSGlobalData()->parseCache;
+    LOGD("JavaScript parse cache has %d hits and %d misses, keeping trees for %d characters",
+            jsParseCache->hits(), jsParseCache->misses(), jsParseCache->size());
+#if ENABLE(JIT)
+    MegamorphicAccessCache* jsAccessCache = JSDOMWindow::commonJSGlobalData()->megamorphicAccessCache;
+    LOGD("JavaScript megamorphic property access cache has %d hits and %d misses",
+            jsAccessCache->hits(), jsAccessCache->misses());
+#endif
+#if ENABLE(ASSEMBLER)
+    ExecutableMemoryStatistics jsExecutableMemoryStatistics = JSDOMWindow::commonJSGlobalData()->executableAllocator.statistics();
+    LOGD("JavaScript executable memory has %d bytes reserved, %d allocated and %d free, "
+            "%d of them too fragmented for a new pool",
+            jsExecutableMemoryStatistics.reservedBytes, jsExecutableMemoryStatistics.allocatedBytes,
+            jsExecutableMemoryStatistics.freeBytes, jsExecutableMemoryStatistics.fragmentedBytes);
+#endif
 #endif
     LOGD("Current CSS styles use %d bytes", StyleBase::reportStyleSize());
     LOGD("Current DOM nodes use %d bytes", WebCore::Node::reportDOMNodesSize());
+    WTF::FastMallocStatistics fastMallocStatistics = WTF::fastMallocStatistics();
+    LOGD("FastMalloc heap is %d bytes with %d free in the page heap, %d returned "
+            "to the system and %d free in caches, %d of them in %d thread caches",
+            fastMallocStatistics.heapSize, fastMallocStatistics.freeSizeInHeap,
+            fastMallocStatistics.returnedSize, fastMallocStatistics.freeSizeInCaches,
+            fastMallocStatistics.freeSizeInThreadCaches, fastMallocStatistics.threadCacheCount);
+    WTF::FastMallocSizeClassStatistics sizeClasses[128];
+    size_t sizeClassCount = std::min<size_t>(WTF::fastMallocSizeClassStatistics(sizeClasses, 128), 128);
+    for (size_t i = 0; i < sizeClassCount; ++i) {
+        if (!sizeClasses[i].spanSize)
+            continue;
+        LOGD("FastMalloc %d byte objects hold %d bytes, %d free centrally and %d in thread caches",
+                sizeClasses[i].objectSize, sizeClasses[i].spanSize,
+                sizeClasses[i].freeSizeInCentralCache, sizeClasses[i].freeSizeInThreadCaches);
+    }
+    int heapProfileEntries = 20;
+    WTF::dumpFastMallocHeapProfile(logHeapProfileEntry, &heapProfileEntries);
 }
 
 void TimeCounter::reportNow()
@@ -180,6 +247,7 @@ void TimeCounter::reset() {
     bzero(sTotalTimeUsed, sizeof(sTotalTimeUsed));
     bzero(sCounter, sizeof(sCounter));
     LOGD("*-* Start browser instrument\n");
+    WTF::setFastMallocHeapProfilingInterval(512 * 1024);
     sStartTotalTime = currentTime();
     sStartThreadTime = getThreadMsec();
 }
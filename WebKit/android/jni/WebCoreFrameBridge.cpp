@@ -101,6 +101,8 @@
 #include "JavaInstanceJSC.h"
 #include <runtime_object.h>
 #include <runtime_root.h>
+#include <jit/MegamorphicAccessCache.h>
+#include <parser/ParseCache.h>
 #include <runtime/JSLock.h>
 #elif USE(V8)
 #include "JavaNPObjectV8.h"
@@ -1409,6 +1411,16 @@ static void ClearCache(JNIEnv *env, jobject obj)
     WebCore::pageCache()->setCapacity(pageCapacity);
 
 #if USE(JSC)    
+    // Drop the syntax trees kept for scripts that may no longer be in the cache, the code
+    // compiled for global evals, and the Structures kept alive by the property access cache.
+    {
+        JSC::JSLock lock(false);
+        WebCore::JSDOMWindow::commonJSGlobalData()->parseCache->clear();
+        WebCore::JSDOMWindow::commonJSGlobalData()->clearGlobalEvalCodeCaches();
+#if ENABLE(JIT)
+        WebCore::JSDOMWindow::commonJSGlobalData()->megamorphicAccessCache->clear();
+#endif
+    }
     // force JavaScript to GC when clear cache
     WebCore::gcController().garbageCollectSoon();
 #elif USE(V8)